@@ -7,7 +7,18 @@
  *     - esp32c6_thermometer.js
  * 
  * Device: ESP32-C6 with dual DS18B20 temperature sensors
- * Endpoints: 11 (sensor1), 12 (sensor2)
+ * Endpoints: 11 (sensor1), 12 (sensor2), ... - one per sensor slot
+ *   (CONFIG_THERMO_SENSOR_MAX_COUNT), taken from the interview
+ * Manufacturer-specific cluster 0xFC00 (endpoint 11): binary frames, see main/report_frame.h
+ *   - historyBatch: readings taken while offline (published as 'history')
+ *   - packedReadings: all sensors in one frame (published as temperature_sensorN)
+ *   - reportMode: standard / packed / both (writable)
+ *   - cpuBusy / suspendMax: CPU cost of 1-Wire busy-waiting (diagnostics)
+ *   - reportFailures / heapFreeMin / stackFreeSensor / stackFreeZigbee: device health
+ *   - logRecords / logSectorErases / logBytesProgrammed: flash log wear (router build)
+ * Cluster 0xFC00 on every sensor endpoint: per-sensor bus diagnostics
+ *   (crcErrors, presenceFailures, readRetries, lastConversionMs -> *_sensorN)
+ * ZCL Diagnostics cluster (endpoint 11): numberOfResets, APS unicast success/failure
  */
 
 const fz = require('zigbee-herdsman-converters/converters/fromZigbee');
@@ -16,40 +27,320 @@ const exposes = require('zigbee-herdsman-converters/lib/exposes');
 const reporting = require('zigbee-herdsman-converters/lib/reporting');
 const e = exposes.presets;
 
+const THERMO_EXT_CLUSTER = 'espThermoExt';
+const ZCL_TYPE_ENUM8 = 0x30;
+const ZCL_TYPE_UINT16 = 0x21;
+const ZCL_TYPE_UINT32 = 0x23;
+const ZCL_TYPE_OCTET_STR = 0x41;
+const FRAME_TYPE_HISTORY = 0x01;
+const FRAME_TYPE_READINGS = 0x02;
+const REPORT_MODES = ['standard', 'packed', 'both'];
+const VALUE_INVALID = -32768;
+const SENSOR_ENDPOINT_BASE = 11;
+const SENSOR_ENDPOINT_LAST = 240;   // Last application endpoint
+const DEFAULT_SENSOR_ENDPOINTS = [11, 12];
+const SENSOR_DIAG_ATTRS = {
+    crcErrors: 'crc_errors',
+    presenceFailures: 'presence_failures',
+    readRetries: 'read_retries',
+    lastConversionMs: 'last_conversion',
+};
+const DEVICE_DIAG_ATTRS = {
+    reportFailures: 'report_failures',
+    heapFreeMin: 'heap_free_min',
+    stackFreeSensor: 'stack_free_sensor',
+    stackFreeZigbee: 'stack_free_zigbee',
+    bootFirstReportMs: 'boot_first_report',
+    awakeMs: 'awake_time',
+    logRecords: 'log_records',
+    logSectorErases: 'log_sector_erases',
+    logBytesProgrammed: 'log_bytes_programmed',
+};
+
+const thermoExtCluster = {
+    ID: 0xFC00,
+    attributes: {
+        historyBatch: {ID: 0x0000, type: ZCL_TYPE_OCTET_STR},
+        packedReadings: {ID: 0x0001, type: ZCL_TYPE_OCTET_STR},
+        reportMode: {ID: 0x0002, type: ZCL_TYPE_ENUM8},
+        cpuBusy: {ID: 0x0003, type: ZCL_TYPE_UINT16},
+        suspendMax: {ID: 0x0004, type: ZCL_TYPE_UINT32},
+        crcErrors: {ID: 0x0010, type: ZCL_TYPE_UINT32},
+        presenceFailures: {ID: 0x0011, type: ZCL_TYPE_UINT32},
+        readRetries: {ID: 0x0012, type: ZCL_TYPE_UINT32},
+        lastConversionMs: {ID: 0x0013, type: ZCL_TYPE_UINT16},
+        reportFailures: {ID: 0x0020, type: ZCL_TYPE_UINT32},
+        heapFreeMin: {ID: 0x0021, type: ZCL_TYPE_UINT32},
+        stackFreeSensor: {ID: 0x0022, type: ZCL_TYPE_UINT16},
+        stackFreeZigbee: {ID: 0x0023, type: ZCL_TYPE_UINT16},
+        bootFirstReportMs: {ID: 0x0024, type: ZCL_TYPE_UINT32},
+        awakeMs: {ID: 0x0025, type: ZCL_TYPE_UINT16},
+        logRecords: {ID: 0x0026, type: ZCL_TYPE_UINT32},
+        logSectorErases: {ID: 0x0027, type: ZCL_TYPE_UINT32},
+        logBytesProgrammed: {ID: 0x0028, type: ZCL_TYPE_UINT32},
+    },
+    commands: {},
+    commandsResponse: {},
+};
+
+/**
+ * Read unsigned LEB128 varint, returns [value, nextOffset]
+ */
+function readVarint(buf, offset) {
+    let value = 0;
+    let shift = 0;
+    for (let i = 0; i < 5 && offset < buf.length; i++) {
+        const b = buf[offset++];
+        value += (b & 0x7F) * Math.pow(2, shift);
+        if (!(b & 0x80)) {
+            return [value, offset];
+        }
+        shift += 7;
+    }
+    throw new Error('truncated varint');
+}
+
+const unzigzag16 = (v) => (v >>> 1) ^ -(v & 1);
+const wrapInt16 = (v) => (v << 16) >> 16;
+
+/**
+ * Decode history batch frame into [{time, sensor1, sensor2, ...}]
+ * Frame: type, seq, sensorCount, recordCount, ageOfOldest(u32 LE),
+ *        records of varint(dt) + sensorCount x zigzag varint(dValue)
+ */
+function decodeHistoryBatch(buf, receivedAt) {
+    const sensorCount = buf[2];
+    const recordCount = buf[3];
+    const oldestAge = buf.readUInt32LE(4);
+    const records = [];
+    const values = new Array(sensorCount).fill(0);
+    let time = receivedAt - oldestAge * 1000;
+    let offset = 8;
+
+    for (let r = 0; r < recordCount; r++) {
+        let dt;
+        [dt, offset] = readVarint(buf, offset);
+        time += dt * 1000;
+        const record = {time: new Date(time).toISOString()};
+        for (let s = 0; s < sensorCount; s++) {
+            let delta;
+            [delta, offset] = readVarint(buf, offset);
+            values[s] = wrapInt16(values[s] + unzigzag16(delta));
+            record[`temperature_sensor${s + 1}`] = values[s] === VALUE_INVALID ? null : values[s] / 100;
+        }
+        records.push(record);
+    }
+    return {seq: buf[1], records};
+}
+
+/**
+ * Decode packed readings frame into {temperature_sensor1, temperature_sensor2, ...}
+ * Frame: type, seq, sensorCount, 1, sensorCount x int16 LE centidegrees
+ */
+function decodePackedReadings(buf) {
+    const sensorCount = buf[2];
+    const result = {};
+    for (let s = 0; s < sensorCount && 4 + 2 * s + 1 < buf.length; s++) {
+        const value = buf.readInt16LE(4 + 2 * s);
+        if (value !== VALUE_INVALID) {
+            result[`temperature_sensor${s + 1}`] = value / 100;
+        }
+    }
+    return result;
+}
+
+const fzThermoExt = {
+    cluster: THERMO_EXT_CLUSTER,
+    type: ['attributeReport', 'readAttributesResponse'],
+    convert: (model, msg, publish, options, meta) => {
+        const result = {};
+        const history = msg.data.historyBatch;
+        if (history && history.length >= 8 && history[0] === FRAME_TYPE_HISTORY) {
+            const batch = decodeHistoryBatch(Buffer.from(history), Date.now());
+            result.history = batch.records;
+            result.history_seq = batch.seq;
+        }
+        const packed = msg.data.packedReadings;
+        if (packed && packed.length >= 4 && packed[0] === FRAME_TYPE_READINGS) {
+            Object.assign(result, decodePackedReadings(Buffer.from(packed)));
+        }
+        if (msg.data.reportMode !== undefined) {
+            result.report_mode = REPORT_MODES[msg.data.reportMode];
+        }
+        if (msg.data.cpuBusy !== undefined) {
+            result.sensor_cpu_busy = msg.data.cpuBusy / 10;
+        }
+        if (msg.data.suspendMax !== undefined) {
+            result.sensor_suspend_max = msg.data.suspendMax;
+        }
+        for (const [attr, key] of Object.entries(DEVICE_DIAG_ATTRS)) {
+            if (msg.data[attr] !== undefined) {
+                result[key] = msg.data[attr];
+            }
+        }
+        const sensor = msg.endpoint.ID - SENSOR_ENDPOINT_BASE + 1;
+        for (const [attr, key] of Object.entries(SENSOR_DIAG_ATTRS)) {
+            if (msg.data[attr] !== undefined) {
+                result[`${key}_sensor${sensor}`] = msg.data[attr];
+            }
+        }
+        return result;
+    },
+};
+
+const fzDiagnostics = {
+    cluster: 'haDiagnostic',
+    type: ['attributeReport', 'readAttributesResponse'],
+    convert: (model, msg, publish, options, meta) => {
+        const result = {};
+        if (msg.data.numberOfResets !== undefined) {
+            result.resets = msg.data.numberOfResets;
+        }
+        if (msg.data.aPSTxUcastSuccess !== undefined) {
+            result.aps_tx_success = msg.data.aPSTxUcastSuccess;
+        }
+        if (msg.data.aPSTxUcastFail !== undefined) {
+            result.aps_tx_fail = msg.data.aPSTxUcastFail;
+        }
+        return result;
+    },
+};
+
+/**
+ * Sensor endpoint IDs of an interviewed device (11, 12, ...), default build
+ * layout when the device is not known yet (e.g. documentation generation)
+ */
+function sensorEndpointIds(device) {
+    if (!device || !device.endpoints) {
+        return DEFAULT_SENSOR_ENDPOINTS;
+    }
+    const ids = device.endpoints.map((ep) => ep.ID)
+        .filter((id) => id >= SENSOR_ENDPOINT_BASE && id <= SENSOR_ENDPOINT_LAST)
+        .sort((a, b) => a - b);
+    return ids.length > 0 ? ids : DEFAULT_SENSOR_ENDPOINTS;
+}
+
+const sensorName = (id) => `sensor${id - SENSOR_ENDPOINT_BASE + 1}`;
+
+const sensorDiagExposes = (sensor) => [
+    exposes.numeric('crc_errors', exposes.access.STATE).withEndpoint(sensor)
+        .withDescription('Scratchpad reads rejected by CRC check'),
+    exposes.numeric('presence_failures', exposes.access.STATE).withEndpoint(sensor)
+        .withDescription('Bus resets without presence pulse'),
+    exposes.numeric('read_retries', exposes.access.STATE).withEndpoint(sensor)
+        .withDescription('Scratchpad re-reads after a failed read'),
+    exposes.numeric('last_conversion', exposes.access.STATE).withEndpoint(sensor).withUnit('ms')
+        .withDescription('Conversion start to successful read'),
+];
+
+const tzReportMode = {
+    key: ['report_mode'],
+    convertSet: async (entity, key, value, meta) => {
+        const mode = REPORT_MODES.indexOf(value);
+        if (mode < 0) {
+            throw new Error(`Invalid report_mode '${value}'`);
+        }
+        await meta.device.getEndpoint(SENSOR_ENDPOINT_BASE).write(THERMO_EXT_CLUSTER, {reportMode: mode});
+        return {state: {report_mode: value}};
+    },
+    convertGet: async (entity, key, meta) => {
+        await meta.device.getEndpoint(SENSOR_ENDPOINT_BASE).read(THERMO_EXT_CLUSTER, ['reportMode']);
+    },
+};
+
+/**
+ * Register the manufacturer-specific cluster so frames are parsed by name.
+ * Runs on every converter event (Zigbee2MQTT start included), not only in
+ * configure, which is skipped for devices configured before a restart
+ */
+function registerThermoExtCluster(device) {
+    if (device && !(device.customClusters && device.customClusters[THERMO_EXT_CLUSTER])) {
+        device.addCustomCluster(THERMO_EXT_CLUSTER, thermoExtCluster);
+    }
+}
+
 const definition = {
     zigbeeModel: ['ESP32C6.TH'],
     model: 'ESP32C6-DUAL-TEMP',
     vendor: 'Espressif',
     description: 'ESP32-C6 Dual DS18B20 Temperature Sensor with Zigbee Router',
-    fromZigbee: [fz.temperature],
-    toZigbee: [],
-    exposes: [
-        e.temperature().withEndpoint('sensor1'),
-        e.temperature().withEndpoint('sensor2'),
+    fromZigbee: [fz.temperature, fzThermoExt, fzDiagnostics],
+    toZigbee: [tzReportMode],
+    exposes: (device, options) => [
+        ...sensorEndpointIds(device).map((id) => e.temperature().withEndpoint(sensorName(id))),
+        exposes.enum('report_mode', exposes.access.ALL, REPORT_MODES)
+            .withDescription('standard = one report per endpoint, packed = all sensors in one frame'),
+        exposes.numeric('sensor_cpu_busy', exposes.access.STATE).withUnit('%')
+            .withDescription('CPU time spent busy-waiting on the 1-Wire bus (last ~5 minutes)'),
+        exposes.numeric('sensor_suspend_max', exposes.access.STATE).withUnit('µs')
+            .withDescription('Longest window with the scheduler suspended for 1-Wire timing'),
+        ...sensorEndpointIds(device).flatMap((id) => sensorDiagExposes(sensorName(id))),
+        exposes.numeric('report_failures', exposes.access.STATE)
+            .withDescription('Reports rejected by the stack or not acknowledged'),
+        exposes.numeric('heap_free_min', exposes.access.STATE).withUnit('B')
+            .withDescription('Minimum free heap since boot'),
+        exposes.numeric('stack_free_sensor', exposes.access.STATE).withUnit('B')
+            .withDescription('Sensor task stack high-water mark'),
+        exposes.numeric('stack_free_zigbee', exposes.access.STATE).withUnit('B')
+            .withDescription('Zigbee task stack high-water mark'),
+        exposes.numeric('boot_first_report', exposes.access.STATE).withUnit('ms')
+            .withDescription('Startup to first temperature report of the last boot'),
+        exposes.numeric('awake_time', exposes.access.STATE).withUnit('ms')
+            .withDescription('Awake time of the previous sleep cycle (sleepy end-device build only)'),
+        exposes.numeric('log_records', exposes.access.STATE)
+            .withDescription('Flash log records appended since boot (router build only)'),
+        exposes.numeric('log_sector_erases', exposes.access.STATE)
+            .withDescription('Flash log sector erases since boot (router build only)'),
+        exposes.numeric('log_bytes_programmed', exposes.access.STATE).withUnit('B')
+            .withDescription('Flash log bytes programmed since boot (router build only)'),
+        exposes.numeric('resets', exposes.access.STATE).withDescription('Number of device resets'),
+        exposes.numeric('aps_tx_success', exposes.access.STATE).withDescription('APS unicast sends acknowledged (wraps at 65535)'),
+        exposes.numeric('aps_tx_fail', exposes.access.STATE).withDescription('APS unicast sends failed (wraps at 65535)'),
     ],
     endpoint: (device) => {
-        return {
-            'sensor1': 11,
-            'sensor2': 12,
-        };
+        return Object.fromEntries(sensorEndpointIds(device).map((id) => [sensorName(id), id]));
     },
     meta: {
         multiEndpoint: true,
     },
+    onEvent: async (type, data, device) => {
+        if (type !== 'stop') {
+            registerThermoExtCluster(device);
+        }
+    },
     configure: async (device, coordinatorEndpoint, logger) => {
-        const endpoint1 = device.getEndpoint(11);
-        const endpoint2 = device.getEndpoint(12);
+        // One endpoint per sensor slot; endpoint 11 also carries the device-wide clusters
+        const endpoints = sensorEndpointIds(device).map((id) => device.getEndpoint(id)).filter((ep) => ep);
+        const endpoint1 = device.getEndpoint(SENSOR_ENDPOINT_BASE);
         
-        // Bind temperature measurement cluster for both endpoints
-        await reporting.bind(endpoint1, coordinatorEndpoint, ['msTemperatureMeasurement']);
-        await reporting.bind(endpoint2, coordinatorEndpoint, ['msTemperatureMeasurement']);
+        registerThermoExtCluster(device);
+        
+        // Bind temperature measurement and per-sensor diagnostics on every sensor endpoint.
+        // Packed/backfill frames follow the binding table as well (device falls back
+        // to coordinator unicast only while it has no binding for the cluster)
+        for (const endpoint of endpoints) {
+            await reporting.bind(endpoint, coordinatorEndpoint, ['msTemperatureMeasurement', THERMO_EXT_CLUSTER]);
+        }
+        await reporting.bind(endpoint1, coordinatorEndpoint, ['haDiagnostic']);
         
         // Configure temperature reporting
         // Min: 10 seconds, Max: 300 seconds (5 min), Change: 100 (1°C)
-        await reporting.temperature(endpoint1, {min: 10, max: 300, change: 100});
-        await reporting.temperature(endpoint2, {min: 10, max: 300, change: 100});
+        for (const endpoint of endpoints) {
+            await reporting.temperature(endpoint, {min: 10, max: 300, change: 100});
+        }
+        
+        // Diagnostics change slowly; report hourly, or within 5 min of a change
+        const diag = {minimumReportInterval: 300, maximumReportInterval: 3600, reportableChange: 1};
+        for (const endpoint of endpoints) {
+            await endpoint.configureReporting(THERMO_EXT_CLUSTER,
+                Object.keys(SENSOR_DIAG_ATTRS).map((attribute) => ({attribute, ...diag})));
+        }
+        await endpoint1.configureReporting(THERMO_EXT_CLUSTER,
+            Object.keys(DEVICE_DIAG_ATTRS).map((attribute) => ({attribute, ...diag})));
+        await endpoint1.configureReporting('haDiagnostic',
+            ['numberOfResets', 'aPSTxUcastSuccess', 'aPSTxUcastFail'].map((attribute) => ({attribute, ...diag})));
         
-        logger.info('ESP32C6 Dual Thermometer configured successfully');
+        logger.info(`ESP32C6 Dual Thermometer configured successfully (${endpoints.length} sensor endpoint(s))`);
     },
 };
 
@@ -0,0 +1,215 @@
+/**
+ * @file bench_console.c
+ * @brief Host driver for the benchmark console commands (main/bench_cmd.c)
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Runs the same command handlers as the device console against the
+ * simulated 1-Wire line, so benchmark runs can be compared between board
+ * and PC. Commands come from the arguments after the options (one command
+ * line per argument) or, if none are given, from stdin.
+ *
+ * Usage:
+ *   bench_console [-n sensors] [-r rise_us] [-g glitches_per_ms] [command ...]
+ *   bench_console -n 4 -g 2 "read all 50 1" "read all 50 3" hist
+ *
+ * Host-only commands exercise hot-plug handling:
+ * - unplug <sensor> / plug <sensor>   disconnect or reconnect the sensor of a slot
+ *
+ * Exit status is non-zero if any command failed.
+ */
+
+#include "bench_cmd.h"
+#include "onewire_bus.h"
+#include "ds18b20.h"
+#include "onewire_sim.h"
+#include "esp_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CONSOLE_MAX_ARGS    8
+#define CONSOLE_LINE_LEN    128
+#define HOST_ROM_SERIAL_BASE 0x3000
+
+static onewire_bus_handle_t bus;
+static ds18b20_device_t devices[ONEWIRE_SIM_MAX_DEVICES];
+static bool present[ONEWIRE_SIM_MAX_DEVICES];
+static uint8_t device_count;
+
+static uint8_t host_sensor_count(void)
+{
+    return device_count;
+}
+
+static bool host_sensor_get(uint8_t slot, ds18b20_device_t *dev)
+{
+    if (slot >= device_count || !present[slot]) {
+        return false;
+    }
+    *dev = devices[slot];
+    return true;
+}
+
+/**
+ * @brief Full search: known ROMs keep their slot, new ROMs get the next one
+ */
+static void host_rescan(void)
+{
+    bool seen[ONEWIRE_SIM_MAX_DEVICES] = {false};
+    onewire_search_state_t search;
+    uint8_t rom[8];
+
+    onewire_bus_search_reset(&search);
+    do {
+        if (onewire_bus_acquire(&bus, ONEWIRE_BUS_PRIO_BACKGROUND, DS18B20_BUS_TIMEOUT_MS) != ESP_OK) {
+            return;
+        }
+        bool found = onewire_bus_search_next(&bus, &search, rom);
+        onewire_bus_release(&bus);
+        if (!found) {
+            break;
+        }
+        if (rom[0] != 0x28 || onewire_bus_crc8(rom, 7) != rom[7]) {
+            continue;
+        }
+
+        uint8_t i = 0;
+        while (i < device_count && memcmp(devices[i].rom, rom, 8) != 0) {
+            i++;
+        }
+        if (i == device_count) {
+            if (device_count == ONEWIRE_SIM_MAX_DEVICES) {
+                continue;
+            }
+            ds18b20_init(&devices[device_count++], &bus, rom);
+        }
+        seen[i] = true;
+    } while (!search.last_device_flag);
+
+    for (uint8_t i = 0; i < device_count; i++) {
+        if (present[i] != seen[i]) {
+            printf("sensor %u %s\n", i + 1, seen[i] ? "present" : "absent");
+        }
+        present[i] = seen[i];
+    }
+}
+
+/**
+ * @brief Connect or disconnect the simulated sensor behind a slot
+ */
+static int host_plug(int argc, char **argv, bool connected)
+{
+    int slot = argc == 2 ? atoi(argv[1]) - 1 : -1;
+    if (slot < 0 || slot >= device_count) {
+        printf("usage: %s <1..%u>\n", argv[0], device_count);
+        return 1;
+    }
+    for (int dev = 0; dev < onewire_sim_device_count(); dev++) {
+        uint8_t rom[8];
+        onewire_sim_make_rom(HOST_ROM_SERIAL_BASE + dev, rom);
+        if (memcmp(rom, devices[slot].rom, 8) == 0) {
+            onewire_sim_set_connected(dev, connected);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int run_line(char *line)
+{
+    char *argv[CONSOLE_MAX_ARGS];
+    int argc = 0;
+
+    for (char *tok = strtok(line, " \t\r\n"); tok && argc < CONSOLE_MAX_ARGS; tok = strtok(NULL, " \t\r\n")) {
+        argv[argc++] = tok;
+    }
+    if (argc == 0 || argv[0][0] == '#') {
+        return 0;
+    }
+
+    printf("> ");
+    for (int i = 0; i < argc; i++) {
+        printf("%s%s", argv[i], i + 1 < argc ? " " : "\n");
+    }
+    if (strcmp(argv[0], "unplug") == 0 || strcmp(argv[0], "plug") == 0) {
+        return host_plug(argc, argv, argv[0][0] == 'p');
+    }
+    if (strcmp(argv[0], "help") == 0) {
+        for (size_t i = 0; i < bench_cmd_count; i++) {
+            printf("%-8s %-32s %s\n", bench_cmd_table[i].command,
+                   bench_cmd_table[i].hint ? bench_cmd_table[i].hint : "", bench_cmd_table[i].help);
+        }
+        printf("%-8s %-32s %s\n", "plug", "<sensor>", "Reconnect a simulated sensor");
+        printf("%-8s %-32s %s\n", "unplug", "<sensor>", "Disconnect a simulated sensor");
+        return 0;
+    }
+    return bench_cmd_run(argc, argv);
+}
+
+int main(int argc, char **argv)
+{
+    onewire_sim_config_t cfg = ONEWIRE_SIM_CONFIG_DEFAULT();
+    int sensors = 2;
+    double glitch_rate = 0;
+    int opt = 1;
+
+    for (; opt + 1 < argc && argv[opt][0] == '-'; opt += 2) {
+        if (strcmp(argv[opt], "-n") == 0) {
+            sensors = atoi(argv[opt + 1]);
+        } else if (strcmp(argv[opt], "-r") == 0) {
+            cfg.rise_us = atof(argv[opt + 1]);
+        } else if (strcmp(argv[opt], "-g") == 0) {
+            glitch_rate = atof(argv[opt + 1]);
+        } else {
+            break;
+        }
+    }
+    if ((opt < argc && argv[opt][0] == '-') || sensors < 1 || sensors > ONEWIRE_SIM_MAX_DEVICES) {
+        fprintf(stderr, "usage: %s [-n 1..%d] [-r rise_us] [-g glitches_per_ms] [command ...]\n",
+                argv[0], ONEWIRE_SIM_MAX_DEVICES);
+        return EXIT_FAILURE;
+    }
+
+    shim_log_set_level(ESP_LOG_ERROR);
+    onewire_sim_init(&cfg);
+    for (int i = 0; i < sensors; i++) {
+        uint8_t rom[8];
+        onewire_sim_make_rom(HOST_ROM_SERIAL_BASE + i, rom);
+        onewire_sim_add_ds18b20(rom, 20.0f + i * 0.5f);
+    }
+
+    onewire_bus_config_t bus_cfg = { .pin = GPIO_NUM_20 };
+    if (onewire_bus_init(&bus_cfg, &bus) != ESP_OK) {
+        fprintf(stderr, "onewire_bus_init failed\n");
+        return EXIT_FAILURE;
+    }
+
+    bench_cmd_ctx_t ctx = {
+        .bus = &bus,
+        .sensor_count = host_sensor_count,
+        .sensor_get = host_sensor_get,
+        .rescan = host_rescan,
+    };
+    bench_cmd_init(&ctx);
+
+    // Calibrate and enumerate on a clean line, then switch the noise on
+    host_rescan();
+    onewire_sim_config()->glitch_rate_per_ms = glitch_rate;
+
+    int failures = 0;
+    if (opt < argc) {
+        for (; opt < argc; opt++) {
+            char line[CONSOLE_LINE_LEN];
+            snprintf(line, sizeof(line), "%s", argv[opt]);
+            failures += run_line(line) != 0;
+        }
+    } else {
+        char line[CONSOLE_LINE_LEN];
+        while (fgets(line, sizeof(line), stdin)) {
+            failures += run_line(line) != 0;
+        }
+    }
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
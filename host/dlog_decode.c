@@ -0,0 +1,162 @@
+/**
+ * @file dlog_decode.c
+ * @brief Decode deferred sensor log records (main/dlog.c) from a monitor log
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Firmware built with `idf.py -DSENSOR_LOG=raw build` writes every
+ * per-reading log as a "DLOG <hex>" line and never formats on the device.
+ * This tool extracts those records from a captured monitor log and prints
+ * them with the same text the device prints in deferred mode
+ * (dlog_msg_format). Other lines pass through unchanged with -a.
+ *
+ * With --bench it compares the hot-path cost per log call on the host:
+ * dlog_write (+ drain), integer snprintf and float snprintf.
+ *
+ * Usage:
+ *   dlog_decode [-a] [monitor.log|-]
+ *   dlog_decode --bench
+ */
+
+#include "dlog.h"
+#include "dlog_msgs.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DECODE_LINE_LEN     512
+#define BENCH_CALLS         1000000
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+static int decode_stream(FILE *f, bool pass_through)
+{
+    char line[DECODE_LINE_LEN];
+    unsigned records = 0;
+    unsigned bad = 0;
+
+    while (fgets(line, sizeof(line), f)) {
+        const char *p = strstr(line, "DLOG ");
+        if (!p) {
+            if (pass_through) {
+                fputs(line, stdout);
+            }
+            continue;
+        }
+
+        uint8_t bin[DLOG_ENCODED_MAX_LEN];
+        size_t n = 0;
+        for (p += 5; n < sizeof(bin) && hex_value(p[0]) >= 0 && hex_value(p[1]) >= 0; p += 2) {
+            bin[n++] = (uint8_t)(hex_value(p[0]) << 4 | hex_value(p[1]));
+        }
+
+        dlog_record_t rec;
+        char text[128];
+        if (dlog_decode(bin, n, &rec) != n) {
+            bad++;
+            continue;
+        }
+        dlog_msg_format(&rec, text, sizeof(text));
+        printf("[%u] %s\n", (unsigned)rec.time_ms, text);
+        records++;
+    }
+
+    fprintf(stderr, "%u records decoded, %u malformed\n", records, bad);
+    return bad ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * @brief Hot-path cost per log call: deferred record vs. formatting in place
+ */
+static int run_bench(void)
+{
+    char buf[128];
+    dlog_record_t rec;
+    volatile int sink = 0;
+    double t0;
+
+    dlog_init();
+    t0 = now_ns();
+    for (int i = 0; i < BENCH_CALLS; i++) {
+        int16_t centi = (int16_t)(2000 + (i & 0x3FF));
+        DLOG((uint32_t)i, DLOG_MSG_READING, i & 1, centi);
+        if ((i & (DLOG_RING_LEN / 2 - 1)) == DLOG_RING_LEN / 2 - 1) {
+            while (dlog_read(&rec)) {  // Drain often enough that nothing is dropped
+                sink += rec.argc;
+            }
+        }
+    }
+    double deferred = (now_ns() - t0) / BENCH_CALLS;
+
+    t0 = now_ns();
+    for (int i = 0; i < BENCH_CALLS; i++) {
+        int centi = 2000 + (i & 0x3FF);
+        sink += snprintf(buf, sizeof(buf), "Sensor %d: %d.%02d°C", (i & 1) + 1, centi / 100, centi % 100);
+    }
+    double integer = (now_ns() - t0) / BENCH_CALLS;
+
+    t0 = now_ns();
+    for (int i = 0; i < BENCH_CALLS; i++) {
+        float temp = (2000 + (i & 0x3FF)) / 100.0f;
+        sink += snprintf(buf, sizeof(buf), "Sensor %d: %.2f°C", (i & 1) + 1, temp);
+    }
+    double floating = (now_ns() - t0) / BENCH_CALLS;
+
+    printf("%-28s %10s\n", "log call (host)", "ns/call");
+    printf("%-28s %10.1f\n", "dlog_write + drain", deferred);
+    printf("%-28s %10.1f\n", "snprintf integer centi", integer);
+    printf("%-28s %10.1f\n", "snprintf %.2f float", floating);
+    printf("dropped %u, checksum %d\n", (unsigned)dlog_dropped(), sink);
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv)
+{
+    bool pass_through = false;
+    const char *path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--bench") == 0) {
+            return run_bench();
+        } else if (strcmp(argv[i], "-a") == 0) {
+            pass_through = true;
+        } else if (argv[i][0] != '-' || strcmp(argv[i], "-") == 0) {
+            path = argv[i];
+        } else {
+            fprintf(stderr, "usage: %s [-a] [monitor.log|-]\n       %s --bench\n", argv[0], argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    FILE *f = !path || strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return EXIT_FAILURE;
+    }
+    int rc = decode_stream(f, pass_through);
+    if (f != stdin) {
+        fclose(f);
+    }
+    return rc;
+}
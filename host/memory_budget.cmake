@@ -0,0 +1,77 @@
+# ESP32-C6 Zigbee Thermometer - static RAM budget table (memory_budget target)
+# Inputs: SIZE_TOOL, LAYOUT (type layout label), SENSORS (e.g. 1|2|8|32) and OBJECTS_<n> ('|'-separated
+# object files compiled with SENSOR_MAX_COUNT=<n>). Prints data + bss bytes
+# per module and configuration, and the per-sensor slope.
+
+string(REPLACE "|" ";" SENSORS "${SENSORS}")
+set(modules)
+
+foreach(n ${SENSORS})
+    string(REPLACE "|" ";" objects "${OBJECTS_${n}}")
+    execute_process(COMMAND ${SIZE_TOOL} --format=berkeley ${objects}
+                    OUTPUT_VARIABLE out RESULT_VARIABLE rc)
+    if(NOT rc EQUAL 0)
+        message(FATAL_ERROR "${SIZE_TOOL} failed for SENSOR_MAX_COUNT=${n}")
+    endif()
+    string(REPLACE "\n" ";" lines "${out}")
+    set(total_${n} 0)
+    foreach(line ${lines})
+        # text data bss dec hex filename
+        if(line MATCHES "^[ \t]*([0-9]+)[ \t]+([0-9]+)[ \t]+([0-9]+)[ \t]+[0-9]+[ \t]+[0-9a-f]+[ \t]+(.+)$")
+            math(EXPR ram "${CMAKE_MATCH_2} + ${CMAKE_MATCH_3}")
+            get_filename_component(module "${CMAKE_MATCH_4}" NAME)
+            string(REGEX REPLACE "\\.c\\.o(bj)?$" "" module "${module}")
+            set(ram_${module}_${n} ${ram})
+            math(EXPR total_${n} "${total_${n}} + ${ram}")
+            list(APPEND modules ${module})
+        endif()
+    endforeach()
+endforeach()
+list(REMOVE_DUPLICATES modules)
+
+function(pad out width text)
+    string(LENGTH "${text}" len)
+    set(result "${text}")
+    while(len LESS width)
+        string(PREPEND result " ")
+        math(EXPR len "${len} + 1")
+    endwhile()
+    set(${out} "${result}" PARENT_SCOPE)
+endfunction()
+
+list(GET SENSORS 0 first)
+list(GET SENSORS -1 last)
+math(EXPR span "${last} - ${first}")
+
+set(header "module          ")
+foreach(n ${SENSORS})
+    pad(cell 10 "n=${n}")
+    string(APPEND header "${cell}")
+endforeach()
+pad(cell 12 "per sensor")
+message("Static RAM (data + bss, bytes, ${LAYOUT}) by SENSOR_MAX_COUNT\n\n${header}${cell}")
+
+foreach(module ${modules} TOTAL)
+    if(module STREQUAL "TOTAL")
+        set(name "total")
+    else()
+        set(name "${module}")
+    endif()
+    string(SUBSTRING "${name}                " 0 16 row)
+    foreach(n ${SENSORS})
+        if(module STREQUAL "TOTAL")
+            set(v ${total_${n}})
+        else()
+            set(v ${ram_${module}_${n}})
+        endif()
+        pad(cell 10 "${v}")
+        string(APPEND row "${cell}")
+    endforeach()
+    if(module STREQUAL "TOTAL")
+        math(EXPR slope "(${total_${last}} - ${total_${first}}) / ${span}")
+    else()
+        math(EXPR slope "(${ram_${module}_${last}} - ${ram_${module}_${first}}) / ${span}")
+    endif()
+    pad(cell 12 "${slope}")
+    message("${row}${cell}")
+endforeach()
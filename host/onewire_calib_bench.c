@@ -0,0 +1,122 @@
+/**
+ * @file onewire_calib_bench.c
+ * @brief Host benchmark of 1-Wire slot timing calibration (onewire_timing.c)
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Runs the unmodified onewire_bus.c and ds18b20.c against the simulated
+ * line (sim/onewire_sim.c) for a sweep of line rise times, once with the
+ * calibrated timing chosen by onewire_bus_init() and once with the fixed
+ * default timing, and reports:
+ * - Measured vs. simulated rise time
+ * - Read error rate (failed or wrong temperature reads)
+ * - Bus time per read (conversion wait excluded)
+ *
+ * Exit status is non-zero if calibrated timing fails on a line within
+ * ONEWIRE_TIMING_MAX_RISE_US or the rise time is under-measured.
+ */
+
+#include "onewire_bus.h"
+#include "ds18b20.h"
+#include "onewire_sim.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_SENSORS        2
+#define BENCH_READS          200       // Reads per sensor and timing variant
+#define BENCH_CONVERSION_US  750000    // Fixed wait inside ds18b20_get_temperature()
+
+static const double rise_sweep_us[] = {0.5, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 14};
+
+typedef struct {
+    uint32_t reads;
+    uint32_t errors;
+    double bus_us_per_read;
+} bench_result_t;
+
+/**
+ * @brief Read every sensor BENCH_READS times with the bus timing as set
+ */
+static void bench_reads(onewire_bus_handle_t *bus, const uint8_t roms[][8], bench_result_t *res)
+{
+    int64_t bus_us = 0;
+
+    for (int n = 0; n < BENCH_READS; n++) {
+        for (int s = 0; s < BENCH_SENSORS; s++) {
+            float expected = 20.0f + s + (n % 16) / 16.0f;
+            onewire_sim_set_temperature(s, expected);
+
+            ds18b20_device_t dev;
+            ds18b20_init(&dev, bus, roms[s]);
+            float value = 0;
+            int64_t start = esp_timer_get_time();
+            esp_err_t ret = ds18b20_get_temperature(&dev, ONEWIRE_BUS_PRIO_PERIODIC, &value);
+            bus_us += esp_timer_get_time() - start - BENCH_CONVERSION_US;
+
+            res->reads++;
+            if (ret != ESP_OK || fabsf(value - expected) > 0.01f) {
+                res->errors++;
+            }
+        }
+    }
+    res->bus_us_per_read = (double)bus_us / res->reads;
+}
+
+int main(void)
+{
+    int failures = 0;
+
+    shim_log_set_level(ESP_LOG_NONE);
+
+    printf("1-Wire slot timing calibration, %d sensors, %d reads per sensor\n\n", BENCH_SENSORS, BENCH_READS);
+    printf("%8s %9s %6s | %10s %10s | %10s %10s\n", "rise us", "measured", "spec", "calib err%", "calib us", "fixed err%", "fixed us");
+
+    for (size_t i = 0; i < sizeof(rise_sweep_us) / sizeof(rise_sweep_us[0]); i++) {
+        onewire_sim_config_t cfg = ONEWIRE_SIM_CONFIG_DEFAULT();
+        cfg.rise_us = rise_sweep_us[i];
+        cfg.seed = 1 + (uint32_t)i;
+        onewire_sim_init(&cfg);
+
+        uint8_t roms[BENCH_SENSORS][8];
+        for (int s = 0; s < BENCH_SENSORS; s++) {
+            onewire_sim_make_rom(0x1000 + s, roms[s]);
+            onewire_sim_add_ds18b20(roms[s], 20.0f);
+        }
+
+        onewire_bus_config_t bus_cfg = { .pin = GPIO_NUM_20 };
+        onewire_bus_handle_t bus;
+        if (onewire_bus_init(&bus_cfg, &bus) != ESP_OK) {
+            fprintf(stderr, "onewire_bus_init failed\n");
+            return EXIT_FAILURE;
+        }
+        uint8_t measured = bus.timing.rise_us;
+        bool within_spec = measured <= ONEWIRE_TIMING_MAX_RISE_US;
+
+        bench_result_t calib = {0};
+        bench_reads(&bus, (const uint8_t (*)[8])roms, &calib);
+
+        bench_result_t fixed = {0};
+        bus.timing = (onewire_timing_t)ONEWIRE_TIMING_DEFAULT();
+        bench_reads(&bus, (const uint8_t (*)[8])roms, &fixed);
+
+        printf("%8.1f %9u %6s | %10.1f %10.0f | %10.1f %10.0f\n",
+               cfg.rise_us, measured, within_spec ? "ok" : "slow",
+               100.0 * calib.errors / calib.reads, calib.bus_us_per_read,
+               100.0 * fixed.errors / fixed.reads, fixed.bus_us_per_read);
+
+        if (measured < cfg.rise_us) {
+            fprintf(stderr, "  rise time under-measured (%u < %.1f)\n", measured, cfg.rise_us);
+            failures++;
+        }
+        if (within_spec && calib.errors > 0) {
+            fprintf(stderr, "  calibrated timing failed within spec\n");
+            failures++;
+        }
+    }
+
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,468 @@
+/**
+ * @file onewire_trace_tool.c
+ * @brief Host decoder of 1-Wire edge traces: VCD export and spec timing check
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Input is either the binary export stream (onewire_trace.h) or a captured
+ * serial monitor log containing the "OWTRACE <hex>" lines written by
+ * onewire_bus_trace_dump(). The tool:
+ * - Writes a VCD file (master drive, sample strobe, sampled level) for
+ *   GTKWave/PulseView
+ * - Classifies every slot (reset, write 0/1, read) from the master's drive
+ *   edges and samples and checks it against the standard-speed 1-Wire spec
+ * - Prints per-kind timing ranges and the first violations
+ *
+ * `--demo` records a trace of one DS18B20 read on the simulated line
+ * instead, so the whole chain can be exercised without hardware.
+ *
+ * Exit status: 0 clean, 1 timing violations, 2 usage/input error.
+ */
+
+#include "onewire_trace.h"
+#include "onewire_bus.h"
+#include "ds18b20.h"
+#include "onewire_sim.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GAP_IDLE_US         2000.0  // Longer high time ends a transaction (slot length not checked)
+#define MAX_VIOLATIONS_SHOWN 20
+
+/* Standard speed limits (µs) */
+#define SPEC_RESET_LOW_MIN      480.0
+#define SPEC_RESET_HIGH_MIN     480.0
+#define SPEC_PRESENCE_MIN       60.0    // Presence sample window after release
+#define SPEC_PRESENCE_MAX       75.0
+#define SPEC_WRITE1_LOW_MAX     15.0
+#define SPEC_WRITE0_LOW_MIN     60.0
+#define SPEC_WRITE0_LOW_MAX     120.0
+#define SPEC_LOW_MIN            1.0
+#define SPEC_READ_SAMPLE_MAX    15.0
+#define SPEC_SLOT_MIN           60.0
+#define SPEC_RECOVERY_MIN       1.0
+
+typedef struct {
+    double t_us;
+    onewire_trace_event_t type;
+} trace_event_t;
+
+typedef enum {
+    SLOT_RESET = 0,
+    SLOT_WRITE1,
+    SLOT_WRITE0,
+    SLOT_READ,
+    SLOT_INVALID,
+    SLOT_KIND_COUNT,
+} slot_kind_t;
+
+static const char *slot_names[SLOT_KIND_COUNT] = {"reset", "write1", "write0", "read", "invalid"};
+
+typedef struct {
+    uint32_t count;
+    double low_min, low_max;
+    double sample_min, sample_max;      // Read: first..last sample from slot start; reset: presence sample
+    double slot_min, slot_max;          // Fall to next fall (within a transaction)
+} slot_stats_t;
+
+static slot_stats_t kinds[SLOT_KIND_COUNT];
+static uint32_t violations;
+static double rise_allowance_us;
+
+static void minmax(double v, double *lo, double *hi, uint32_t count)
+{
+    if (count == 0 || v < *lo) {
+        *lo = v;
+    }
+    if (count == 0 || v > *hi) {
+        *hi = v;
+    }
+}
+
+static void violation(double t_us, const char *kind, const char *what, double value, double limit)
+{
+    if (violations++ < MAX_VIOLATIONS_SHOWN) {
+        printf("  @%12.2fus %-7s %s: %.2fus (limit %.2fus)\n", t_us, kind, what, value, limit);
+    }
+}
+
+/* ---------- Input ---------- */
+
+static int hex_value(int c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/**
+ * @brief Read whole file; log files are reduced to the bytes of their OWTRACE lines
+ */
+static uint8_t *load_stream(const char *path, size_t *len)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *data = malloc(size > 0 ? (size_t)size : 1);
+    if (!data || fread(data, 1, (size_t)size, f) != (size_t)size) {
+        fclose(f);
+        free(data);
+        return NULL;
+    }
+    fclose(f);
+
+    uint32_t magic = data[0] | data[1] << 8 | data[2] << 16 | (uint32_t)data[3] << 24;
+    if (size >= ONEWIRE_TRACE_HEADER_LEN && magic == ONEWIRE_TRACE_MAGIC) {
+        *len = (size_t)size;
+        return data;
+    }
+
+    // Text log: decode hex after every "OWTRACE " marker (in place, output is shorter)
+    size_t out = 0;
+    const char *marker = "OWTRACE ";
+    for (long i = 0; i + 8 <= size; i++) {
+        if (memcmp(data + i, marker, 8) != 0) {
+            continue;
+        }
+        i += 8;
+        while (i + 1 < size && hex_value(data[i]) >= 0 && hex_value(data[i + 1]) >= 0) {
+            data[out++] = (uint8_t)(hex_value(data[i]) << 4 | hex_value(data[i + 1]));
+            i += 2;
+        }
+    }
+    *len = out;
+    return data;
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static trace_event_t *parse_stream(const uint8_t *data, size_t len, uint32_t *count)
+{
+    if (len < ONEWIRE_TRACE_HEADER_LEN || get_u32(data) != ONEWIRE_TRACE_MAGIC || data[4] != ONEWIRE_TRACE_VERSION) {
+        fprintf(stderr, "No OWT1 trace found\n");
+        return NULL;
+    }
+    uint16_t ticks_per_us = data[6] | data[7] << 8;
+    uint32_t n = get_u32(data + 8);
+    if (ticks_per_us == 0 || len < ONEWIRE_TRACE_HEADER_LEN + 4 * (size_t)n) {
+        fprintf(stderr, "Truncated trace (%u events announced, %zu bytes)\n", n, len);
+        return NULL;
+    }
+    if (get_u32(data + 12)) {
+        printf("Note: %u older events were overwritten in the ring\n", get_u32(data + 12));
+    }
+
+    trace_event_t *events = malloc((n ? n : 1) * sizeof(*events));
+    uint64_t cycles = 0;
+    uint32_t prev = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t word = get_u32(data + ONEWIRE_TRACE_HEADER_LEN + 4 * i);
+        uint32_t c = ONEWIRE_TRACE_WORD_CYCLES(word);
+        cycles += i ? (uint32_t)(c - prev) : 0;     // Unwrap 32-bit counter
+        prev = c;
+        events[i].t_us = (double)cycles / ticks_per_us;
+        events[i].type = ONEWIRE_TRACE_WORD_TYPE(word);
+    }
+    *count = n;
+    return events;
+}
+
+/* ---------- VCD ---------- */
+
+static int write_vcd(const char *path, const trace_event_t *ev, uint32_t n)
+{
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    fprintf(f, "$comment 1-Wire master trace (onewire_trace_tool) $end\n");
+    fprintf(f, "$timescale 1ns $end\n$scope module onewire $end\n");
+    fprintf(f, "$var wire 1 d master_release $end\n");
+    fprintf(f, "$var wire 1 s sample_strobe $end\n");
+    fprintf(f, "$var wire 1 v sampled_level $end\n");
+    fprintf(f, "$upscope $end\n$enddefinitions $end\n#0\n$dumpvars\n1d\n0s\nxv\n$end\n");
+
+    int64_t strobe_off = -1;
+    for (uint32_t i = 0; i < n; i++) {
+        int64_t t = (int64_t)(ev[i].t_us * 1000.0 + 0.5);
+        if (strobe_off >= 0 && strobe_off <= t) {
+            fprintf(f, "#%lld\n0s\n", (long long)strobe_off);
+            strobe_off = -1;
+        }
+        fprintf(f, "#%lld\n", (long long)t);
+        switch (ev[i].type) {
+        case ONEWIRE_TRACE_DRIVE_LOW:
+            fprintf(f, "0d\n");
+            break;
+        case ONEWIRE_TRACE_RELEASE:
+            fprintf(f, "1d\n");
+            break;
+        default:
+            fprintf(f, "1s\n%cv\n", ev[i].type == ONEWIRE_TRACE_SAMPLE_1 ? '1' : '0');
+            strobe_off = t + 100;
+            break;
+        }
+    }
+    if (strobe_off >= 0) {
+        fprintf(f, "#%lld\n0s\n", (long long)strobe_off);
+    }
+    fclose(f);
+    return 0;
+}
+
+/* ---------- Timing check ---------- */
+
+typedef struct {
+    bool open;
+    double fall;            ///< Slot start (drive low)
+    double rise;            ///< Release (< 0 while still low)
+    double first_sample;    ///< First sample after fall (< 0 if none)
+    double last_sample;
+} slot_t;
+
+static void close_slot(const slot_t *s, double next_fall)
+{
+    double low = s->rise - s->fall;
+    bool idle_after = next_fall < 0 || next_fall - s->rise > GAP_IDLE_US;
+    slot_kind_t kind;
+
+    if (low >= SPEC_RESET_LOW_MIN - 100) {
+        kind = SLOT_RESET;
+    } else if (s->first_sample >= 0) {
+        kind = SLOT_READ;
+    } else if (low <= SPEC_WRITE1_LOW_MAX) {
+        kind = SLOT_WRITE1;
+    } else if (low >= SPEC_WRITE0_LOW_MIN && low <= SPEC_WRITE0_LOW_MAX) {
+        kind = SLOT_WRITE0;
+    } else {
+        kind = SLOT_INVALID;
+    }
+
+    slot_stats_t *st = &kinds[kind];
+    const char *name = slot_names[kind];
+    minmax(low, &st->low_min, &st->low_max, st->count);
+
+    switch (kind) {
+    case SLOT_RESET:
+        if (low < SPEC_RESET_LOW_MIN) {
+            violation(s->fall, name, "reset low too short", low, SPEC_RESET_LOW_MIN);
+        }
+        if (s->first_sample >= 0) {
+            double at = s->first_sample - s->rise;
+            minmax(at, &st->sample_min, &st->sample_max, st->count);
+            if (at < SPEC_PRESENCE_MIN || at > SPEC_PRESENCE_MAX + rise_allowance_us) {
+                violation(s->fall, name, "presence sample outside window", at,
+                          at < SPEC_PRESENCE_MIN ? SPEC_PRESENCE_MIN : SPEC_PRESENCE_MAX + rise_allowance_us);
+            }
+        }
+        if (next_fall >= 0 && next_fall - s->rise < SPEC_RESET_HIGH_MIN) {
+            violation(s->fall, name, "reset high time too short", next_fall - s->rise, SPEC_RESET_HIGH_MIN);
+        }
+        break;
+    case SLOT_READ:
+        minmax(s->first_sample - s->fall, &st->sample_min, &st->sample_max, st->count);
+        minmax(s->last_sample - s->fall, &st->sample_min, &st->sample_max, 1);
+        if (s->last_sample - s->fall > SPEC_READ_SAMPLE_MAX) {
+            violation(s->fall, name, "sample after data valid time", s->last_sample - s->fall, SPEC_READ_SAMPLE_MAX);
+        }
+        if (s->first_sample < s->rise) {
+            violation(s->fall, name, "sample while master drives low", s->first_sample - s->fall, low);
+        }
+        /* fall through */
+    case SLOT_WRITE1:
+        if (low < SPEC_LOW_MIN) {
+            violation(s->fall, name, "low time too short", low, SPEC_LOW_MIN);
+        }
+        break;
+    case SLOT_INVALID:
+        violation(s->fall, name, "low time fits no slot kind", low, SPEC_WRITE1_LOW_MAX);
+        break;
+    default:
+        break;
+    }
+
+    if (kind != SLOT_RESET && !idle_after) {
+        double slot = next_fall - s->fall;
+        minmax(slot, &st->slot_min, &st->slot_max, st->count);
+        if (slot < SPEC_SLOT_MIN + SPEC_RECOVERY_MIN) {
+            violation(s->fall, name, "slot shorter than 60us + recovery", slot, SPEC_SLOT_MIN + SPEC_RECOVERY_MIN);
+        }
+        if (next_fall - s->rise < SPEC_RECOVERY_MIN) {
+            violation(s->fall, name, "recovery too short", next_fall - s->rise, SPEC_RECOVERY_MIN);
+        }
+    }
+    st->count++;
+}
+
+static void check_timing(const trace_event_t *ev, uint32_t n)
+{
+    slot_t s = {0};
+
+    for (uint32_t i = 0; i < n; i++) {
+        switch (ev[i].type) {
+        case ONEWIRE_TRACE_DRIVE_LOW:
+            if (s.open && s.rise >= 0) {
+                close_slot(&s, ev[i].t_us);
+            }
+            s = (slot_t){ .open = true, .fall = ev[i].t_us, .rise = -1, .first_sample = -1, .last_sample = -1 };
+            break;
+        case ONEWIRE_TRACE_RELEASE:
+            if (s.open && s.rise < 0) {
+                s.rise = ev[i].t_us;
+            }
+            break;
+        default:
+            if (s.open) {
+                if (s.first_sample < 0) {
+                    s.first_sample = ev[i].t_us;
+                }
+                s.last_sample = ev[i].t_us;
+            }
+            break;
+        }
+    }
+    if (s.open && s.rise >= 0) {
+        close_slot(&s, -1);
+    }
+}
+
+static void print_summary(void)
+{
+    printf("\n%-8s %8s %17s %17s %17s\n", "slot", "count", "low us", "sample us", "slot us");
+    for (int k = 0; k < SLOT_KIND_COUNT; k++) {
+        const slot_stats_t *st = &kinds[k];
+        if (!st->count) {
+            continue;
+        }
+        printf("%-8s %8u %8.2f-%-8.2f", slot_names[k], st->count, st->low_min, st->low_max);
+        if (k == SLOT_RESET || k == SLOT_READ) {
+            printf(" %8.2f-%-8.2f", st->sample_min, st->sample_max);
+        } else {
+            printf(" %17s", "-");
+        }
+        if (k != SLOT_RESET && st->slot_max > 0) {
+            printf(" %8.2f-%-8.2f", st->slot_min, st->slot_max);
+        } else {
+            printf(" %17s", "-");
+        }
+        printf("\n");
+    }
+    printf("\n%u timing violation(s)\n", violations);
+}
+
+/* ---------- Demo capture on the simulated line ---------- */
+
+static onewire_trace_t demo_trace;
+
+static int demo_capture(const char *path, double rise_us)
+{
+    onewire_sim_config_t cfg = ONEWIRE_SIM_CONFIG_DEFAULT();
+    cfg.rise_us = rise_us;
+    onewire_sim_init(&cfg);
+    uint8_t rom[8];
+    onewire_sim_make_rom(0x3000, rom);
+    onewire_sim_add_ds18b20(rom, 21.5f);
+
+    onewire_bus_config_t bus_cfg = { .pin = GPIO_NUM_20 };
+    onewire_bus_handle_t bus;
+    onewire_bus_init(&bus_cfg, &bus);
+    onewire_bus_set_read_samples(&bus, 3);
+    onewire_trace_clear(&demo_trace);
+    onewire_bus_set_trace(&bus, &demo_trace);
+
+    ds18b20_device_t dev;
+    ds18b20_init(&dev, &bus, rom);
+    float temp = 0;
+    esp_err_t ret = ds18b20_get_temperature(&dev, ONEWIRE_BUS_PRIO_PERIODIC, &temp);
+    printf("Simulated read (rise %.1fus): %s, %.2f C, %u events\n", rise_us, esp_err_to_name(ret), temp,
+           (unsigned)onewire_trace_count(&demo_trace));
+
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    uint8_t chunk[256];
+    size_t offset = 0;
+    size_t n;
+    while ((n = onewire_trace_export(&demo_trace, (uint16_t)esp_rom_get_cpu_ticks_per_us(), offset,
+                                     chunk, sizeof(chunk))) > 0) {
+        fwrite(chunk, 1, n, f);
+        offset += n;
+    }
+    fclose(f);
+    return 0;
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: onewire_trace_tool [-o out.vcd] [--rise us] <trace.bin | monitor.log>\n"
+            "       onewire_trace_tool --demo out.bin [rise_us]\n"
+            "  --rise  widen presence window by the line rise time (calibrated timing)\n");
+}
+
+int main(int argc, char **argv)
+{
+    const char *vcd_path = NULL;
+    const char *input = NULL;
+
+    shim_log_set_level(ESP_LOG_NONE);
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--demo") && i + 1 < argc) {
+            double rise = i + 2 < argc ? atof(argv[i + 2]) : 1.0;
+            return demo_capture(argv[i + 1], rise) == 0 ? 0 : 2;
+        } else if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+            vcd_path = argv[++i];
+        } else if (!strcmp(argv[i], "--rise") && i + 1 < argc) {
+            rise_allowance_us = atof(argv[++i]);
+        } else if (argv[i][0] != '-' && !input) {
+            input = argv[i];
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (!input) {
+        usage();
+        return 2;
+    }
+
+    size_t len = 0;
+    uint8_t *data = load_stream(input, &len);
+    uint32_t n = 0;
+    trace_event_t *events = data ? parse_stream(data, len, &n) : NULL;
+    free(data);
+    if (!events) {
+        return 2;
+    }
+    printf("%u events, %.3f ms\n", n, n ? (events[n - 1].t_us - events[0].t_us) / 1000.0 : 0.0);
+
+    if (vcd_path) {
+        if (write_vcd(vcd_path, events, n) != 0) {
+            free(events);
+            return 2;
+        }
+        printf("VCD written to %s\n", vcd_path);
+    }
+
+    check_timing(events, n);
+    print_summary();
+    free(events);
+    return violations ? 1 : 0;
+}
@@ -0,0 +1,429 @@
+/**
+ * @file pipeline_bench.c
+ * @brief Host benchmark of the sensor pipeline for 1, 2, 8 and 32 sensors
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Runs the measurement cycle of temperature_sensor_task for one simulated
+ * hour per scenario: unmodified onewire_bus.c / ds18b20.c on the simulated
+ * line, then temp_history, report_policy and report_cycle with the packed
+ * frame encoder, with the loop delay jittered by report_scheduler. The
+ * Zigbee side is reduced to counting the frames the firmware would send.
+ * Per scenario it reports:
+ * - bus_us_per_cycle: bus hold time (cpu_account busy-wait) per cycle
+ * - read_ms_per_cycle: simulated time of the read phase (conversions included)
+ * - instructions_per_reading: host instructions of the processing after the
+ *   bus read (history, policy, frame), from the perf instruction counter
+ * - cpu_ns_per_reading: host CPU time of the same processing
+ * - stack_peak_bytes / heap_peak_bytes: high-water marks of the pipeline
+ *   thread (painted stack) and of heap allocations (wrapped malloc)
+ * - standard_frames_per_h / packed_frames_per_h: reports per hour by mode;
+ *   packed is null above REPORT_FRAME_PACKED_MAX_SENSORS (no single frame)
+ *
+ * Output is one JSON object on stdout (CI compares it against a baseline);
+ * a readable summary goes to stderr. instructions_per_reading is null when
+ * perf_event_open is denied (kernel.perf_event_paranoid > 2, or no
+ * CAP_PERFMON in a container); the reason goes to stderr and the check is
+ * left to CI. Exit status is non-zero if a clean line produced read errors.
+ *
+ * The sensor count is a compile-time limit of the firmware modules, so
+ * this target is built with SENSOR_MAX_COUNT=32 (see CMakeLists.txt).
+ */
+
+#define _GNU_SOURCE
+#include "onewire_bus.h"
+#include "ds18b20.h"
+#include "onewire_sim.h"
+#include "cpu_account.h"
+#include "temp_history.h"
+#include "report_policy.h"
+#include "report_scheduler.h"
+#include "report_frame.h"
+#include "report_cycle.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <linux/perf_event.h>
+#include <errno.h>
+#include <malloc.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_DURATION_S     3600
+#define BENCH_LOOP_PERIOD_MS 5000          // SENSOR_LOOP_PERIOD_MS in main.c
+#define BENCH_STACK_SIZE     (512 * 1024)
+#define BENCH_STACK_PAINT    0xA5
+
+static const uint8_t scenario_sensors[] = {1, 2, 8, 32};
+
+typedef struct {
+    uint8_t sensors;
+    uint32_t cycles;
+    uint32_t readings;
+    uint32_t read_errors;
+    double bus_us_per_cycle;
+    double read_ms_per_cycle;
+    int64_t instructions_per_reading;   ///< -1 = unavailable
+    double cpu_ns_per_reading;
+    size_t stack_peak_bytes;
+    size_t heap_peak_bytes;
+    double standard_frames_per_h;
+    double packed_frames_per_h;         ///< -1 = not applicable (more sensors than one packed frame holds)
+    uint32_t packed_encode_failures;    ///< Publishes whose readings did not fit one packed frame
+} scenario_result_t;
+
+/* ---- Heap accounting (linked with -Wl,--wrap=malloc,...) ---- */
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+static size_t heap_current;
+static size_t heap_peak;
+
+static void heap_note(void *ptr, bool add)
+{
+    if (!ptr) {
+        return;
+    }
+    size_t size = malloc_usable_size(ptr);
+    heap_current = add ? heap_current + size : heap_current - size;
+    if (heap_current > heap_peak) {
+        heap_peak = heap_current;
+    }
+}
+
+void *__wrap_malloc(size_t size)
+{
+    void *ptr = __real_malloc(size);
+    heap_note(ptr, true);
+    return ptr;
+}
+
+void *__wrap_calloc(size_t n, size_t size)
+{
+    void *ptr = __real_calloc(n, size);
+    heap_note(ptr, true);
+    return ptr;
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    heap_note(ptr, false);
+    void *out = __real_realloc(ptr, size);
+    heap_note(out ? out : ptr, true);
+    return out;
+}
+
+void __wrap_free(void *ptr)
+{
+    heap_note(ptr, false);
+    __real_free(ptr);
+}
+
+/* ---- Processing cost ---- */
+
+static int perf_fd = -1;
+static int perf_errno;                 ///< Why perf_event_open failed
+
+static void perf_open(void)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    perf_fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    perf_errno = perf_fd < 0 ? errno : 0;
+}
+
+/**
+ * @brief kernel.perf_event_paranoid for the error message, -99 if unknown
+ */
+static int perf_paranoid(void)
+{
+    int level = -99;
+    FILE *f = fopen("/proc/sys/kernel/perf_event_paranoid", "r");
+    if (f) {
+        if (fscanf(f, "%d", &level) != 1) {
+            level = -99;
+        }
+        fclose(f);
+    }
+    return level;
+}
+
+static int64_t thread_cpu_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+typedef struct {
+    int64_t cpu_ns;
+} cost_mark_t;
+
+static void cost_begin(cost_mark_t *mark)
+{
+    if (perf_fd >= 0) {
+        ioctl(perf_fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    mark->cpu_ns = thread_cpu_ns();
+}
+
+static void cost_end(const cost_mark_t *mark, int64_t *cpu_ns)
+{
+    *cpu_ns += thread_cpu_ns() - mark->cpu_ns;
+    if (perf_fd >= 0) {
+        ioctl(perf_fd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+}
+
+/* ---- Frame counting (report_cycle sink) ---- */
+
+typedef struct {
+    uint32_t standard;                  ///< Standard reports (one per reported sensor)
+    uint32_t packed;                    ///< Packed frames sent
+    uint32_t packed_failures;           ///< Packed frames that could not be encoded
+    uint8_t seq;
+} frame_count_t;
+
+static bool count_send_packed(const int16_t *values, uint8_t count, void *arg)
+{
+    frame_count_t *fc = arg;
+    uint8_t frame[REPORT_FRAME_MAX_LEN];
+
+    if (report_frame_encode_readings(frame, sizeof(frame), fc->seq++, values, count) == 0) {
+        fc->packed_failures++;
+        return false;
+    }
+    fc->packed++;
+    return true;
+}
+
+static void count_send_standard(uint8_t sensor, bool send_report, void *arg)
+{
+    frame_count_t *fc = arg;
+    (void)sensor;
+    fc->standard += send_report;
+}
+
+/* ---- Scenario ---- */
+
+static void *scenario_run(void *arg)
+{
+    scenario_result_t *res = arg;
+    static const uint8_t ieee[8] = {0x40, 0x4C, 0xCA, 0xFF, 0xFE, 0x00, 0x00, 0x01};
+    static ds18b20_device_t devs[SENSOR_MAX_COUNT];
+    float walk[SENSOR_MAX_COUNT];
+    uint32_t seed = 2026;
+
+    onewire_sim_config_t cfg = ONEWIRE_SIM_CONFIG_DEFAULT();
+    onewire_sim_init(&cfg);
+    for (uint8_t i = 0; i < res->sensors; i++) {
+        uint8_t rom[8];
+        onewire_sim_make_rom(0x4000 + i, rom);
+        onewire_sim_add_ds18b20(rom, 20.0f);
+        walk[i] = 20.0f + i * 0.25f;
+    }
+
+    onewire_bus_config_t bus_cfg = { .pin = GPIO_NUM_20 };
+    static onewire_bus_handle_t bus;
+    if (onewire_bus_init(&bus_cfg, &bus) != ESP_OK) {
+        fprintf(stderr, "onewire_bus_init failed\n");
+        exit(EXIT_FAILURE);
+    }
+    for (uint8_t i = 0; i < res->sensors; i++) {
+        uint8_t rom[8];
+        onewire_sim_make_rom(0x4000 + i, rom);
+        ds18b20_init(&devs[i], &bus, rom);
+    }
+
+    report_policy_t policy;
+    report_scheduler_t sched;
+    report_policy_init(&policy, REPORT_POLICY_DEFAULT_THRESHOLD_C);
+    report_scheduler_init(&sched, ieee, BENCH_LOOP_PERIOD_MS, REPORT_POLICY_DEFAULT_INTERVAL_MS);
+    uint32_t refresh_interval_ms = report_scheduler_next_interval_ms(&sched);
+    temp_history_init();
+
+    // BOTH mode: the packed frames of PACKED mode and the reports of STANDARD mode in one run
+    frame_count_t frames = {0};
+    const report_cycle_sink_t sink = {
+        .send_packed = count_send_packed,
+        .send_standard = count_send_standard,
+        .arg = &frames,
+    };
+    uint64_t bus_us = 0;
+    int64_t read_us = 0;
+    int64_t cpu_ns = 0;
+    int64_t start_us = esp_timer_get_time();
+
+    if (perf_fd >= 0) {
+        ioctl(perf_fd, PERF_EVENT_IOC_RESET, 0);
+    }
+
+    while (esp_timer_get_time() - start_us < (int64_t)BENCH_DURATION_S * 1000000) {
+        float temps[SENSOR_MAX_COUNT];
+        bool ok[SENSOR_MAX_COUNT];
+        int16_t values[SENSOR_MAX_COUNT];
+        report_reason_t reasons[SENSOR_MAX_COUNT];
+        cpu_account_stats_t before, after;
+        cost_mark_t mark;
+
+        // Slow random walk in 1/16°C steps with an occasional 2°C jump
+        for (uint8_t i = 0; i < res->sensors; i++) {
+            seed = seed * 1103515245u + 12345u;
+            walk[i] += ((int)((seed >> 16) % 3) - 1) * 0.0625f;
+            if ((seed >> 8) % 720 == 0) {
+                walk[i] += (seed & 1) ? 2.0f : -2.0f;
+            }
+            onewire_sim_set_temperature(i, walk[i]);
+        }
+
+        int64_t cycle_start = esp_timer_get_time();
+        cpu_account_get(NULL, &before);
+        for (uint8_t i = 0; i < res->sensors; i++) {
+            ok[i] = ds18b20_get_temperature(&devs[i], ONEWIRE_BUS_PRIO_PERIODIC, &temps[i]) == ESP_OK;
+            res->readings++;
+            res->read_errors += !ok[i];
+
+            cost_begin(&mark);
+            values[i] = ok[i] ? (int16_t)(temps[i] * 100) : REPORT_FRAME_VALUE_INVALID;
+            if (ok[i]) {
+                temp_history_add(i, (uint32_t)(esp_timer_get_time() / 1000000), values[i]);
+            }
+            cost_end(&mark, &cpu_ns);
+        }
+        cpu_account_get(NULL, &after);
+        bus_us += after.total_us[CPU_ACCOUNT_BUSY_WAIT] - before.total_us[CPU_ACCOUNT_BUSY_WAIT];
+        read_us += esp_timer_get_time() - cycle_start;
+
+        cost_begin(&mark);
+        uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+        if (report_policy_decide(&policy, now_ms, refresh_interval_ms, true, ok, temps, res->sensors, reasons)) {
+            report_cycle_send(REPORT_MODE_BOTH, reasons, values, res->sensors, &sink);
+            refresh_interval_ms = report_scheduler_next_interval_ms(&sched);
+        }
+        cost_end(&mark, &cpu_ns);
+
+        res->cycles++;
+        vTaskDelay(pdMS_TO_TICKS(report_scheduler_next_loop_delay_ms(&sched)));
+    }
+
+    double hours = (esp_timer_get_time() - start_us) / 3600e6;
+    res->bus_us_per_cycle = (double)bus_us / res->cycles;
+    res->read_ms_per_cycle = read_us / 1000.0 / res->cycles;
+    res->cpu_ns_per_reading = (double)cpu_ns / res->readings;
+    res->standard_frames_per_h = frames.standard / hours;
+    res->packed_frames_per_h = res->sensors <= REPORT_FRAME_PACKED_MAX_SENSORS ? frames.packed / hours : -1;
+    res->packed_encode_failures = frames.packed_failures;
+    res->instructions_per_reading = -1;
+    if (perf_fd >= 0) {
+        uint64_t instructions = 0;
+        if (read(perf_fd, &instructions, sizeof(instructions)) == sizeof(instructions)) {
+            res->instructions_per_reading = (int64_t)(instructions / res->readings);
+        }
+    }
+    return NULL;
+}
+
+static void scenario(scenario_result_t *res)
+{
+    static uint8_t stack[BENCH_STACK_SIZE] __attribute__((aligned(64)));
+    pthread_attr_t attr;
+    pthread_t thread;
+
+    memset(stack, BENCH_STACK_PAINT, sizeof(stack));
+    heap_peak = heap_current;
+    size_t heap_base = heap_current;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, stack, sizeof(stack));
+    if (pthread_create(&thread, &attr, scenario_run, res) != 0) {
+        perror("pthread_create");
+        exit(EXIT_FAILURE);
+    }
+    pthread_join(thread, NULL);
+    pthread_attr_destroy(&attr);
+
+    size_t untouched = 0;
+    while (untouched < sizeof(stack) && stack[untouched] == BENCH_STACK_PAINT) {
+        untouched++;
+    }
+    res->stack_peak_bytes = sizeof(stack) - untouched;
+    res->heap_peak_bytes = heap_peak - heap_base;
+}
+
+int main(void)
+{
+    const size_t count = sizeof(scenario_sensors);
+    scenario_result_t results[sizeof(scenario_sensors)];
+    int failures = 0;
+
+    shim_log_set_level(ESP_LOG_NONE);
+    perf_open();
+    if (perf_fd < 0) {
+        fprintf(stderr, "perf_event_open(instructions) failed: %s (kernel.perf_event_paranoid = %d), "
+                "instructions_per_reading is null\n", strerror(perf_errno), perf_paranoid());
+    }
+
+    fprintf(stderr, "%7s %7s %10s %9s %10s %8s %8s %10s %10s\n", "sensors", "cycles", "bus us/cy", "read ms",
+            "cpu ns/rd", "stack", "heap", "std fr/h", "pack fr/h");
+    for (size_t s = 0; s < count; s++) {
+        scenario_result_t *res = &results[s];
+        memset(res, 0, sizeof(*res));
+        res->sensors = scenario_sensors[s];
+        scenario(res);
+        failures += res->read_errors != 0;
+        fprintf(stderr, "%7u %7u %10.0f %9.1f %10.0f %8zu %8zu %10.1f ", res->sensors,
+                (unsigned)res->cycles, res->bus_us_per_cycle, res->read_ms_per_cycle, res->cpu_ns_per_reading,
+                res->stack_peak_bytes, res->heap_peak_bytes, res->standard_frames_per_h);
+        if (res->packed_frames_per_h >= 0) {
+            fprintf(stderr, "%10.1f\n", res->packed_frames_per_h);
+        } else {
+            fprintf(stderr, "%10s (more than %d sensors per frame)\n", "-", REPORT_FRAME_PACKED_MAX_SENSORS);
+        }
+    }
+
+    printf("{\"benchmark\":\"pipeline\",\"duration_s\":%d,\"loop_period_ms\":%d,\"scenarios\":[",
+           BENCH_DURATION_S, BENCH_LOOP_PERIOD_MS);
+    for (size_t s = 0; s < count; s++) {
+        const scenario_result_t *res = &results[s];
+        printf("%s{\"sensors\":%u,\"cycles\":%u,\"readings\":%u,\"read_errors\":%u,"
+               "\"bus_us_per_cycle\":%.1f,\"read_ms_per_cycle\":%.1f,",
+               s ? "," : "", res->sensors, (unsigned)res->cycles, (unsigned)res->readings,
+               (unsigned)res->read_errors, res->bus_us_per_cycle, res->read_ms_per_cycle);
+        if (res->instructions_per_reading >= 0) {
+            printf("\"instructions_per_reading\":%lld,", (long long)res->instructions_per_reading);
+        } else {
+            printf("\"instructions_per_reading\":null,");
+        }
+        printf("\"cpu_ns_per_reading\":%.0f,\"stack_peak_bytes\":%zu,\"heap_peak_bytes\":%zu,"
+               "\"standard_frames_per_h\":%.1f,",
+               res->cpu_ns_per_reading, res->stack_peak_bytes, res->heap_peak_bytes, res->standard_frames_per_h);
+        if (res->packed_frames_per_h >= 0) {
+            printf("\"packed_frames_per_h\":%.1f,", res->packed_frames_per_h);
+        } else {
+            printf("\"packed_frames_per_h\":null,");
+        }
+        printf("\"packed_encode_failures\":%u}", (unsigned)res->packed_encode_failures);
+    }
+    printf("]}\n");
+
+    if (failures) {
+        fprintf(stderr, "read errors on a clean simulated line\n");
+    }
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,116 @@
+/**
+ * @file profile_size.c
+ * @brief Sensor path of one build profile, linked for flash/RAM measurement
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Mirrors what the firmware sensor task pulls in for the compile-time
+ * switches set from Kconfig (SENSOR_MAX_COUNT, ONEWIRE_SEARCH_ENABLED,
+ * DS18B20_MATCH_ROM_ENABLED, ONEWIRE_FIXED_TIMING): bus init, discovery,
+ * one hot-plug verification, reads, history and report decision. The
+ * profile_size target links it once per profile with section garbage
+ * collection, like the firmware link, and compares size(1) totals; run as a
+ * program it performs the cycles against the simulated bus as a sanity check.
+ *
+ *   cmake --build host/build --target profile_size
+ */
+
+#include "onewire_bus.h"
+#include "ds18b20.h"
+#include "onewire_sim.h"
+#include "sensor_config.h"
+#include "temp_history.h"
+#include "report_policy.h"
+#include "esp_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define PROFILE_CYCLES          4
+#define PROFILE_PERIOD_MS       5000
+#define PROFILE_READ_SAMPLES    1       // Firmware default (THERMO_ONEWIRE_READ_SAMPLES)
+
+static onewire_bus_handle_t bus;
+static ds18b20_device_t devs[SENSOR_MAX_COUNT];
+static report_policy_t policy;
+
+static uint8_t profile_discover(void)
+{
+#if DS18B20_MATCH_ROM_ENABLED && ONEWIRE_SEARCH_ENABLED
+    onewire_search_state_t search;
+    uint8_t rom[8];
+    uint8_t count = 0;
+
+    onewire_bus_acquire(&bus, ONEWIRE_BUS_PRIO_PERIODIC, DS18B20_BUS_TIMEOUT_MS);
+    onewire_bus_search_reset(&search);
+    while (count < SENSOR_MAX_COUNT && onewire_bus_search_next(&bus, &search, rom)) {
+        ds18b20_init(&devs[count++], &bus, rom);
+    }
+    onewire_bus_release(&bus);
+
+    // Hot-plug verification of the first sensor, as in a rescan round
+    if (count > 0) {
+        onewire_bus_acquire(&bus, ONEWIRE_BUS_PRIO_BACKGROUND, DS18B20_BUS_TIMEOUT_MS);
+        if (!onewire_bus_verify_rom(&bus, devs[0].rom)) {
+            fprintf(stderr, "sensor 1 failed ROM verification\n");
+        }
+        onewire_bus_release(&bus);
+    }
+    return count;
+#else
+    ds18b20_init_skip_rom(&devs[0], &bus);
+    return 1;
+#endif
+}
+
+int main(void)
+{
+    int failures = 0;
+
+    shim_log_set_level(ESP_LOG_NONE);
+
+    onewire_sim_config_t cfg = ONEWIRE_SIM_CONFIG_DEFAULT();
+    onewire_sim_init(&cfg);
+    for (uint8_t i = 0; i < SENSOR_MAX_COUNT; i++) {
+        uint8_t rom[8];
+        onewire_sim_make_rom(0x5000 + i, rom);
+        onewire_sim_add_ds18b20(rom, 20.0f + i);
+    }
+
+    onewire_bus_config_t bus_cfg = { .pin = GPIO_NUM_20 };
+    if (onewire_bus_init(&bus_cfg, &bus) != ESP_OK) {
+        fprintf(stderr, "onewire_bus_init failed\n");
+        return EXIT_FAILURE;
+    }
+    onewire_bus_set_read_samples(&bus, PROFILE_READ_SAMPLES);
+
+    uint8_t count = profile_discover();
+    temp_history_init();
+    report_policy_init(&policy, REPORT_POLICY_DEFAULT_THRESHOLD_C);
+
+    for (int cycle = 0; cycle < PROFILE_CYCLES; cycle++) {
+        bool ok[SENSOR_MAX_COUNT] = {0};
+        float values[SENSOR_MAX_COUNT] = {0};
+        report_reason_t reasons[SENSOR_MAX_COUNT];
+        uint32_t now_ms = (uint32_t)cycle * PROFILE_PERIOD_MS;
+
+        for (uint8_t i = 0; i < count; i++) {
+            ok[i] = ds18b20_get_temperature(&devs[i], ONEWIRE_BUS_PRIO_PERIODIC, &values[i]) == ESP_OK;
+            if (ok[i]) {
+                temp_history_add(i, now_ms / 1000, (int16_t)(values[i] * 100.0f));
+            } else {
+                failures++;
+            }
+        }
+        if (report_policy_decide(&policy, now_ms, REPORT_POLICY_DEFAULT_INTERVAL_MS, true, ok, values, count, reasons)) {
+            for (uint8_t i = 0; i < count; i++) {
+                if (reasons[i] != REPORT_REASON_NONE) {
+                    report_policy_mark_reported(&policy, i, values[i], now_ms);
+                }
+            }
+        }
+    }
+
+    printf("%u sensor(s), %d failed read(s)\n", count, failures);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,49 @@
+# ESP32-C6 Zigbee Thermometer - flash/RAM per build profile (profile_size target)
+# Inputs: SIZE_TOOL, PROFILES (e.g. default|single_skip_rom) and BINARY_<name>
+# (linked profile_size executable). Runs each binary once as a sanity check,
+# then prints text and data + bss bytes and the difference to the first profile.
+
+string(REPLACE "|" ";" PROFILES "${PROFILES}")
+
+function(pad out width text)
+    string(LENGTH "${text}" len)
+    set(result "${text}")
+    while(len LESS width)
+        string(PREPEND result " ")
+        math(EXPR len "${len} + 1")
+    endwhile()
+    set(${out} "${result}" PARENT_SCOPE)
+endfunction()
+
+foreach(p ${PROFILES})
+    execute_process(COMMAND ${BINARY_${p}} OUTPUT_QUIET RESULT_VARIABLE rc)
+    if(NOT rc EQUAL 0)
+        message(FATAL_ERROR "profile ${p}: sensor path failed on the simulated bus")
+    endif()
+    execute_process(COMMAND ${SIZE_TOOL} --format=berkeley ${BINARY_${p}}
+                    OUTPUT_VARIABLE out RESULT_VARIABLE rc)
+    if(NOT rc EQUAL 0 OR NOT out MATCHES "\n[ \t]*([0-9]+)[ \t]+([0-9]+)[ \t]+([0-9]+)[ \t]")
+        message(FATAL_ERROR "${SIZE_TOOL} failed for profile ${p}")
+    endif()
+    set(text_${p} ${CMAKE_MATCH_1})
+    math(EXPR ram_${p} "${CMAKE_MATCH_2} + ${CMAKE_MATCH_3}")
+endforeach()
+
+list(GET PROFILES 0 base)
+message("Linked sensor path per profile (bytes, host -Os --gc-sections, deltas vs. ${base})\n")
+set(header "profile                 ")
+foreach(h text data+bss dtext dram)
+    pad(cell 10 "${h}")
+    string(APPEND header "${cell}")
+endforeach()
+message("${header}")
+foreach(p ${PROFILES})
+    string(SUBSTRING "${p}                          " 0 24 row)
+    math(EXPR dtext "${text_${p}} - ${text_${base}}")
+    math(EXPR dram "${ram_${p}} - ${ram_${base}}")
+    foreach(v ${text_${p}} ${ram_${p}} ${dtext} ${dram})
+        pad(cell 10 "${v}")
+        string(APPEND row "${cell}")
+    endforeach()
+    message("${row}")
+endforeach()
@@ -0,0 +1,307 @@
+/**
+ * @file report_replay.c
+ * @brief Replay temperature traces through the report policy (report_policy.c)
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Feeds a recorded trace, cycle by cycle, through the same decision code
+ * the sensor task runs, with the trace timestamps as the clock and the
+ * periodic refresh interval jittered by report_scheduler.c, and reports
+ * per threshold:
+ * - Frames: one per reported sensor in standard mode, one per publish in
+ *   packed mode
+ * - Detection latency: time from the reported value falling behind the
+ *   true reading by more than the tolerance until a report catches up
+ * - Maximum and mean error of the last reported value (what the
+ *   coordinator sees) against the true reading
+ *
+ * Trace format (CSV, one line per sensor cycle, '#' comments and a header
+ * line are skipped; an empty or 'nan' field is a failed read):
+ *   time_s,sensor1,sensor2,...
+ *
+ * Without a trace file a synthetic day is generated (5 s cycle): slow drift,
+ * read noise, short ramps of 0.3..3°C and a daily step change, so the
+ * thresholds of the sweep trade frames against latency differently.
+ *
+ * Usage:
+ *   report_replay [-t threshold_c] [-i interval_s] [-e tolerance_c] [trace.csv]
+ * Without -t a sweep of thresholds is printed.
+ */
+
+#include "report_policy.h"
+#include "report_scheduler.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REPLAY_MAX_CYCLES    (400 * 1000)
+#define REPLAY_LINE_LEN      512
+#define SYNTH_PERIOD_S       5
+#define SYNTH_DURATION_S     (24 * 3600)
+#define SYNTH_NOISE_C        0.08f         // Peak read noise (before 1/16°C quantization)
+#define SYNTH_RAMP_EVERY_S   1200          // One ramp event per sensor every 20 minutes
+#define SYNTH_RAMP_RISE_S    40            // Ramp up, then down after SYNTH_RAMP_HOLD_S
+#define SYNTH_RAMP_HOLD_S    300
+
+static const float sweep_thresholds_c[] = {0.125f, 0.25f, 0.5f, 1.0f, 2.0f};
+static const float synth_ramps_c[] = {0.3f, -0.6f, 1.2f, -0.4f, 2.5f, 0.8f, -1.5f, 3.0f};
+
+/**
+ * @brief One trace line
+ */
+typedef struct {
+    double time_s;
+    bool ok[REPORT_POLICY_MAX_SENSORS];
+    float values[REPORT_POLICY_MAX_SENSORS];
+} replay_cycle_t;
+
+typedef struct {
+    uint32_t publishes;              ///< Cycles with at least one report (packed frames)
+    uint32_t reports;                ///< Reported sensor values (standard frames)
+    uint32_t excursions;             ///< Times the error exceeded the tolerance
+    double latency_sum_s;
+    double latency_max_s;
+    double error_max_c;
+    double error_sum_c;
+    uint32_t error_samples;
+} replay_result_t;
+
+static replay_cycle_t cycles[REPLAY_MAX_CYCLES];
+static uint32_t cycle_count;
+static uint8_t sensor_count;
+
+static bool load_trace(const char *path)
+{
+    FILE *f = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    char line[REPLAY_LINE_LEN];
+    bool truncated = false;
+
+    if (!f) {
+        perror(path);
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), f) && cycle_count < REPLAY_MAX_CYCLES) {
+        char *field = strtok(line, ",\r\n");
+        char *end;
+        if (!field || field[0] == '#') {
+            continue;
+        }
+        double t = strtod(field, &end);
+        if (end == field) {
+            continue;   // Header line
+        }
+
+        replay_cycle_t *c = &cycles[cycle_count++];
+        uint8_t n = 0;
+        c->time_s = t;
+        // strtok would merge empty fields, so walk the rest by hand
+        for (char *p = field + strlen(field) + 1; *p && *p != '\n' && *p != '\r'; n++) {
+            char *next = p + strcspn(p, ",\r\n");
+            char saved = *next;
+            *next = '\0';
+            if (n < REPORT_POLICY_MAX_SENSORS) {
+                float v = strtof(p, &end);
+                c->ok[n] = end != p && !isnan(v);
+                c->values[n] = c->ok[n] ? v : NAN;
+            } else {
+                truncated = true;
+            }
+            if (saved != ',') {
+                n++;
+                break;
+            }
+            p = next + 1;
+        }
+        if (n > REPORT_POLICY_MAX_SENSORS) {
+            n = REPORT_POLICY_MAX_SENSORS;
+        }
+        if (n > sensor_count) {
+            sensor_count = n;
+        }
+    }
+
+    if (f != stdin) {
+        fclose(f);
+    }
+    if (truncated) {
+        fprintf(stderr, "warning: only the first %d sensor columns are replayed (SENSOR_MAX_COUNT)\n",
+                REPORT_POLICY_MAX_SENSORS);
+    }
+    return cycle_count > 0 && sensor_count > 0;
+}
+
+/**
+ * @brief Offset of the current ramp event of a sensor (trapezoid: rise, hold, fall)
+ */
+static float synth_ramp(uint32_t t, uint8_t s)
+{
+    uint32_t phase = (t + s * SYNTH_RAMP_EVERY_S / 2) % SYNTH_RAMP_EVERY_S;
+    uint32_t event = (t + s * SYNTH_RAMP_EVERY_S / 2) / SYNTH_RAMP_EVERY_S + s;
+    float amplitude = synth_ramps_c[event % (sizeof(synth_ramps_c) / sizeof(synth_ramps_c[0]))];
+
+    if (phase < SYNTH_RAMP_RISE_S) {
+        return amplitude * phase / SYNTH_RAMP_RISE_S;
+    }
+    if (phase < SYNTH_RAMP_RISE_S + SYNTH_RAMP_HOLD_S) {
+        return amplitude;
+    }
+    if (phase < 2 * SYNTH_RAMP_RISE_S + SYNTH_RAMP_HOLD_S) {
+        return amplitude * (2 * SYNTH_RAMP_RISE_S + SYNTH_RAMP_HOLD_S - phase) / SYNTH_RAMP_RISE_S;
+    }
+    return 0;
+}
+
+/**
+ * @brief Synthetic day: drift, read noise, ramps and a step change, 1/16°C resolution
+ */
+static void synth_trace(void)
+{
+    uint32_t seed = 12345;
+    float walk[REPORT_POLICY_MAX_SENSORS] = {0};
+
+    sensor_count = REPORT_POLICY_MAX_SENSORS;
+    for (uint32_t t = 0; t < SYNTH_DURATION_S && cycle_count < REPLAY_MAX_CYCLES; t += SYNTH_PERIOD_S) {
+        replay_cycle_t *c = &cycles[cycle_count++];
+        c->time_s = t;
+        for (uint8_t s = 0; s < sensor_count; s++) {
+            seed = seed * 1103515245u + 12345u;
+            walk[s] += ((int)((seed >> 16) % 3) - 1) * 0.01f;
+            float noise = (((seed >> 4) & 0xFFF) / 4095.0f * 2 - 1) * SYNTH_NOISE_C;
+            float v = 21.0f + s + 2.0f * sinf(2 * (float)M_PI * t / SYNTH_DURATION_S) + walk[s] +
+                      synth_ramp(t, s) + noise;
+            if ((t / 3600) % 6 == 5 && s == 0) {
+                v -= 4.0f;  // Window open for an hour every 6 hours
+            }
+            c->values[s] = roundf(v * 16) / 16;
+            c->ok[s] = (seed >> 8) % 500 != 0;  // ~0.2% failed reads
+        }
+    }
+}
+
+static void replay(float threshold_c, uint32_t interval_ms, float tolerance_c, replay_result_t *res)
+{
+    static const uint8_t ieee[8] = {0x40, 0x4C, 0xCA, 0xFF, 0xFE, 0x00, 0x00, 0x01};
+    report_policy_t policy;
+    report_scheduler_t sched;
+    float received[REPORT_POLICY_MAX_SENSORS];
+    double excursion_start[REPORT_POLICY_MAX_SENSORS];
+
+    memset(res, 0, sizeof(*res));
+    report_policy_init(&policy, threshold_c);
+    report_scheduler_init(&sched, ieee, SYNTH_PERIOD_S * 1000, interval_ms);
+    uint32_t refresh_interval_ms = report_scheduler_next_interval_ms(&sched);
+    for (uint8_t s = 0; s < REPORT_POLICY_MAX_SENSORS; s++) {
+        received[s] = NAN;
+        excursion_start[s] = -1;
+    }
+
+    for (uint32_t n = 0; n < cycle_count; n++) {
+        const replay_cycle_t *c = &cycles[n];
+        report_reason_t reasons[REPORT_POLICY_MAX_SENSORS];
+        uint32_t now_ms = (uint32_t)(uint64_t)llround(c->time_s * 1000);
+
+        if (report_policy_decide(&policy, now_ms, refresh_interval_ms, true, c->ok, c->values, sensor_count, reasons)) {
+            res->publishes++;
+            refresh_interval_ms = report_scheduler_next_interval_ms(&sched);
+        }
+
+        for (uint8_t s = 0; s < sensor_count; s++) {
+            if (reasons[s] != REPORT_REASON_NONE) {
+                res->reports++;
+                received[s] = c->values[s];
+            }
+            if (!c->ok[s] || isnan(received[s])) {
+                continue;
+            }
+
+            double err = fabs(c->values[s] - received[s]);
+            res->error_sum_c += err;
+            res->error_samples++;
+            if (err > res->error_max_c) {
+                res->error_max_c = err;
+            }
+
+            if (err > tolerance_c && excursion_start[s] < 0) {
+                excursion_start[s] = c->time_s;
+                res->excursions++;
+            } else if (err <= tolerance_c && excursion_start[s] >= 0) {
+                double latency = c->time_s - excursion_start[s];
+                res->latency_sum_s += latency;
+                if (latency > res->latency_max_s) {
+                    res->latency_max_s = latency;
+                }
+                excursion_start[s] = -1;
+            }
+        }
+    }
+}
+
+static void print_row(float threshold_c, const replay_result_t *res, double hours)
+{
+    printf("%9.3f | %8u %8.1f | %8u %8.1f | %6u %8.1f %8.1f | %7.3f %7.3f\n", threshold_c,
+           (unsigned)res->reports, res->reports / hours, (unsigned)res->publishes, res->publishes / hours,
+           (unsigned)res->excursions, res->excursions ? res->latency_sum_s / res->excursions : 0.0,
+           res->latency_max_s, res->error_max_c, res->error_samples ? res->error_sum_c / res->error_samples : 0.0);
+}
+
+int main(int argc, char **argv)
+{
+    float threshold_c = NAN;
+    uint32_t interval_ms = REPORT_POLICY_DEFAULT_INTERVAL_MS;
+    float tolerance_c = NAN;
+    const char *path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            threshold_c = strtof(argv[++i], NULL);
+        } else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+            interval_ms = (uint32_t)(strtod(argv[++i], NULL) * 1000);
+        } else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+            tolerance_c = strtof(argv[++i], NULL);
+        } else if (argv[i][0] != '-' || strcmp(argv[i], "-") == 0) {
+            path = argv[i];
+        } else {
+            fprintf(stderr, "usage: %s [-t threshold_c] [-i interval_s] [-e tolerance_c] [trace.csv|-]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (path) {
+        if (!load_trace(path)) {
+            fprintf(stderr, "no usable cycles in %s\n", path);
+            return EXIT_FAILURE;
+        }
+    } else {
+        synth_trace();
+    }
+    if (isnan(tolerance_c)) {
+        tolerance_c = isnan(threshold_c) ? REPORT_POLICY_DEFAULT_THRESHOLD_C / 2 : threshold_c / 2;
+    }
+
+    double hours = (cycles[cycle_count - 1].time_s - cycles[0].time_s) / 3600;
+    if (hours <= 0) {
+        hours = 1;
+    }
+    printf("Report policy replay: %s, %u cycles, %u sensor(s), %.1f h, refresh interval %us, tolerance %.3fC\n\n",
+           path ? path : "synthetic day", (unsigned)cycle_count, sensor_count, hours,
+           (unsigned)(interval_ms / 1000), tolerance_c);
+    printf("%9s | %17s | %17s | %24s | %15s\n", "threshold", "standard frames", "packed frames",
+           "latency > tolerance (s)", "error (C)");
+    printf("%9s | %8s %8s | %8s %8s | %6s %8s %8s | %7s %7s\n", "C", "total", "per h", "total", "per h",
+           "count", "mean", "max", "max", "mean");
+
+    replay_result_t res;
+    if (!isnan(threshold_c)) {
+        replay(threshold_c, interval_ms, tolerance_c, &res);
+        print_row(threshold_c, &res, hours);
+    } else {
+        for (size_t i = 0; i < sizeof(sweep_thresholds_c) / sizeof(sweep_thresholds_c[0]); i++) {
+            replay(sweep_thresholds_c[i], interval_ms, tolerance_c, &res);
+            print_row(sweep_thresholds_c[i], &res, hours);
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,15 @@
+/**
+ * @file esp_cpu.h
+ * @brief Host shim: CPU cycle counter derived from virtual simulation time
+ */
+
+#ifndef SHIM_ESP_CPU_H
+#define SHIM_ESP_CPU_H
+
+#include <stdint.h>
+
+typedef uint32_t esp_cpu_cycle_count_t;
+
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void);
+
+#endif // SHIM_ESP_CPU_H
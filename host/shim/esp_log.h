@@ -0,0 +1,32 @@
+/**
+ * @file esp_log.h
+ * @brief Host shim: ESP-IDF logging to stdout
+ */
+
+#ifndef SHIM_ESP_LOG_H
+#define SHIM_ESP_LOG_H
+
+typedef enum {
+    ESP_LOG_NONE = 0,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE,
+} esp_log_level_t;
+
+/**
+ * @brief Maximum level printed by the host shim (default ESP_LOG_WARN)
+ */
+void shim_log_set_level(esp_log_level_t level);
+
+void shim_log(esp_log_level_t level, const char *tag, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+
+#define ESP_LOGE(tag, ...) shim_log(ESP_LOG_ERROR, tag, __VA_ARGS__)
+#define ESP_LOGW(tag, ...) shim_log(ESP_LOG_WARN, tag, __VA_ARGS__)
+#define ESP_LOGI(tag, ...) shim_log(ESP_LOG_INFO, tag, __VA_ARGS__)
+#define ESP_LOGD(tag, ...) shim_log(ESP_LOG_DEBUG, tag, __VA_ARGS__)
+#define ESP_LOGV(tag, ...) shim_log(ESP_LOG_VERBOSE, tag, __VA_ARGS__)
+
+#endif // SHIM_ESP_LOG_H
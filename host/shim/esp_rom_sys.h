@@ -0,0 +1,14 @@
+/**
+ * @file esp_rom_sys.h
+ * @brief Host shim: busy-wait delays advance virtual simulation time
+ */
+
+#ifndef SHIM_ESP_ROM_SYS_H
+#define SHIM_ESP_ROM_SYS_H
+
+#include <stdint.h>
+
+void esp_rom_delay_us(uint32_t us);
+uint32_t esp_rom_get_cpu_ticks_per_us(void);
+
+#endif // SHIM_ESP_ROM_SYS_H
@@ -0,0 +1,192 @@
+/**
+ * @file esp_shim.c
+ * @brief Host shim: ESP-IDF / FreeRTOS calls backed by the 1-Wire simulator
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Single-threaded: every clock (esp_timer, tick count, CPU cycle counter)
+ * is derived from the simulator's virtual time, and every delay advances
+ * it. Semaphores are plain counters; a take that would block fails
+ * immediately, which matches an uncontended bus in a single client.
+ */
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
+#include "esp_cpu.h"
+#include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "onewire_sim.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SHIM_CPU_TICKS_PER_US   160     ///< ESP32-C6 default CPU clock
+
+struct shim_semaphore {
+    int count;
+};
+
+static esp_log_level_t log_level = ESP_LOG_WARN;
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+    case ESP_OK:                return "ESP_OK";
+    case ESP_FAIL:              return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:        return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:   return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE:  return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND:     return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT:       return "ESP_ERR_TIMEOUT";
+    default:                    return "UNKNOWN ERROR";
+    }
+}
+
+void shim_abort(const char *file, int line, const char *expr, esp_err_t err)
+{
+    fprintf(stderr, "ESP_ERROR_CHECK failed: %s (%s) at %s:%d\n", esp_err_to_name(err), expr, file, line);
+    abort();
+}
+
+void shim_log_set_level(esp_log_level_t level)
+{
+    log_level = level;
+}
+
+void shim_log(esp_log_level_t level, const char *tag, const char *fmt, ...)
+{
+    static const char letters[] = "NEWIDV";
+
+    if (level > log_level) {
+        return;
+    }
+    printf("%c (%lld) %s: ", letters[level], (long long)(esp_timer_get_time() / 1000), tag);
+    va_list args;
+    va_start(args, fmt);
+    vprintf(fmt, args);
+    va_end(args);
+    printf("\n");
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return onewire_sim_now_ns() / 1000;
+}
+
+void esp_rom_delay_us(uint32_t us)
+{
+    onewire_sim_advance_ns((int64_t)us * 1000);
+}
+
+uint32_t esp_rom_get_cpu_ticks_per_us(void)
+{
+    return SHIM_CPU_TICKS_PER_US;
+}
+
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void)
+{
+    return (esp_cpu_cycle_count_t)(onewire_sim_now_ns() * SHIM_CPU_TICKS_PER_US / 1000);
+}
+
+static void gpio_access(void)
+{
+    onewire_sim_advance_ns((int64_t)(onewire_sim_config()->gpio_cost_us * 1000));
+}
+
+esp_err_t gpio_config(const gpio_config_t *config)
+{
+    (void)config;
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level)
+{
+    (void)gpio_num;
+    onewire_sim_master_drive(level == 0);
+    gpio_access();
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num)
+{
+    (void)gpio_num;
+    int level = onewire_sim_line_level();
+    gpio_access();
+    return level;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    onewire_sim_advance_ns((int64_t)pdTICKS_TO_MS(ticks) * 1000000);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return pdMS_TO_TICKS(onewire_sim_now_ns() / 1000000);
+}
+
+void vTaskSuspendAll(void)
+{
+}
+
+BaseType_t xTaskResumeAll(void)
+{
+    return pdFALSE;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    static int host_task;
+    return &host_task;
+}
+
+char *pcTaskGetName(TaskHandle_t task)
+{
+    (void)task;
+    return "host";
+}
+
+static SemaphoreHandle_t semaphore_create(int count)
+{
+    SemaphoreHandle_t sem = malloc(sizeof(*sem));
+    if (sem) {
+        sem->count = count;
+    }
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return semaphore_create(1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return semaphore_create(0);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    (void)ticks;
+    if (sem->count == 0) {
+        return pdFALSE;
+    }
+    sem->count--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    if (sem->count > 0) {
+        return pdFALSE;
+    }
+    sem->count++;
+    return pdTRUE;
+}
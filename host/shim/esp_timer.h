@@ -0,0 +1,13 @@
+/**
+ * @file esp_timer.h
+ * @brief Host shim: microsecond time base (virtual simulation time)
+ */
+
+#ifndef SHIM_ESP_TIMER_H
+#define SHIM_ESP_TIMER_H
+
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);
+
+#endif // SHIM_ESP_TIMER_H
@@ -0,0 +1,18 @@
+/**
+ * @file semphr.h
+ * @brief Host shim: counting semaphores without blocking (single thread)
+ */
+
+#ifndef SHIM_FREERTOS_SEMPHR_H
+#define SHIM_FREERTOS_SEMPHR_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct shim_semaphore *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+
+#endif // SHIM_FREERTOS_SEMPHR_H
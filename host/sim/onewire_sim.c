@@ -0,0 +1,515 @@
+/**
+ * @file onewire_sim.c
+ * @brief Host simulator of a 1-Wire line with DS18B20 slaves
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * The line level only changes at known instants (driver changes, end of
+ * rise time, scheduled slave actions), so time advances from event to event
+ * instead of in fixed steps; a 750 ms conversion costs nothing to simulate.
+ */
+
+#include "onewire_sim.h"
+#include <math.h>
+#include <string.h>
+
+#define NS_PER_US   1000
+#define NEVER       INT64_MAX
+
+typedef enum {
+    DEV_IDLE = 0,           ///< Not selected, waits for reset
+    DEV_PRESENCE,           ///< Presence pulse pending/running
+    DEV_ROM_CMD,            ///< Receiving ROM command
+    DEV_MATCH,              ///< Receiving 64-bit ROM of MATCH ROM
+    DEV_SEARCH,             ///< SEARCH ROM triplets
+    DEV_FUNC_CMD,           ///< Receiving function command
+    DEV_TX,                 ///< Sending tx buffer
+    DEV_CONVERTING,         ///< Read slots return conversion status
+} dev_state_t;
+
+typedef struct {
+    uint8_t rom[8];
+    bool connected;
+    int16_t raw;                ///< Current temperature (1/16 °C)
+    int16_t latched;            ///< Last converted value (power-on 85 °C)
+    int64_t convert_done_ns;
+    dev_state_t state;
+    uint8_t rx_byte;
+    uint8_t rx_bits;
+    uint8_t index;              ///< MATCH/SEARCH bit index
+    uint8_t search_phase;       ///< 0 = bit, 1 = complement, 2 = direction
+    uint8_t tx_buf[9];
+    uint8_t tx_len;
+    uint8_t tx_bit;
+    bool pull_low;
+    int64_t pull_end_ns;
+    int64_t sample_ns;
+    int64_t fall_ns;
+    int64_t presence_start_ns;
+    int64_t presence_end_ns;
+} sim_dev_t;
+
+static onewire_sim_config_t cfg;
+static sim_dev_t devs[ONEWIRE_SIM_MAX_DEVICES];
+static int dev_count;
+static int64_t now_ns;
+static bool master_low;
+static bool driven_prev;        ///< Line driven low at last update
+static int64_t release_ns;      ///< Time the last driver released the line
+static bool level_prev;
+static uint32_t rng_state;
+static uint32_t glitch_rng_state;   ///< Separate stream: noise does not shift slave timing draws
+static int64_t glitch_start_ns;
+static int64_t glitch_end_ns;
+static onewire_sim_stats_t stats;
+
+static int64_t us_to_ns(double us)
+{
+    return (int64_t)llround(us * NS_PER_US);
+}
+
+static double rand_unit(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x / 4294967296.0;
+}
+
+static double rand_range(double lo, double hi)
+{
+    return lo + (hi - lo) * rand_unit(&rng_state);
+}
+
+/**
+ * @brief Schedule next glitch after `from` (exponential inter-arrival time)
+ */
+static void glitch_schedule(int64_t from)
+{
+    if (cfg.glitch_rate_per_ms <= 0) {
+        glitch_start_ns = glitch_end_ns = NEVER;
+        return;
+    }
+    double gap_ms = -log(1.0 - rand_unit(&glitch_rng_state)) / cfg.glitch_rate_per_ms;
+    glitch_start_ns = from + us_to_ns(gap_ms * 1000);
+    glitch_end_ns = glitch_start_ns + us_to_ns(cfg.glitch_len_us);
+}
+
+static uint8_t sim_crc8(const uint8_t *data, int len)
+{
+    uint8_t crc = 0;
+    for (int i = 0; i < len; i++) {
+        uint8_t in = data[i];
+        for (int j = 0; j < 8; j++) {
+            uint8_t mix = (crc ^ in) & 1;
+            crc >>= 1;
+            if (mix) {
+                crc ^= 0x8C;
+            }
+            in >>= 1;
+        }
+    }
+    return crc;
+}
+
+static bool line_driven(void)
+{
+    if (master_low) {
+        return true;
+    }
+    for (int i = 0; i < dev_count; i++) {
+        if (devs[i].connected && devs[i].pull_low) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool line_level(void)
+{
+    return !line_driven() && now_ns - release_ns >= us_to_ns(cfg.rise_us);
+}
+
+static void dev_pull(sim_dev_t *d, double hold_us)
+{
+    d->pull_low = true;
+    d->pull_end_ns = now_ns + us_to_ns(hold_us);
+    stats.slave_bits_tx++;
+}
+
+static void dev_load_scratchpad(sim_dev_t *d)
+{
+    if (d->convert_done_ns != NEVER && now_ns >= d->convert_done_ns) {
+        d->convert_done_ns = NEVER;
+    }
+    uint8_t *p = d->tx_buf;
+    p[0] = (uint8_t)d->latched;
+    p[1] = (uint8_t)((uint16_t)d->latched >> 8);
+    p[2] = 0x4B;            // TH
+    p[3] = 0x46;            // TL
+    p[4] = 0x7F;            // 12-bit resolution
+    p[5] = 0xFF;
+    p[6] = 0x0C;
+    p[7] = 0x10;
+    p[8] = sim_crc8(p, 8);
+    d->tx_len = 9;
+    d->tx_bit = 0;
+    d->state = DEV_TX;
+}
+
+static void dev_receive(sim_dev_t *d, bool bit)
+{
+    stats.slave_bits_rx++;
+
+    switch (d->state) {
+    case DEV_ROM_CMD:
+    case DEV_FUNC_CMD:
+        d->rx_byte = (uint8_t)((d->rx_byte >> 1) | (bit ? 0x80 : 0));
+        if (++d->rx_bits < 8) {
+            return;
+        }
+        d->rx_bits = 0;
+        if (d->state == DEV_ROM_CMD) {
+            switch (d->rx_byte) {
+            case 0xCC:
+                d->state = DEV_FUNC_CMD;
+                break;
+            case 0x55:
+                d->state = DEV_MATCH;
+                d->index = 0;
+                break;
+            case 0xF0:
+                d->state = DEV_SEARCH;
+                d->index = 0;
+                d->search_phase = 0;
+                break;
+            case 0x33:
+                memcpy(d->tx_buf, d->rom, 8);
+                d->tx_len = 8;
+                d->tx_bit = 0;
+                d->state = DEV_TX;
+                break;
+            default:
+                d->state = DEV_IDLE;
+                break;
+            }
+        } else {
+            switch (d->rx_byte) {
+            case 0x44:
+                d->latched = d->raw;
+                d->convert_done_ns = now_ns + us_to_ns(cfg.conversion_ms * 1000);
+                d->state = DEV_CONVERTING;
+                break;
+            case 0xBE:
+                dev_load_scratchpad(d);
+                break;
+            default:
+                d->state = DEV_IDLE;
+                break;
+            }
+        }
+        break;
+    case DEV_MATCH:
+        if (bit != ((d->rom[d->index / 8] >> (d->index % 8)) & 1)) {
+            d->state = DEV_IDLE;
+        } else if (++d->index == 64) {
+            d->state = DEV_FUNC_CMD;
+            d->rx_bits = 0;
+        }
+        break;
+    case DEV_SEARCH:
+        if (bit != ((d->rom[d->index / 8] >> (d->index % 8)) & 1)) {
+            d->state = DEV_IDLE;
+        } else if (++d->index == 64) {
+            d->state = DEV_FUNC_CMD;
+            d->rx_bits = 0;
+        } else {
+            d->search_phase = 0;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+static void dev_falling_edge(sim_dev_t *d)
+{
+    d->fall_ns = now_ns;
+
+    switch (d->state) {
+    case DEV_ROM_CMD:
+    case DEV_FUNC_CMD:
+    case DEV_MATCH:
+        d->sample_ns = now_ns + us_to_ns(rand_range(cfg.slave_sample_min_us, cfg.slave_sample_max_us));
+        break;
+    case DEV_SEARCH: {
+        bool rom_bit = (d->rom[d->index / 8] >> (d->index % 8)) & 1;
+        if (d->search_phase == 2) {
+            d->sample_ns = now_ns + us_to_ns(rand_range(cfg.slave_sample_min_us, cfg.slave_sample_max_us));
+            break;
+        }
+        bool out = d->search_phase == 0 ? rom_bit : !rom_bit;
+        if (!out) {
+            dev_pull(d, rand_range(cfg.slave_hold_min_us, cfg.slave_hold_max_us));
+        }
+        d->search_phase++;
+        break;
+    }
+    case DEV_TX: {
+        bool out = (d->tx_buf[d->tx_bit / 8] >> (d->tx_bit % 8)) & 1;
+        if (!out) {
+            dev_pull(d, rand_range(cfg.slave_hold_min_us, cfg.slave_hold_max_us));
+        }
+        if (++d->tx_bit >= d->tx_len * 8) {
+            d->state = DEV_IDLE;
+        }
+        break;
+    }
+    case DEV_CONVERTING:
+        if (now_ns < d->convert_done_ns) {
+            dev_pull(d, rand_range(cfg.slave_hold_min_us, cfg.slave_hold_max_us));
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+static void dev_rising_edge(sim_dev_t *d)
+{
+    if (d->fall_ns == NEVER || now_ns - d->fall_ns < us_to_ns(cfg.reset_detect_us)) {
+        return;
+    }
+    if (d->state == DEV_PRESENCE && d->presence_start_ns != NEVER) {
+        return;     // Own presence pulse ending
+    }
+
+    stats.resets++;
+    d->state = DEV_PRESENCE;
+    d->pull_low = false;
+    d->sample_ns = NEVER;
+    d->rx_bits = 0;
+    d->presence_start_ns = now_ns + us_to_ns(rand_range(cfg.presence_wait_min_us, cfg.presence_wait_max_us));
+    d->presence_end_ns = d->presence_start_ns + us_to_ns(rand_range(cfg.presence_len_min_us, cfg.presence_len_max_us));
+}
+
+/**
+ * @brief Re-evaluate line after a change at now_ns and dispatch edges
+ */
+static void line_update(void)
+{
+    bool driven = line_driven();
+    if (driven_prev && !driven) {
+        release_ns = now_ns;
+    }
+    driven_prev = driven;
+
+    bool level = line_level();
+    if (level_prev && !level) {
+        stats.falling_edges++;
+        for (int i = 0; i < dev_count; i++) {
+            if (devs[i].connected) {
+                dev_falling_edge(&devs[i]);
+            }
+        }
+    } else if (!level_prev && level) {
+        for (int i = 0; i < dev_count; i++) {
+            if (devs[i].connected) {
+                dev_rising_edge(&devs[i]);
+            }
+        }
+    }
+    level_prev = level;
+    driven_prev = line_driven();
+}
+
+/**
+ * @brief Earliest pending event after now_ns (NEVER if none)
+ */
+static int64_t next_event_ns(void)
+{
+    int64_t next = NEVER;
+
+    if (!line_driven() && !level_prev) {
+        next = release_ns + us_to_ns(cfg.rise_us);
+    }
+    for (int i = 0; i < dev_count; i++) {
+        const sim_dev_t *d = &devs[i];
+        if (!d->connected) {
+            continue;
+        }
+        if (d->pull_low && d->pull_end_ns < next) {
+            next = d->pull_end_ns;
+        }
+        if (d->sample_ns < next) {
+            next = d->sample_ns;
+        }
+        if (d->presence_start_ns < next) {
+            next = d->presence_start_ns;
+        }
+    }
+    return next;
+}
+
+/**
+ * @brief Execute slave actions due at now_ns
+ */
+static void process_events(void)
+{
+    for (int i = 0; i < dev_count; i++) {
+        sim_dev_t *d = &devs[i];
+        if (!d->connected) {
+            continue;
+        }
+        if (d->pull_low && d->pull_end_ns <= now_ns) {
+            d->pull_low = false;
+            if (d->state == DEV_PRESENCE) {
+                d->state = DEV_ROM_CMD;
+                d->rx_bits = 0;
+            }
+        }
+        if (d->presence_start_ns <= now_ns) {
+            d->presence_start_ns = NEVER;
+            d->pull_low = true;
+            d->pull_end_ns = d->presence_end_ns;
+        }
+    }
+    line_update();
+
+    for (int i = 0; i < dev_count; i++) {
+        sim_dev_t *d = &devs[i];
+        if (d->connected && d->sample_ns <= now_ns) {
+            d->sample_ns = NEVER;
+            dev_receive(d, line_level());
+        }
+    }
+}
+
+void onewire_sim_init(const onewire_sim_config_t *config)
+{
+    cfg = *config;
+    dev_count = 0;
+    now_ns = 0;
+    master_low = false;
+    driven_prev = false;
+    release_ns = -us_to_ns(1000);
+    level_prev = true;
+    rng_state = cfg.seed ? cfg.seed : 1;
+    glitch_rng_state = rng_state ^ 0x9E3779B9u;
+    memset(&stats, 0, sizeof(stats));
+    glitch_schedule(0);
+}
+
+onewire_sim_config_t *onewire_sim_config(void)
+{
+    return &cfg;
+}
+
+void onewire_sim_make_rom(uint32_t serial, uint8_t rom[8])
+{
+    rom[0] = 0x28;
+    for (int i = 0; i < 6; i++) {
+        rom[1 + i] = (uint8_t)(i < 4 ? serial >> (8 * i) : 0);
+    }
+    rom[7] = sim_crc8(rom, 7);
+}
+
+int onewire_sim_add_ds18b20(const uint8_t rom[8], float temp_c)
+{
+    if (dev_count >= ONEWIRE_SIM_MAX_DEVICES) {
+        return -1;
+    }
+    sim_dev_t *d = &devs[dev_count];
+    memset(d, 0, sizeof(*d));
+    memcpy(d->rom, rom, 8);
+    d->connected = true;
+    d->raw = (int16_t)lroundf(temp_c * 16);
+    d->latched = 0x0550;
+    d->convert_done_ns = NEVER;
+    d->state = DEV_IDLE;
+    d->sample_ns = NEVER;
+    d->fall_ns = NEVER;
+    d->presence_start_ns = NEVER;
+    d->presence_end_ns = NEVER;
+    return dev_count++;
+}
+
+void onewire_sim_set_temperature(int dev, float temp_c)
+{
+    if (dev >= 0 && dev < dev_count) {
+        devs[dev].raw = (int16_t)lroundf(temp_c * 16);
+    }
+}
+
+void onewire_sim_set_connected(int dev, bool connected)
+{
+    if (dev >= 0 && dev < dev_count) {
+        devs[dev].connected = connected;
+        devs[dev].state = DEV_IDLE;
+        devs[dev].pull_low = false;
+        devs[dev].sample_ns = NEVER;
+        devs[dev].presence_start_ns = NEVER;
+        line_update();
+    }
+}
+
+int onewire_sim_device_count(void)
+{
+    return dev_count;
+}
+
+void onewire_sim_master_drive(bool low)
+{
+    master_low = low;
+    line_update();
+}
+
+bool onewire_sim_line_level(void)
+{
+    if (glitch_end_ns == NEVER && cfg.glitch_rate_per_ms > 0) {
+        glitch_schedule(now_ns);    // Rate enabled after init
+    }
+    while (glitch_end_ns <= now_ns) {
+        glitch_schedule(glitch_end_ns);
+    }
+    if (glitch_start_ns <= now_ns) {
+        stats.glitched_samples++;
+        return !line_level();
+    }
+    return line_level();
+}
+
+void onewire_sim_advance_ns(int64_t ns)
+{
+    int64_t target = now_ns + ns;
+
+    for (;;) {
+        int64_t next = next_event_ns();
+        if (next > target) {
+            break;
+        }
+        if (next > now_ns) {
+            now_ns = next;
+        }
+        process_events();
+        if (next_event_ns() <= now_ns) {
+            // Zero-length rise or coincident events: make progress
+            now_ns++;
+        }
+    }
+    now_ns = target;
+    line_update();
+}
+
+int64_t onewire_sim_now_ns(void)
+{
+    return now_ns;
+}
+
+void onewire_sim_get_stats(onewire_sim_stats_t *out)
+{
+    *out = stats;
+}
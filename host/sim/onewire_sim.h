@@ -0,0 +1,110 @@
+/**
+ * @file onewire_sim.h
+ * @brief Host simulator of a 1-Wire line with DS18B20 slaves
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Event-driven model in virtual time (ns resolution), driven by the IDF
+ * shim: gpio_set_level() drives the master side, gpio_get_level() samples
+ * the line, esp_rom_delay_us()/vTaskDelay() advance time. The real
+ * onewire_bus.c and ds18b20.c therefore run unmodified against it.
+ *
+ * Line: wired-AND of master and slaves. A released line reads high only
+ * rise_us after the last driver let go (cable RC + pull-up), which is what
+ * breaks fixed slot timing on long cables.
+ *
+ * Slave: DS18B20 state machine (SKIP/MATCH/SEARCH/READ ROM, CONVERT T,
+ * READ SCRATCHPAD). Sample point, '0' hold time and presence timing are
+ * drawn per slot from configurable ranges within the datasheet limits.
+ * A falling edge while the line has not yet risen is invisible to slaves.
+ *
+ * Noise: optional short glitches (Poisson arrivals) invert the level seen
+ * by the master's input only; slaves are not disturbed. This models EMI at
+ * the sampling pin, the case oversampled reads are meant to absorb.
+ */
+
+#ifndef ONEWIRE_SIM_H
+#define ONEWIRE_SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define ONEWIRE_SIM_MAX_DEVICES     32
+
+/**
+ * @brief Line and slave timing model (µs)
+ */
+typedef struct {
+    double rise_us;                 ///< Release until line reads high
+    double slave_sample_min_us;     ///< Write slot sample point after falling edge
+    double slave_sample_max_us;
+    double slave_hold_min_us;       ///< Read slot '0' hold after falling edge
+    double slave_hold_max_us;
+    double presence_wait_min_us;    ///< Rising edge to presence pulse
+    double presence_wait_max_us;
+    double presence_len_min_us;     ///< Presence pulse length
+    double presence_len_max_us;
+    double reset_detect_us;         ///< Low time recognized as reset by slaves
+    double conversion_ms;           ///< Temperature conversion time
+    double gpio_cost_us;            ///< Time consumed by one GPIO access
+    double glitch_rate_per_ms;      ///< Mean glitches per ms at the master input (0 = none)
+    double glitch_len_us;           ///< Glitch duration
+    uint32_t seed;                  ///< PRNG seed for per-slot timing draws
+} onewire_sim_config_t;
+
+#define ONEWIRE_SIM_CONFIG_DEFAULT() { \
+    .rise_us = 0.5, \
+    .slave_sample_min_us = 15, .slave_sample_max_us = 45, \
+    .slave_hold_min_us = 18, .slave_hold_max_us = 40, \
+    .presence_wait_min_us = 15, .presence_wait_max_us = 60, \
+    .presence_len_min_us = 60, .presence_len_max_us = 240, \
+    .reset_detect_us = 440, .conversion_ms = 750, \
+    .gpio_cost_us = 0.1, .glitch_rate_per_ms = 0, .glitch_len_us = 0.5, .seed = 1, \
+}
+
+/**
+ * @brief Simulator statistics
+ */
+typedef struct {
+    uint64_t falling_edges;         ///< Slot starts seen on the line
+    uint64_t resets;                ///< Reset pulses recognized by slaves
+    uint64_t slave_bits_rx;         ///< Bits sampled by slaves
+    uint64_t slave_bits_tx;         ///< Bits driven by slaves
+    uint64_t glitched_samples;      ///< Master samples inverted by a glitch
+} onewire_sim_stats_t;
+
+/**
+ * @brief Reset simulator: no slaves, time 0, line released and high
+ */
+void onewire_sim_init(const onewire_sim_config_t *config);
+
+/**
+ * @brief Current configuration (may be modified between transactions)
+ */
+onewire_sim_config_t *onewire_sim_config(void);
+
+/**
+ * @brief Build DS18B20 ROM code (family 0x28, serial, CRC)
+ */
+void onewire_sim_make_rom(uint32_t serial, uint8_t rom[8]);
+
+/**
+ * @brief Attach a DS18B20
+ * @return Device index, -1 if full
+ */
+int onewire_sim_add_ds18b20(const uint8_t rom[8], float temp_c);
+
+void onewire_sim_set_temperature(int dev, float temp_c);
+void onewire_sim_set_connected(int dev, bool connected);
+int onewire_sim_device_count(void);
+
+/* Hooks for the IDF shim */
+void onewire_sim_master_drive(bool low);
+bool onewire_sim_line_level(void);
+void onewire_sim_advance_ns(int64_t ns);
+int64_t onewire_sim_now_ns(void);
+
+void onewire_sim_get_stats(onewire_sim_stats_t *stats);
+
+#endif // ONEWIRE_SIM_H
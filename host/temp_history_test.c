@@ -0,0 +1,239 @@
+/**
+ * @file temp_history_test.c
+ * @brief Check the RAM history tiers (temp_history.c) against a brute-force reference
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Feeds two days and a few hours of samples to two sensors: first on an
+ * exact 5 s grid (samples land on the 1-minute and 15-minute boundaries),
+ * then jittered with gaps that skip whole buckets. Every sample is kept,
+ * and at checkpoints the tiers are compared with buckets recomputed from
+ * scratch (start = time - time % period, min/max, average rounded half
+ * away from zero):
+ * - Completed buckets newest first, up to the ring capacity, and the count
+ * - The bucket still being filled (temp_history_get_current)
+ * - The raw ring (last TEMP_HISTORY_RAW_LEN samples)
+ *
+ * Exits non-zero on the first mismatch (run by ctest).
+ */
+
+#include "temp_history.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TEST_SENSORS       2
+#define TEST_GRID_S        (26 * 3600)    // Exact 5 s grid
+#define TEST_JITTER_S      (26 * 3600)    // Jittered period with gaps
+#define TEST_MAX_SAMPLES   ((TEST_GRID_S + TEST_JITTER_S) / 2)
+#define TEST_CHECK_EVERY   997            // Samples between checkpoints (prime: drifts across boundaries)
+#define TEST_START_S       (7 * 900 - 20) // Starts 20 s before a 15-minute boundary
+
+typedef struct {
+    uint32_t time_s;
+    int16_t value;
+} ref_sample_t;
+
+static const uint32_t tier_period_s[TEMP_HISTORY_TIER_COUNT] = {60, 15 * 60};
+static const uint16_t tier_capacity[TEMP_HISTORY_TIER_COUNT] = {TEMP_HISTORY_1M_LEN, TEMP_HISTORY_15M_LEN};
+
+static ref_sample_t samples[TEST_SENSORS][TEST_MAX_SAMPLES];
+static size_t sample_count[TEST_SENSORS];
+static uint32_t rng_state = 12345;
+static unsigned checks;
+
+static uint32_t rng_next(void)
+{
+    rng_state = rng_state * 1103515245u + 12345u;
+    return rng_state >> 8;
+}
+
+/**
+ * @brief Brute-force aggregate of all samples in [start, start + period)
+ */
+static temp_history_agg_t ref_bucket(uint8_t sensor, uint32_t start, uint32_t period)
+{
+    temp_history_agg_t agg = {.start_s = start};
+    int32_t sum = 0;
+    size_t lo = 0;
+    size_t hi = sample_count[sensor];
+
+    while (lo < hi) {  // Samples are in time order: first one at or after start
+        size_t mid = (lo + hi) / 2;
+        if (samples[sensor][mid].time_s < start) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    for (size_t i = lo; i < sample_count[sensor] && samples[sensor][i].time_s < start + period; i++) {
+        const ref_sample_t *s = &samples[sensor][i];
+        if (agg.count == 0 || s->value < agg.min) {
+            agg.min = s->value;
+        }
+        if (agg.count == 0 || s->value > agg.max) {
+            agg.max = s->value;
+        }
+        sum += s->value;
+        agg.count++;
+    }
+    if (agg.count > 0) {
+        int32_t half = agg.count / 2;
+        agg.avg = (int16_t)((sum >= 0 ? sum + half : sum - half) / agg.count);
+    }
+    return agg;
+}
+
+static int agg_equal(const temp_history_agg_t *a, const temp_history_agg_t *b)
+{
+    return a->start_s == b->start_s && a->min == b->min && a->avg == b->avg && a->max == b->max &&
+           a->count == b->count;
+}
+
+static int report(uint8_t sensor, const char *what, unsigned index, const temp_history_agg_t *got,
+                  const temp_history_agg_t *want)
+{
+    fprintf(stderr, "FAIL sensor %u %s #%u: got start %u min %d avg %d max %d n %u, "
+            "want start %u min %d avg %d max %d n %u\n", sensor, what, index,
+            (unsigned)got->start_s, got->min, got->avg, got->max, got->count,
+            (unsigned)want->start_s, want->min, want->avg, want->max, want->count);
+    return 1;
+}
+
+/**
+ * @brief Compare one tier with the reference, walking buckets newest first
+ */
+static int check_tier(uint8_t sensor, temp_history_tier_t tier)
+{
+    uint32_t period = tier_period_s[tier];
+    const ref_sample_t *last = &samples[sensor][sample_count[sensor] - 1];
+    uint32_t first_bucket = samples[sensor][0].time_s - samples[sensor][0].time_s % period;
+    uint32_t bucket = last->time_s - last->time_s % period;
+    temp_history_agg_t got;
+    temp_history_agg_t want = ref_bucket(sensor, bucket, period);
+
+    if (!temp_history_get_current(sensor, tier, &got) || !agg_equal(&got, &want)) {
+        return report(sensor, tier == TEMP_HISTORY_TIER_1M ? "1m current" : "15m current", 0, &got, &want);
+    }
+
+    unsigned completed = 0;
+    while (bucket > first_bucket) {
+        bucket -= period;
+        want = ref_bucket(sensor, bucket, period);
+        if (want.count == 0) {
+            continue;  // Gap: no bucket is stored
+        }
+        if (completed < tier_capacity[tier]) {
+            if (!temp_history_get_agg(sensor, tier, (uint16_t)completed, &got) || !agg_equal(&got, &want)) {
+                return report(sensor, tier == TEMP_HISTORY_TIER_1M ? "1m age" : "15m age", completed, &got, &want);
+            }
+        }
+        completed++;
+    }
+
+    unsigned expected = completed < tier_capacity[tier] ? completed : tier_capacity[tier];
+    if (temp_history_agg_count(sensor, tier) != expected ||
+        temp_history_get_agg(sensor, tier, (uint16_t)expected, &got)) {
+        fprintf(stderr, "FAIL sensor %u tier %d: count %u, want %u\n", sensor, (int)tier,
+                (unsigned)temp_history_agg_count(sensor, tier), expected);
+        return 1;
+    }
+    return 0;
+}
+
+static int check_raw(uint8_t sensor)
+{
+    size_t n = sample_count[sensor];
+    unsigned expected = n < TEMP_HISTORY_RAW_LEN ? (unsigned)n : TEMP_HISTORY_RAW_LEN;
+    temp_history_sample_t got;
+
+    if (temp_history_raw_count(sensor) != expected) {
+        fprintf(stderr, "FAIL sensor %u raw count %u, want %u\n", sensor,
+                (unsigned)temp_history_raw_count(sensor), expected);
+        return 1;
+    }
+    for (unsigned age = 0; age < expected; age++) {
+        const ref_sample_t *want = &samples[sensor][n - 1 - age];
+        if (!temp_history_get_raw(sensor, (uint16_t)age, &got) || got.time_s != want->time_s ||
+            got.value != want->value) {
+            fprintf(stderr, "FAIL sensor %u raw age %u: got %u/%d, want %u/%d\n", sensor, age,
+                    (unsigned)got.time_s, got.value, (unsigned)want->time_s, want->value);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int check_all(void)
+{
+    for (uint8_t s = 0; s < TEST_SENSORS; s++) {
+        if (check_tier(s, TEMP_HISTORY_TIER_1M) || check_tier(s, TEMP_HISTORY_TIER_15M) || check_raw(s)) {
+            return 1;
+        }
+    }
+    checks++;
+    return 0;
+}
+
+/**
+ * @brief Store one sample in the history and the reference; checkpoint every TEST_CHECK_EVERY samples
+ */
+static int add(uint8_t sensor, uint32_t time_s, int16_t value)
+{
+    if (!temp_history_add(sensor, time_s, value)) {
+        fprintf(stderr, "FAIL sensor %u: sample at %u rejected\n", sensor, (unsigned)time_s);
+        return 1;
+    }
+    samples[sensor][sample_count[sensor]++] = (ref_sample_t){time_s, value};
+    if (sensor == TEST_SENSORS - 1 && sample_count[sensor] % TEST_CHECK_EVERY == 0) {
+        return check_all();
+    }
+    return 0;
+}
+
+/**
+ * @brief Random centidegree value around 0°C so averages round both ways
+ */
+static int16_t random_value(void)
+{
+    return (int16_t)((int32_t)(rng_next() % 6001) - 2500);
+}
+
+int main(void)
+{
+    temp_history_init();
+
+    uint32_t t = TEST_START_S;
+    for (; t < TEST_START_S + TEST_GRID_S; t += TEMP_HISTORY_SAMPLE_PERIOD_S) {
+        for (uint8_t s = 0; s < TEST_SENSORS; s++) {
+            if (add(s, t, random_value())) {
+                return 1;
+            }
+        }
+    }
+
+    while (t < TEST_START_S + TEST_GRID_S + TEST_JITTER_S) {
+        uint32_t r = rng_next();
+        if (r % 500 == 0) {
+            t += 60 + r % 1800;  // Gap: skips 1-minute and sometimes 15-minute buckets
+        } else {
+            t += 3 + r % 5;      // 3..7 s, a few samples share a second with the boundary
+        }
+        for (uint8_t s = 0; s < TEST_SENSORS; s++) {
+            if (add(s, t, random_value())) {
+                return 1;
+            }
+        }
+    }
+
+    if (check_all()) {
+        return 1;
+    }
+    if (temp_history_add(0, t - 1, 0)) {
+        fprintf(stderr, "FAIL out-of-order sample accepted\n");
+        return 1;
+    }
+
+    printf("temp_history: %zu samples per sensor, %u checkpoints OK\n", sample_count[0], checks);
+    return 0;
+}
@@ -0,0 +1,149 @@
+/**
+ * @file tlog_bench.c
+ * @brief Host benchmark of the flash log format (tlog_format.c)
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Feeds a synthetic week of DS18B20-like readings (random walk in 1/16°C
+ * steps, occasional failed reads) through the block encoder, exactly like
+ * tlog.c does on the target, and reports:
+ * - Records per 256-byte flash page and encoded bytes per record
+ * - Write amplification (bytes programmed / raw record bytes)
+ * - Flash program and erase operations per day, partition retention
+ *
+ * Every sealed block is decoded again and compared with the input, so the
+ * benchmark also verifies the encoder/decoder round trip.
+ */
+
+#include "tlog_format.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_SAMPLE_PERIOD_S  5
+#define BENCH_DURATION_S       (7 * 24 * 3600)
+#define BENCH_FLUSH_INTERVAL_S (15 * 60)          // Same as TLOG_FLUSH_INTERVAL_S
+#define BENCH_SECTOR_SIZE      4096
+#define BENCH_PARTITION_SIZE   0x40000            // Same as partitions.csv
+#define BENCH_MAX_RECORDS      (BENCH_DURATION_S / BENCH_SAMPLE_PERIOD_S)
+
+typedef struct {
+    uint32_t records;
+    uint32_t blocks;
+    uint32_t payload_bytes;
+    uint32_t mismatches;
+} bench_result_t;
+
+static tlog_record_t pending[UINT8_MAX];
+static uint32_t pending_count;
+
+/**
+ * @brief Seal block, decode it back and compare with the records fed in
+ */
+static void bench_seal(tlog_block_encoder_t *enc, bench_result_t *res)
+{
+    const uint8_t *block = tlog_block_seal(enc);
+    tlog_block_decoder_t dec;
+    tlog_record_t rec;
+    uint32_t i = 0;
+
+    if (!tlog_block_decoder_init(&dec, block)) {
+        res->mismatches += pending_count;
+    } else {
+        while (tlog_block_decoder_next(&dec, &rec)) {
+            if (i >= pending_count || rec.time_s != pending[i].time_s ||
+                memcmp(rec.values, pending[i].values, enc->sensor_count * sizeof(int16_t)) != 0) {
+                res->mismatches++;
+            }
+            i++;
+        }
+        if (i != pending_count) {
+            res->mismatches++;
+        }
+    }
+
+    res->blocks++;
+    res->payload_bytes += enc->len - TLOG_BLOCK_HEADER_SIZE;
+    pending_count = 0;
+    tlog_block_begin(enc, enc->seq + 1, enc->sensor_count);
+}
+
+static void bench_run(uint8_t sensor_count, bench_result_t *res)
+{
+    tlog_block_encoder_t enc;
+    int16_t raw16[TLOG_MAX_SENSORS];
+    uint32_t block_start_s = 0;
+
+    memset(res, 0, sizeof(*res));
+    pending_count = 0;
+    srand(1234u + sensor_count);
+    for (uint8_t s = 0; s < sensor_count; s++) {
+        raw16[s] = (int16_t)(16 * (18 + 3 * s));   // Start at 18°C, 21°C, ...
+    }
+
+    tlog_block_begin(&enc, 0, sensor_count);
+
+    for (uint32_t t = 0; t < BENCH_DURATION_S; t += BENCH_SAMPLE_PERIOD_S) {
+        tlog_record_t rec = { .time_s = t, .sensor_count = sensor_count };
+        for (uint8_t s = 0; s < sensor_count; s++) {
+            int r = rand() % 100;
+            raw16[s] += (r < 15) ? -1 : (r >= 85) ? 1 : 0;
+            // Same conversion as firmware: raw / 16.0f, then centidegrees truncated
+            rec.values[s] = (rand() % 1000 == 0) ? TLOG_VALUE_INVALID : (int16_t)((raw16[s] / 16.0f) * 100);
+        }
+
+        if (enc.count > 0 && t - block_start_s >= BENCH_FLUSH_INTERVAL_S) {
+            bench_seal(&enc, res);
+        }
+        if (!tlog_block_append(&enc, &rec)) {
+            bench_seal(&enc, res);
+            tlog_block_append(&enc, &rec);
+        }
+        if (pending_count == 0) {
+            block_start_s = t;
+        }
+        pending[pending_count++] = rec;
+        res->records++;
+    }
+
+    if (enc.count > 0) {
+        bench_seal(&enc, res);
+    }
+}
+
+int main(void)
+{
+    const uint8_t scenarios[] = {1, 2, 4, 8};
+    const double days = BENCH_DURATION_S / 86400.0;
+    const uint32_t sectors = BENCH_PARTITION_SIZE / BENCH_SECTOR_SIZE;
+    const uint32_t blocks_total = BENCH_PARTITION_SIZE / TLOG_BLOCK_SIZE;
+    int failures = 0;
+
+    printf("tlog format benchmark: %u s sample period, %.0f days, %u KB partition (%u sectors)\n\n",
+           BENCH_SAMPLE_PERIOD_S, days, BENCH_PARTITION_SIZE / 1024, (unsigned)sectors);
+    printf("sensors  rec/page  B/rec  raw B/rec  WA(raw)  pages/day  erases/day  retention(d)  endurance(y)  roundtrip\n");
+
+    for (size_t i = 0; i < sizeof(scenarios); i++) {
+        bench_result_t res;
+        bench_run(scenarios[i], &res);
+
+        double raw_per_rec = 4.0 + 2.0 * scenarios[i];
+        double rec_per_page = (double)res.records / res.blocks;
+        double bytes_per_rec = (double)res.payload_bytes / res.records;
+        double wa = ((double)res.blocks * TLOG_BLOCK_SIZE) / (res.records * raw_per_rec);
+        double pages_per_day = res.blocks / days;
+        double erases_per_day = pages_per_day / (BENCH_SECTOR_SIZE / TLOG_BLOCK_SIZE);
+        double retention_days = blocks_total / pages_per_day;
+        double endurance_years = 100000.0 * sectors / erases_per_day / 365.0;
+
+        printf("%7u  %8.1f  %5.2f  %9.0f  %7.2f  %9.1f  %10.2f  %12.1f  %12.0f  %s\n",
+               scenarios[i], rec_per_page, bytes_per_rec, raw_per_rec, wa, pages_per_day,
+               erases_per_day, retention_days, endurance_years, res.mismatches ? "FAIL" : "ok");
+        failures += res.mismatches ? 1 : 0;
+    }
+
+    printf("\nWA(raw) < 1 means the log programs fewer bytes than an uncompressed\n"
+           "record stream; an unbatched writer needs one program operation per record.\n");
+    return failures ? 1 : 0;
+}
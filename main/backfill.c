@@ -0,0 +1,143 @@
+/**
+ * @file backfill.c
+ * @brief Queue of readings taken while offline, drained after rejoin
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Fixed ring of report_frame_sample_t shared by the sensor task (producer)
+ * and the Zigbee task (consumer). Accesses are short copies guarded by a
+ * spinlock critical section; frame encoding runs on a private snapshot.
+ */
+
+#include "backfill.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <string.h>
+
+#define BACKFILL_FRAME_MAX_SAMPLES  ((REPORT_FRAME_MAX_LEN - 8) / (1 + REPORT_FRAME_MAX_SENSORS))
+
+static portMUX_TYPE backfill_lock = portMUX_INITIALIZER_UNLOCKED;
+static report_frame_sample_t backfill_queue[BACKFILL_QUEUE_LEN];
+static size_t backfill_head;                   ///< Oldest sample
+static size_t backfill_count;
+static uint8_t backfill_sensor_count = 1;
+static uint32_t backfill_drop_count;
+static size_t backfill_in_flight;              ///< Samples encoded by last frame
+static uint8_t backfill_seq;
+static uint32_t backfill_acked_s;              ///< Delivered up to here, nothing older queued
+static uint32_t backfill_live_s;               ///< Newest sample taken while online
+
+void backfill_init(void)
+{
+    portENTER_CRITICAL(&backfill_lock);
+    backfill_head = 0;
+    backfill_count = 0;
+    backfill_in_flight = 0;
+    backfill_drop_count = 0;
+    backfill_acked_s = 0;
+    backfill_live_s = 0;
+    portEXIT_CRITICAL(&backfill_lock);
+}
+
+void backfill_push(uint32_t time_s, const int16_t *values, uint8_t sensor_count)
+{
+    report_frame_sample_t sample = { .time_s = time_s };
+    for (uint8_t i = 0; i < REPORT_FRAME_MAX_SENSORS; i++) {
+        sample.values[i] = i < sensor_count ? values[i] : REPORT_FRAME_VALUE_INVALID;
+    }
+
+    portENTER_CRITICAL(&backfill_lock);
+    if (backfill_count == BACKFILL_QUEUE_LEN) {
+        // Drop oldest; an in-flight frame then covers one sample less
+        backfill_head = (backfill_head + 1) % BACKFILL_QUEUE_LEN;
+        backfill_count--;
+        backfill_drop_count++;
+        if (backfill_in_flight > 0) {
+            backfill_in_flight--;
+        }
+    }
+    backfill_queue[(backfill_head + backfill_count) % BACKFILL_QUEUE_LEN] = sample;
+    backfill_count++;
+    if (sensor_count > backfill_sensor_count) {
+        backfill_sensor_count = sensor_count > REPORT_FRAME_MAX_SENSORS ? REPORT_FRAME_MAX_SENSORS : sensor_count;
+    }
+    portEXIT_CRITICAL(&backfill_lock);
+}
+
+void backfill_skip(uint32_t time_s)
+{
+    portENTER_CRITICAL(&backfill_lock);
+    backfill_live_s = time_s;
+    if (backfill_count == 0) {
+        backfill_acked_s = time_s;
+    }
+    portEXIT_CRITICAL(&backfill_lock);
+}
+
+uint32_t backfill_acked_until(void)
+{
+    portENTER_CRITICAL(&backfill_lock);
+    uint32_t acked = backfill_acked_s;
+    portEXIT_CRITICAL(&backfill_lock);
+    return acked;
+}
+
+size_t backfill_pending(void)
+{
+    portENTER_CRITICAL(&backfill_lock);
+    size_t count = backfill_count;
+    portEXIT_CRITICAL(&backfill_lock);
+    return count;
+}
+
+uint32_t backfill_dropped(void)
+{
+    return backfill_drop_count;
+}
+
+size_t backfill_ram_bytes(void)
+{
+    return sizeof(backfill_queue);
+}
+
+size_t backfill_build_frame(uint8_t *buf, size_t buf_len, uint32_t now_s)
+{
+    report_frame_sample_t snapshot[BACKFILL_FRAME_MAX_SAMPLES];
+    size_t n;
+    uint8_t sensor_count;
+
+    portENTER_CRITICAL(&backfill_lock);
+    n = backfill_count < BACKFILL_FRAME_MAX_SAMPLES ? backfill_count : BACKFILL_FRAME_MAX_SAMPLES;
+    for (size_t i = 0; i < n; i++) {
+        snapshot[i] = backfill_queue[(backfill_head + i) % BACKFILL_QUEUE_LEN];
+    }
+    sensor_count = backfill_sensor_count;
+    portEXIT_CRITICAL(&backfill_lock);
+
+    size_t encoded = 0;
+    size_t len = report_frame_encode_history(buf, buf_len, backfill_seq, snapshot, n, sensor_count, now_s, &encoded);
+
+    portENTER_CRITICAL(&backfill_lock);
+    backfill_in_flight = encoded;
+    portEXIT_CRITICAL(&backfill_lock);
+    return len;
+}
+
+void backfill_commit(void)
+{
+    portENTER_CRITICAL(&backfill_lock);
+    size_t n = backfill_in_flight < backfill_count ? backfill_in_flight : backfill_count;
+    if (n > 0) {
+        backfill_acked_s = backfill_queue[(backfill_head + n - 1) % BACKFILL_QUEUE_LEN].time_s;
+    }
+    backfill_head = (backfill_head + n) % BACKFILL_QUEUE_LEN;
+    backfill_count -= n;
+    backfill_in_flight = 0;
+    if (backfill_count == 0 && backfill_live_s > backfill_acked_s) {
+        // Samples taken online while the queue drained need no backfill either
+        backfill_acked_s = backfill_live_s;
+    }
+    portEXIT_CRITICAL(&backfill_lock);
+    backfill_seq++;
+}
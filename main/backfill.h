@@ -0,0 +1,88 @@
+/**
+ * @file backfill.h
+ * @brief Queue of readings taken while offline, drained after rejoin
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * The sensor task pushes one sample per cycle while the device is not
+ * joined. After rejoin the Zigbee task drains the queue in history batch
+ * frames (report_frame.h), one frame per BACKFILL_FRAME_INTERVAL_MS.
+ * When the queue is full the oldest sample is dropped and counted.
+ *
+ * backfill_acked_until() is the delivery watermark: every sample up to that
+ * log time was sent in a batch or taken while online. The firmware keeps it in NVS and
+ * re-queues newer flash log records after a reboot, so the queue survives
+ * a power loss (up to the last flushed log block).
+ */
+
+#ifndef BACKFILL_H
+#define BACKFILL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "report_frame.h"
+
+#define BACKFILL_QUEUE_LEN          720     ///< 1 hour at 5 s sample period (8 bytes each)
+#define BACKFILL_FRAME_INTERVAL_MS  2000    ///< Throttle: at most one batch frame per interval
+
+/**
+ * @brief Clear queue
+ */
+void backfill_init(void);
+
+/**
+ * @brief Queue one offline sample (producer: sensor task)
+ * @param time_s Device log time
+ * @param values Centidegrees per sensor (REPORT_FRAME_VALUE_INVALID for failed reads)
+ * @param sensor_count Number of values
+ */
+void backfill_push(uint32_t time_s, const int16_t *values, uint8_t sensor_count);
+
+/**
+ * @brief Note a sample taken while online, which needs no backfill (producer: sensor task)
+ * @param time_s Device log time of the sample
+ */
+void backfill_skip(uint32_t time_s);
+
+/**
+ * @brief Delivery watermark: log time up to which every sample was delivered
+ *
+ * Advances with backfill_commit() to the newest sent sample, and with
+ * backfill_skip() while nothing older is queued. 0 until the first delivery.
+ */
+uint32_t backfill_acked_until(void);
+
+/**
+ * @brief Number of queued samples
+ */
+size_t backfill_pending(void);
+
+/**
+ * @brief Number of samples dropped because the queue was full
+ */
+uint32_t backfill_dropped(void);
+
+/**
+ * @brief Static RAM of the sample queue
+ */
+size_t backfill_ram_bytes(void);
+
+/**
+ * @brief Encode oldest queued samples into one history batch frame
+ *
+ * Samples stay queued until backfill_commit() so a failed send can be retried.
+ *
+ * @param buf Output buffer (REPORT_FRAME_MAX_LEN bytes)
+ * @param buf_len Buffer size
+ * @param now_s Current device log time
+ * @return Frame length, 0 if queue is empty
+ */
+size_t backfill_build_frame(uint8_t *buf, size_t buf_len, uint32_t now_s);
+
+/**
+ * @brief Remove samples encoded by the last backfill_build_frame() call
+ */
+void backfill_commit(void);
+
+#endif // BACKFILL_H
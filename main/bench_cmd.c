@@ -0,0 +1,328 @@
+/**
+ * @file bench_cmd.c
+ * @brief Benchmark and diagnostics commands for the 1-Wire sensor bus
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Target-independent: besides the drivers it needs only esp_timer and
+ * cpu_account, which the host shim provides. Histograms use log2 buckets
+ * so one bucket array covers a 100 µs bus transaction and a 750 ms
+ * conversion alike.
+ */
+
+#include "bench_cmd.h"
+#include "cpu_account.h"
+#include "esp_timer.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_CMD_DEFAULT_CYCLES 10
+
+/**
+ * @brief Log2 histogram of durations
+ */
+typedef struct {
+    uint32_t buckets[BENCH_CMD_HIST_BUCKETS];
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t sum_us;
+} bench_hist_t;
+
+/**
+ * @brief Results of one sensor in one read command
+ */
+typedef struct {
+    uint32_t ok;
+    uint32_t failed;
+    float min_c;
+    float max_c;
+    double sum_c;
+    uint64_t read_us;
+    uint32_t read_max_us;
+    uint64_t bus_us;
+} bench_result_t;
+
+static bench_cmd_ctx_t ctx;
+static bench_hist_t hist_read;      ///< Wall time per read (conversion included)
+static bench_hist_t hist_bus;       ///< Bus hold time per read
+
+static void hist_reset(bench_hist_t *h)
+{
+    memset(h, 0, sizeof(*h));
+    h->min_us = UINT32_MAX;
+}
+
+static void hist_add(bench_hist_t *h, uint32_t us)
+{
+    uint8_t bucket = 0;
+    while (bucket < BENCH_CMD_HIST_BUCKETS - 1 && (us >> (bucket + 1)) != 0) {
+        bucket++;
+    }
+    h->buckets[bucket]++;
+    h->count++;
+    h->sum_us += us;
+    if (us < h->min_us) {
+        h->min_us = us;
+    }
+    if (us > h->max_us) {
+        h->max_us = us;
+    }
+}
+
+static void hist_print(const char *name, const bench_hist_t *h)
+{
+    if (h->count == 0) {
+        printf("%s: no samples\n", name);
+        return;
+    }
+    printf("%s: %u samples, min %uus, avg %uus, max %uus\n", name, (unsigned)h->count,
+           (unsigned)h->min_us, (unsigned)(h->sum_us / h->count), (unsigned)h->max_us);
+
+    uint32_t peak = 0;
+    for (int k = 0; k < BENCH_CMD_HIST_BUCKETS; k++) {
+        if (h->buckets[k] > peak) {
+            peak = h->buckets[k];
+        }
+    }
+    for (int k = 0; k < BENCH_CMD_HIST_BUCKETS; k++) {
+        if (h->buckets[k] == 0) {
+            continue;
+        }
+        char bar[33];
+        int len = (int)((uint64_t)h->buckets[k] * 32 / peak);
+        memset(bar, '#', len);
+        bar[len] = '\0';
+        printf("  %9lu..%-9lu us %6u %s\n", 1UL << k, (2UL << k) - 1, (unsigned)h->buckets[k], bar);
+    }
+}
+
+static bool parse_uint(const char *s, unsigned long max, unsigned long *out)
+{
+    char *end;
+    unsigned long v = strtoul(s, &end, 10);
+    if (*s == '\0' || *end != '\0' || v > max) {
+        return false;
+    }
+    *out = v;
+    return true;
+}
+
+static uint8_t slot_count(void)
+{
+    return ctx.sensor_count ? ctx.sensor_count() : 0;
+}
+
+static int cmd_devices(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    uint8_t count = slot_count();
+
+    printf("%u slot(s), %u sample(s) per read slot\n", count, ctx.bus ? ctx.bus->read_samples : 0);
+    for (uint8_t i = 0; i < count; i++) {
+        ds18b20_device_t dev;
+        if (!ctx.sensor_get(i, &dev)) {
+            printf("  %u: absent\n", i + 1);
+            continue;
+        }
+        const ds18b20_stats_t *st = &dev.stats;
+        printf("  %u: %02X%02X%02X%02X%02X%02X%02X%02X%s crc %u, presence %u, retries %u, timeouts %u, last conversion %ums\n",
+               i + 1, dev.rom[0], dev.rom[1], dev.rom[2], dev.rom[3], dev.rom[4], dev.rom[5], dev.rom[6],
+               dev.rom[7], dev.use_skip_rom ? " (skip ROM)" : "", (unsigned)st->crc_errors,
+               (unsigned)st->presence_failures, (unsigned)st->retries, (unsigned)st->bus_timeouts,
+               (unsigned)st->last_conversion_ms);
+    }
+    return 0;
+}
+
+/**
+ * @brief Read samples a benchmark run will use (computed on a copy, the bus is not touched)
+ * @param samples Requested samples, 0 = bus setting
+ * @return Samples in effect
+ */
+static uint8_t read_samples_in_effect(uint8_t samples)
+{
+#if ONEWIRE_FIXED_TIMING
+    (void)samples;
+    return 1;
+#else
+    onewire_timing_t timing = ctx.bus->timing;
+    return onewire_timing_set_read_samples(&timing, samples ? samples : ctx.bus->read_samples);
+#endif
+}
+
+static void bench_sensor(const ds18b20_device_t *src, uint32_t cycles, uint8_t samples, bench_result_t *res)
+{
+    ds18b20_device_t dev = *src;     // Counters below belong to this run only
+
+    dev.read_samples = samples;      // Applied per scratchpad read, the bus setting stays untouched
+    memset(&dev.stats, 0, sizeof(dev.stats));
+    memset(res, 0, sizeof(*res));
+    res->min_c = INFINITY;
+    res->max_c = -INFINITY;
+
+    for (uint32_t n = 0; n < cycles; n++) {
+        cpu_account_stats_t before, after;
+        float value;
+
+        cpu_account_get(NULL, &before);
+        int64_t start = esp_timer_get_time();
+        esp_err_t ret = ds18b20_get_temperature(&dev, ONEWIRE_BUS_PRIO_BACKGROUND, &value);
+        uint32_t read_us = (uint32_t)(esp_timer_get_time() - start);
+        cpu_account_get(NULL, &after);
+        uint32_t bus_us = (uint32_t)(after.total_us[CPU_ACCOUNT_BUSY_WAIT] - before.total_us[CPU_ACCOUNT_BUSY_WAIT]);
+
+        hist_add(&hist_read, read_us);
+        hist_add(&hist_bus, bus_us);
+        res->read_us += read_us;
+        res->bus_us += bus_us;
+        if (read_us > res->read_max_us) {
+            res->read_max_us = read_us;
+        }
+
+        if (ret != ESP_OK) {
+            res->failed++;
+            continue;
+        }
+        res->ok++;
+        res->sum_c += value;
+        res->min_c = fminf(res->min_c, value);
+        res->max_c = fmaxf(res->max_c, value);
+    }
+
+    printf("  %u ok, %u failed (crc %u, presence %u, retries %u, timeouts %u)\n",
+           (unsigned)res->ok, (unsigned)res->failed, (unsigned)dev.stats.crc_errors,
+           (unsigned)dev.stats.presence_failures, (unsigned)dev.stats.retries, (unsigned)dev.stats.bus_timeouts);
+    if (res->ok) {
+        printf("  temperature min %.2f, avg %.2f, max %.2f C\n", res->min_c, res->sum_c / res->ok, res->max_c);
+    }
+    printf("  read avg %.1fms, max %.1fms; bus %uus per read\n", res->read_us / 1000.0 / cycles,
+           res->read_max_us / 1000.0, (unsigned)(res->bus_us / cycles));
+}
+
+static int cmd_read(int argc, char **argv)
+{
+    unsigned long sensor = 0;
+    unsigned long cycles = BENCH_CMD_DEFAULT_CYCLES;
+    unsigned long samples = 0;
+    uint8_t count = slot_count();
+
+    if (argc < 2 || argc > 4) {
+        printf("usage: read <sensor|all> [cycles] [samples]\n");
+        return 1;
+    }
+    if (strcmp(argv[1], "all") != 0 && (!parse_uint(argv[1], count, &sensor) || sensor == 0)) {
+        printf("sensor must be 1..%u or 'all'\n", count);
+        return 1;
+    }
+    if (argc > 2 && (!parse_uint(argv[2], BENCH_CMD_MAX_CYCLES, &cycles) || cycles == 0)) {
+        printf("cycles must be 1..%u\n", BENCH_CMD_MAX_CYCLES);
+        return 1;
+    }
+    if (argc > 3 && (!parse_uint(argv[3], ONEWIRE_TIMING_MAX_SAMPLES, &samples) || samples == 0)) {
+        printf("samples must be 1..%u\n", ONEWIRE_TIMING_MAX_SAMPLES);
+        return 1;
+    }
+
+    uint8_t in_effect = read_samples_in_effect((uint8_t)samples);
+    uint8_t first = sensor ? (uint8_t)(sensor - 1) : 0;
+    uint8_t last = sensor ? (uint8_t)sensor : count;
+    int rc = 0;
+
+    for (uint8_t i = first; i < last; i++) {
+        ds18b20_device_t dev;
+        printf("sensor %u, %lu cycle(s), %u sample(s) per read slot:\n", i + 1, cycles, in_effect);
+        if (!ctx.sensor_get(i, &dev)) {
+            printf("  absent\n");
+            rc = 1;
+            continue;
+        }
+        bench_result_t res;
+        bench_sensor(&dev, (uint32_t)cycles, (uint8_t)samples, &res);
+        rc |= res.failed != 0;
+    }
+    return rc;
+}
+
+static int cmd_hist(int argc, char **argv)
+{
+    if (argc > 1) {
+        if (strcmp(argv[1], "reset") != 0) {
+            printf("usage: hist [reset]\n");
+            return 1;
+        }
+        hist_reset(&hist_read);
+        hist_reset(&hist_bus);
+        return 0;
+    }
+
+    hist_print("read time", &hist_read);
+    hist_print("bus time", &hist_bus);
+
+    onewire_bus_stats_t bus_stats;
+    onewire_bus_get_stats(ctx.bus, &bus_stats);
+    for (int p = 0; p < ONEWIRE_BUS_PRIO_COUNT; p++) {
+        printf("bus prio %d: %u acquisitions, %u timeouts, max wait %uus\n", p,
+               (unsigned)bus_stats.acquisitions[p], (unsigned)bus_stats.timeouts[p],
+               (unsigned)bus_stats.max_wait_us[p]);
+    }
+
+    onewire_bus_line_stats_t line;
+    onewire_bus_get_line_stats(ctx.bus, &line);
+    printf("bus line: %u read slots, %u noisy, %u outvoted samples\n",
+           (unsigned)line.read_bits, (unsigned)line.noisy_bits, (unsigned)line.minority_samples);
+
+    cpu_account_stats_t cpu;
+    cpu_account_get_total(&cpu);
+    printf("cpu: busy-wait %llums (%u holds, max %uus), suspended %llums (max %uus)\n",
+           (unsigned long long)(cpu.total_us[CPU_ACCOUNT_BUSY_WAIT] / 1000), (unsigned)cpu.count[CPU_ACCOUNT_BUSY_WAIT],
+           (unsigned)cpu.max_us[CPU_ACCOUNT_BUSY_WAIT],
+           (unsigned long long)(cpu.total_us[CPU_ACCOUNT_SUSPENDED] / 1000), (unsigned)cpu.max_us[CPU_ACCOUNT_SUSPENDED]);
+    return 0;
+}
+
+static int cmd_rescan(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    if (!ctx.rescan) {
+        printf("rescan not available\n");
+        return 1;
+    }
+    ctx.rescan();
+    printf("rescan requested\n");
+    return 0;
+}
+
+const bench_cmd_t bench_cmd_table[] = {
+    {"devices", "List sensor slots, ROM codes and error counters", NULL, cmd_devices},
+    {"read", "Run timed temperature reads and print per-sensor results", "<sensor|all> [cycles] [samples]", cmd_read},
+    {"hist", "Print read/bus time histograms and bus counters", "[reset]", cmd_hist},
+    {"rescan", "Search the bus for added or removed sensors", NULL, cmd_rescan},
+};
+const size_t bench_cmd_count = sizeof(bench_cmd_table) / sizeof(bench_cmd_table[0]);
+
+void bench_cmd_init(const bench_cmd_ctx_t *hooks)
+{
+    ctx = *hooks;
+    hist_reset(&hist_read);
+    hist_reset(&hist_bus);
+}
+
+int bench_cmd_run(int argc, char **argv)
+{
+    if (argc < 1) {
+        return 0;
+    }
+    for (size_t i = 0; i < bench_cmd_count; i++) {
+        if (strcmp(argv[0], bench_cmd_table[i].command) == 0) {
+            return bench_cmd_table[i].func(argc, argv);
+        }
+    }
+    printf("unknown command '%s'\n", argv[0]);
+    return 1;
+}
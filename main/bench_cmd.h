@@ -0,0 +1,77 @@
+/**
+ * @file bench_cmd.h
+ * @brief Benchmark and diagnostics commands for the 1-Wire sensor bus
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Command handlers with the esp_console signature (int argc, char **argv),
+ * printing to stdout. They use only the onewire_bus / ds18b20 driver APIs
+ * and reach the application's sensor slots through bench_cmd_ctx_t, so the
+ * same table is registered with the esp_console REPL on the device and
+ * dispatched by host/bench_console against the simulated bus.
+ *
+ * Commands:
+ * - devices                         list sensor slots, ROM and error counters
+ * - read <sensor|all> [cycles] [samples]
+ *                                   timed temperature reads (samples = read
+ *                                   slot oversampling of the benchmark reads
+ *                                   only, the periodic reads keep theirs)
+ * - hist [reset]                    read/bus time histograms, arbitration and
+ *                                   line quality counters
+ * - rescan                          request a full search for sensors
+ *
+ * Benchmark reads run at ONEWIRE_BUS_PRIO_BACKGROUND on a copy of the
+ * device handle, so the periodic cycle keeps priority and the per-sensor
+ * error counters keep a single writer.
+ */
+
+#ifndef BENCH_CMD_H
+#define BENCH_CMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "onewire_bus.h"
+#include "ds18b20.h"
+
+#define BENCH_CMD_HIST_BUCKETS  24      ///< Log2 buckets: [2^k, 2^(k+1)) µs, up to ~16 s
+#define BENCH_CMD_MAX_CYCLES    1000    ///< Upper bound for one read command
+
+/**
+ * @brief Application hooks (set once before the first command)
+ */
+typedef struct {
+    onewire_bus_handle_t *bus;                          ///< Sensor bus
+    uint8_t (*sensor_count)(void);                      ///< Populated slots (0..count-1)
+    bool (*sensor_get)(uint8_t slot, ds18b20_device_t *dev); ///< Copy of the slot's handle, false if empty or absent
+    void (*rescan)(void);                               ///< Request full search (may complete later)
+} bench_cmd_ctx_t;
+
+/**
+ * @brief Command descriptor (fields match esp_console_cmd_t)
+ */
+typedef struct {
+    const char *command;                ///< Command name
+    const char *help;                   ///< One-line description
+    const char *hint;                   ///< Argument synopsis
+    int (*func)(int argc, char **argv); ///< Handler, returns 0 on success
+} bench_cmd_t;
+
+extern const bench_cmd_t bench_cmd_table[];
+extern const size_t bench_cmd_count;
+
+/**
+ * @brief Set application hooks and clear histograms
+ * @param ctx Hooks (copied)
+ */
+void bench_cmd_init(const bench_cmd_ctx_t *ctx);
+
+/**
+ * @brief Dispatch one command line already split into arguments
+ * @param argc Argument count (argv[0] is the command)
+ * @param argv Arguments
+ * @return Handler result, 1 for an unknown command
+ */
+int bench_cmd_run(int argc, char **argv);
+
+#endif // BENCH_CMD_H
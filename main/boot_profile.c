@@ -0,0 +1,63 @@
+/**
+ * @file boot_profile.c
+ * @brief Boot phase timestamps (power-up to first report)
+ * @version 1.2.0
+ * @date 2026-10-18
+ */
+
+#include "boot_profile.h"
+#include <stdio.h>
+
+static volatile uint32_t stamps[BOOT_PHASE_COUNT];    ///< Time + 1 ms, 0 = not reached (no init needed)
+
+static const char *const phase_names[BOOT_PHASE_COUNT] = {
+    [BOOT_PHASE_APP_START] = "app",
+    [BOOT_PHASE_NVS_READY] = "nvs",
+    [BOOT_PHASE_ZB_STARTED] = "zigbee",
+    [BOOT_PHASE_BUS_READY] = "bus",
+    [BOOT_PHASE_SENSORS_FOUND] = "sensors",
+    [BOOT_PHASE_FIRST_READING] = "reading",
+    [BOOT_PHASE_NETWORK_UP] = "network",
+    [BOOT_PHASE_FIRST_REPORT] = "report",
+};
+
+bool boot_profile_mark(boot_phase_t phase, uint32_t now_ms)
+{
+    if (phase >= BOOT_PHASE_COUNT || stamps[phase] != 0) {
+        return false;
+    }
+    stamps[phase] = (now_ms & INT32_MAX) + 1;
+    return true;
+}
+
+int32_t boot_profile_get(boot_phase_t phase)
+{
+    return phase < BOOT_PHASE_COUNT ? (int32_t)stamps[phase] - 1 : -1;
+}
+
+const char *boot_profile_phase_name(boot_phase_t phase)
+{
+    return phase < BOOT_PHASE_COUNT ? phase_names[phase] : "?";
+}
+
+size_t boot_profile_format(char *buf, size_t len)
+{
+    size_t pos = 0;
+
+    if (len == 0) {
+        return 0;
+    }
+    buf[0] = '\0';
+    for (int i = 0; i < BOOT_PHASE_COUNT && pos < len; i++) {
+        int32_t t = boot_profile_get((boot_phase_t)i);
+        if (t < 0) {
+            continue;
+        }
+        int n = snprintf(buf + pos, len - pos, "%s%s %ldms", pos ? ", " : "", phase_names[i], (long)t);
+        if (n < 0) {
+            break;
+        }
+        pos += (size_t)n;
+    }
+    return pos < len ? pos : len - 1;
+}
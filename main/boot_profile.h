@@ -0,0 +1,65 @@
+/**
+ * @file boot_profile.h
+ * @brief Boot phase timestamps (power-up to first report)
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Each startup milestone is stamped once with a caller-supplied time since
+ * power-up, so the path to the first temperature report can be compared
+ * between builds. Every phase has a single writer (app_main, Zigbee task or
+ * sensor task); stamps are 32-bit and readable from any task. Static
+ * storage needs no init, so app_main can stamp before anything else. Pure logic.
+ */
+
+#ifndef BOOT_PROFILE_H
+#define BOOT_PROFILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Startup milestones, in their usual order
+ */
+typedef enum {
+    BOOT_PHASE_APP_START = 0,       ///< app_main entered (after bootloader and IDF startup)
+    BOOT_PHASE_NVS_READY,           ///< RF switch set, NVS mounted, persistent state loaded
+    BOOT_PHASE_ZB_STARTED,          ///< esp_zb_start returned (radio up, commissioning running)
+    BOOT_PHASE_BUS_READY,           ///< 1-Wire bus calibrated and a presence pulse seen
+    BOOT_PHASE_SENSORS_FOUND,       ///< ROM search finished
+    BOOT_PHASE_FIRST_READING,       ///< First successful temperature conversion
+    BOOT_PHASE_NETWORK_UP,          ///< Rejoined or joined a network
+    BOOT_PHASE_FIRST_REPORT,        ///< First temperature report accepted by the stack
+    BOOT_PHASE_COUNT
+} boot_phase_t;
+
+/**
+ * @brief Stamp a phase (first call only)
+ * @param phase Milestone
+ * @param now_ms Time since power-up
+ * @return true if this call recorded the phase
+ */
+bool boot_profile_mark(boot_phase_t phase, uint32_t now_ms);
+
+/**
+ * @brief Get stamp of a phase
+ * @param phase Milestone
+ * @return Time since power-up in ms, -1 if not reached yet
+ */
+int32_t boot_profile_get(boot_phase_t phase);
+
+/**
+ * @brief Short phase name for logs
+ */
+const char *boot_profile_phase_name(boot_phase_t phase);
+
+/**
+ * @brief Format all reached phases on one line ("name 123ms, ...")
+ * @param buf Output buffer
+ * @param len Buffer size
+ * @return Length written (truncated to len - 1)
+ */
+size_t boot_profile_format(char *buf, size_t len);
+
+#endif // BOOT_PROFILE_H
@@ -0,0 +1,36 @@
+/**
+ * @file bus_budget.c
+ * @brief Token bucket limiting background work to a fraction of 1-Wire bus time
+ * @version 1.2.0
+ * @date 2026-10-18
+ */
+
+#include "bus_budget.h"
+
+void bus_budget_init(bus_budget_t *budget, uint16_t permille, int64_t burst_us, int64_t now_us)
+{
+    budget->permille = permille == 0 ? 1 : permille > 1000 ? 1000 : permille;
+    budget->credit_us = 0;
+    budget->burst_us = burst_us;
+    budget->last_us = now_us;
+    budget->spent_us = 0;
+}
+
+bool bus_budget_allow(bus_budget_t *budget, int64_t now_us, int64_t cost_us)
+{
+    if (now_us > budget->last_us) {
+        budget->credit_us += (now_us - budget->last_us) * budget->permille / 1000;
+        if (budget->credit_us > budget->burst_us) {
+            budget->credit_us = budget->burst_us;
+        }
+        budget->last_us = now_us;
+    }
+    return budget->credit_us >= cost_us;
+}
+
+void bus_budget_charge(bus_budget_t *budget, int64_t used_us)
+{
+    // Credit may go negative when a step overruns its estimate; repaid by later refills
+    budget->credit_us -= used_us;
+    budget->spent_us += (uint64_t)used_us;
+}
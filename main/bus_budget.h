@@ -0,0 +1,57 @@
+/**
+ * @file bus_budget.h
+ * @brief Token bucket limiting background work to a fraction of 1-Wire bus time
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Credit accrues at fraction × elapsed time, capped at a burst size. A
+ * background step (rescan, verify) may start only if the credit covers its
+ * estimated cost; the measured duration is charged afterwards. Over any
+ * window the background share of bus time stays at or below the fraction
+ * plus one burst. Pure arithmetic on caller-supplied timestamps.
+ */
+
+#ifndef BUS_BUDGET_H
+#define BUS_BUDGET_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Budget state
+ */
+typedef struct {
+    uint16_t permille;       ///< Allowed share of bus time (1/1000)
+    int64_t credit_us;       ///< Accumulated allowance
+    int64_t burst_us;        ///< Credit cap
+    int64_t last_us;         ///< Time of last refill
+    uint64_t spent_us;       ///< Total charged time (statistics)
+} bus_budget_t;
+
+/**
+ * @brief Initialize budget with empty credit
+ * @param budget Budget state
+ * @param permille Allowed share of bus time in 1/1000 (1..1000)
+ * @param burst_us Maximum credit (must cover the most expensive step)
+ * @param now_us Current time
+ */
+void bus_budget_init(bus_budget_t *budget, uint16_t permille, int64_t burst_us, int64_t now_us);
+
+/**
+ * @brief Refill credit and check whether a step may run
+ * @param budget Budget state
+ * @param now_us Current time
+ * @param cost_us Estimated cost of the step
+ * @return true if credit covers the cost
+ */
+bool bus_budget_allow(bus_budget_t *budget, int64_t now_us, int64_t cost_us);
+
+/**
+ * @brief Charge measured bus time of a completed step
+ * @param budget Budget state
+ * @param used_us Measured duration
+ */
+void bus_budget_charge(bus_budget_t *budget, int64_t used_us);
+
+#endif // BUS_BUDGET_H
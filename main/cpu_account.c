@@ -0,0 +1,168 @@
+/**
+ * @file cpu_account.c
+ * @brief CPU time accounting of the sensor subsystem
+ * @version 1.2.0
+ * @date 2026-10-18
+ */
+
+#include "cpu_account.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG = "CPU_ACCOUNT";
+
+static const char *kind_names[CPU_ACCOUNT_KIND_COUNT] = {"busy-wait", "suspended", "conversion wait"};
+
+static struct {
+    TaskHandle_t task;
+    cpu_account_stats_t stats;
+    uint64_t logged_us[CPU_ACCOUNT_KIND_COUNT];     ///< total_us at previous cpu_account_log()
+} accounts[CPU_ACCOUNT_MAX_TASKS];
+
+static cpu_account_stats_t overflow;                ///< Tasks beyond CPU_ACCOUNT_MAX_TASKS
+static portMUX_TYPE account_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void stats_add(cpu_account_stats_t *stats, cpu_account_kind_t kind, uint32_t us)
+{
+    stats->total_us[kind] += us;
+    stats->count[kind]++;
+    if (us > stats->max_us[kind]) {
+        stats->max_us[kind] = us;
+    }
+}
+
+void cpu_account_add(cpu_account_kind_t kind, uint32_t us)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+
+    portENTER_CRITICAL(&account_lock);
+    for (int i = 0; i < CPU_ACCOUNT_MAX_TASKS; i++) {
+        if (accounts[i].task == self || accounts[i].task == NULL) {
+            accounts[i].task = self;
+            stats_add(&accounts[i].stats, kind, us);
+            portEXIT_CRITICAL(&account_lock);
+            return;
+        }
+    }
+    stats_add(&overflow, kind, us);
+    portEXIT_CRITICAL(&account_lock);
+}
+
+void cpu_account_get(TaskHandle_t task, cpu_account_stats_t *stats)
+{
+    if (task == NULL) {
+        task = xTaskGetCurrentTaskHandle();
+    }
+    memset(stats, 0, sizeof(*stats));
+
+    portENTER_CRITICAL(&account_lock);
+    for (int i = 0; i < CPU_ACCOUNT_MAX_TASKS; i++) {
+        if (accounts[i].task == task) {
+            *stats = accounts[i].stats;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&account_lock);
+}
+
+void cpu_account_get_total(cpu_account_stats_t *stats)
+{
+    portENTER_CRITICAL(&account_lock);
+    *stats = overflow;
+    for (int i = 0; i < CPU_ACCOUNT_MAX_TASKS; i++) {
+        for (int k = 0; k < CPU_ACCOUNT_KIND_COUNT; k++) {
+            stats->total_us[k] += accounts[i].stats.total_us[k];
+            stats->count[k] += accounts[i].stats.count[k];
+            if (accounts[i].stats.max_us[k] > stats->max_us[k]) {
+                stats->max_us[k] = accounts[i].stats.max_us[k];
+            }
+        }
+    }
+    portEXIT_CRITICAL(&account_lock);
+}
+
+void cpu_account_reset_max(void)
+{
+    portENTER_CRITICAL(&account_lock);
+    memset(overflow.max_us, 0, sizeof(overflow.max_us));
+    for (int i = 0; i < CPU_ACCOUNT_MAX_TASKS; i++) {
+        memset(accounts[i].stats.max_us, 0, sizeof(accounts[i].stats.max_us));
+    }
+    portEXIT_CRITICAL(&account_lock);
+}
+
+#if configGENERATE_RUN_TIME_STATS && configUSE_TRACE_FACILITY
+#define RUNTIME_MAX_TASKS   16      ///< Tasks listed from FreeRTOS run-time stats
+
+/**
+ * @brief Log each task's share of CPU run time since the previous call
+ */
+static void cpu_account_log_runtime(void)
+{
+    static TaskStatus_t status[RUNTIME_MAX_TASKS];
+    static struct {
+        TaskHandle_t task;
+        configRUN_TIME_COUNTER_TYPE runtime;
+    } prev[RUNTIME_MAX_TASKS];
+    static configRUN_TIME_COUNTER_TYPE prev_total;
+    configRUN_TIME_COUNTER_TYPE total;
+
+    UBaseType_t n = uxTaskGetSystemState(status, RUNTIME_MAX_TASKS, &total);
+    configRUN_TIME_COUNTER_TYPE elapsed = total - prev_total;
+    if (n == 0 || elapsed == 0) {
+        return;
+    }
+
+    for (UBaseType_t i = 0; i < n; i++) {
+        configRUN_TIME_COUNTER_TYPE before = 0;
+        for (int j = 0; j < RUNTIME_MAX_TASKS; j++) {
+            if (prev[j].task == status[i].xHandle) {
+                before = prev[j].runtime;
+                break;
+            }
+        }
+        uint32_t permille = (uint32_t)((uint64_t)(status[i].ulRunTimeCounter - before) * 1000 / elapsed);
+        ESP_LOGI(TAG, "Task %-16s %3u.%u%% CPU, stack free min %u", status[i].pcTaskName,
+                 (unsigned)(permille / 10), (unsigned)(permille % 10), (unsigned)status[i].usStackHighWaterMark);
+    }
+
+    memset(prev, 0, sizeof(prev));
+    for (UBaseType_t i = 0; i < n; i++) {
+        prev[i].task = status[i].xHandle;
+        prev[i].runtime = status[i].ulRunTimeCounter;
+    }
+    prev_total = total;
+}
+#endif
+
+void cpu_account_log(uint64_t interval_us)
+{
+    if (interval_us == 0) {
+        return;
+    }
+
+    for (int i = 0; i < CPU_ACCOUNT_MAX_TASKS; i++) {
+        portENTER_CRITICAL(&account_lock);
+        TaskHandle_t task = accounts[i].task;
+        cpu_account_stats_t stats = accounts[i].stats;
+        uint64_t delta[CPU_ACCOUNT_KIND_COUNT];
+        for (int k = 0; k < CPU_ACCOUNT_KIND_COUNT; k++) {
+            delta[k] = stats.total_us[k] - accounts[i].logged_us[k];
+            accounts[i].logged_us[k] = stats.total_us[k];
+        }
+        portEXIT_CRITICAL(&account_lock);
+
+        if (task == NULL) {
+            break;
+        }
+        for (int k = 0; k < CPU_ACCOUNT_KIND_COUNT; k++) {
+            uint32_t permille = (uint32_t)(delta[k] * 1000 / interval_us);
+            ESP_LOGI(TAG, "Task %-16s %-15s %3u.%u%% (max %uus)", pcTaskGetName(task), kind_names[k],
+                     (unsigned)(permille / 10), (unsigned)(permille % 10), (unsigned)stats.max_us[k]);
+        }
+    }
+
+#if configGENERATE_RUN_TIME_STATS && configUSE_TRACE_FACILITY
+    cpu_account_log_runtime();
+#endif
+}
@@ -0,0 +1,79 @@
+/**
+ * @file cpu_account.h
+ * @brief CPU time accounting of the sensor subsystem
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * The 1-Wire driver times slots by spinning in esp_rom_delay_us(), with the
+ * scheduler suspended around each transaction. This module attributes that
+ * time to the calling task, so its cost to the Zigbee stack is measurable:
+ * - Busy-wait: bus held by the task (acquire to release), CPU spinning
+ * - Suspended: scheduler suspended, no other task (Zigbee included) can run;
+ *   a subset of busy-wait, the longest window bounds added Zigbee latency
+ * - Conversion wait: task blocked for a DS18B20 conversion (no CPU)
+ *
+ * Each update is one table lookup and a few adds under a spinlock. With
+ * FreeRTOS run-time stats enabled (sdkconfig.defaults) the per-task CPU
+ * share over the last interval is logged next to it.
+ */
+
+#ifndef CPU_ACCOUNT_H
+#define CPU_ACCOUNT_H
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define CPU_ACCOUNT_MAX_TASKS   4       ///< Tasks tracked individually (sensor, console, ...)
+
+/**
+ * @brief Accounted time category
+ */
+typedef enum {
+    CPU_ACCOUNT_BUSY_WAIT = 0,      ///< Bus held, spinning in slot timing
+    CPU_ACCOUNT_SUSPENDED,          ///< Scheduler suspended
+    CPU_ACCOUNT_CONVERSION_WAIT,    ///< Blocked waiting for a conversion
+    CPU_ACCOUNT_KIND_COUNT,
+} cpu_account_kind_t;
+
+/**
+ * @brief Accounted time of one task (or all tasks)
+ */
+typedef struct {
+    uint64_t total_us[CPU_ACCOUNT_KIND_COUNT];  ///< Since boot
+    uint32_t count[CPU_ACCOUNT_KIND_COUNT];     ///< Accounted intervals since boot
+    uint32_t max_us[CPU_ACCOUNT_KIND_COUNT];    ///< Longest interval since cpu_account_reset_max()
+} cpu_account_stats_t;
+
+/**
+ * @brief Add time to the calling task
+ * @param kind Category
+ * @param us Duration in microseconds
+ */
+void cpu_account_add(cpu_account_kind_t kind, uint32_t us);
+
+/**
+ * @brief Stats of one task
+ * @param task Task handle (NULL = calling task)
+ * @param stats Output (zero if the task never accounted time)
+ */
+void cpu_account_get(TaskHandle_t task, cpu_account_stats_t *stats);
+
+/**
+ * @brief Stats summed over all tasks (max is the largest single interval)
+ */
+void cpu_account_get_total(cpu_account_stats_t *stats);
+
+/**
+ * @brief Restart max_us tracking (start of a new reporting interval)
+ */
+void cpu_account_reset_max(void);
+
+/**
+ * @brief Log per-task accounting and FreeRTOS run-time share since the previous call
+ * @param interval_us Wall time since the previous call (for percentages)
+ */
+void cpu_account_log(uint64_t interval_us);
+
+#endif // CPU_ACCOUNT_H
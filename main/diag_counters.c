@@ -0,0 +1,10 @@
+/**
+ * @file diag_counters.c
+ * @brief Always-on diagnostic counters
+ * @version 1.2.0
+ * @date 2026-10-18
+ */
+
+#include "diag_counters.h"
+
+diag_counters_t diag_counters;
@@ -0,0 +1,32 @@
+/**
+ * @file diag_counters.h
+ * @brief Always-on diagnostic counters
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Plain 32-bit counters in one global struct. Each update is a single
+ * load/add/store on the hot path; every counter has exactly one writer
+ * task, so no locking is needed and readers tolerate slightly stale values.
+ */
+
+#ifndef DIAG_COUNTERS_H
+#define DIAG_COUNTERS_H
+
+#include <stdint.h>
+
+/**
+ * @brief Diagnostic counters (since boot)
+ */
+typedef struct {
+    uint32_t report_requests;          ///< ZCL report commands handed to the stack
+    uint32_t report_request_failures;  ///< Report commands rejected by the stack
+    uint32_t aps_send_ok;              ///< Send confirmations with success status
+    uint32_t aps_send_failures;        ///< Send confirmations with error (no ACK, no route, ...)
+} diag_counters_t;
+
+extern diag_counters_t diag_counters;
+
+#define DIAG_INC(field)  (diag_counters.field++)
+
+#endif // DIAG_COUNTERS_H
@@ -0,0 +1,129 @@
+/**
+ * @file dlog.c
+ * @brief Deferred binary log: message ID and raw arguments in a lock-free ring
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Bounded MPSC queue: every slot carries a sequence number. A writer claims
+ * a position with compare-and-swap when the slot's sequence equals the
+ * position, fills the record and publishes it by storing position + 1; the
+ * reader consumes when the sequence is position + 1 and frees the slot for
+ * the next lap by storing position + DLOG_RING_LEN. No ESP-IDF dependencies.
+ */
+
+#include "dlog.h"
+#include <stdatomic.h>
+#include <string.h>
+
+typedef struct {
+    atomic_uint seq;
+    dlog_record_t rec;
+} dlog_slot_t;
+
+static dlog_slot_t ring[DLOG_RING_LEN];
+static atomic_uint write_pos;
+static unsigned read_pos;
+static atomic_uint dropped;
+
+void dlog_init(void)
+{
+    for (unsigned i = 0; i < DLOG_RING_LEN; i++) {
+        atomic_store_explicit(&ring[i].seq, i, memory_order_relaxed);
+    }
+    atomic_store_explicit(&write_pos, 0, memory_order_relaxed);
+    read_pos = 0;
+    atomic_store_explicit(&dropped, 0, memory_order_release);
+}
+
+bool dlog_write(uint32_t now_ms, uint16_t id, const int32_t *args, uint8_t argc)
+{
+    unsigned pos = atomic_load_explicit(&write_pos, memory_order_relaxed);
+    dlog_slot_t *slot;
+
+    for (;;) {
+        slot = &ring[pos & (DLOG_RING_LEN - 1)];
+        unsigned seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        int diff = (int)(seq - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&write_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+            return false;       // Reader is a full lap behind
+        } else {
+            pos = atomic_load_explicit(&write_pos, memory_order_relaxed);
+        }
+    }
+
+    if (argc > DLOG_MAX_ARGS) {
+        argc = DLOG_MAX_ARGS;
+    }
+    slot->rec.time_ms = now_ms;
+    slot->rec.id = id;
+    slot->rec.argc = argc;
+    memcpy(slot->rec.args, args, argc * sizeof(int32_t));
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+    return true;
+}
+
+bool dlog_read(dlog_record_t *rec)
+{
+    dlog_slot_t *slot = &ring[read_pos & (DLOG_RING_LEN - 1)];
+
+    if (atomic_load_explicit(&slot->seq, memory_order_acquire) != read_pos + 1) {
+        return false;
+    }
+    *rec = slot->rec;
+    atomic_store_explicit(&slot->seq, read_pos + DLOG_RING_LEN, memory_order_release);
+    read_pos++;
+    return true;
+}
+
+uint32_t dlog_dropped(void)
+{
+    return atomic_load_explicit(&dropped, memory_order_relaxed);
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+size_t dlog_encode(const dlog_record_t *rec, uint8_t *buf)
+{
+    uint8_t argc = rec->argc > DLOG_MAX_ARGS ? DLOG_MAX_ARGS : rec->argc;
+
+    put_u32(buf, rec->time_ms);
+    buf[4] = (uint8_t)rec->id;
+    buf[5] = (uint8_t)(rec->id >> 8);
+    buf[6] = argc;
+    for (uint8_t i = 0; i < argc; i++) {
+        put_u32(buf + 7 + 4 * i, (uint32_t)rec->args[i]);
+    }
+    return 7 + 4 * (size_t)argc;
+}
+
+size_t dlog_decode(const uint8_t *buf, size_t len, dlog_record_t *rec)
+{
+    if (len < 7 || buf[6] > DLOG_MAX_ARGS || len < 7 + 4 * (size_t)buf[6]) {
+        return 0;
+    }
+    rec->time_ms = get_u32(buf);
+    rec->id = buf[4] | buf[5] << 8;
+    rec->argc = buf[6];
+    for (uint8_t i = 0; i < rec->argc; i++) {
+        rec->args[i] = (int32_t)get_u32(buf + 7 + 4 * i);
+    }
+    return 7 + 4 * (size_t)rec->argc;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file dlog.h
+ * @brief Deferred binary log: message ID and raw arguments in a lock-free ring
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Hot-path logging without formatting: a writer stores a message ID, a
+ * caller-supplied timestamp and up to DLOG_MAX_ARGS integer arguments
+ * (e.g. centidegrees instead of floats) into a fixed ring; a low-priority
+ * reader formats them later (dlog_msgs.c) or exports the records as hex
+ * for host-side decoding (host/dlog_decode).
+ *
+ * The ring is a bounded multi-producer / single-consumer queue (per-slot
+ * sequence numbers, C11 atomics): writers never block or take a lock, and
+ * a full ring drops the new record and counts it.
+ *
+ * Build modes (DLOG_MODE, set with idf.py -DSENSOR_LOG=off|deferred|raw):
+ * - DLOG_MODE_OFF: DLOG() compiles to nothing, arguments are not evaluated
+ * - DLOG_MODE_DEFERRED: records are formatted on the device by the drain task
+ * - DLOG_MODE_RAW: records are dumped as "DLOG <hex>" lines for the host decoder
+ */
+
+#ifndef DLOG_H
+#define DLOG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define DLOG_MODE_OFF           0
+#define DLOG_MODE_DEFERRED      1
+#define DLOG_MODE_RAW           2
+
+#ifndef DLOG_MODE
+#define DLOG_MODE               DLOG_MODE_DEFERRED
+#endif
+
+#define DLOG_MAX_ARGS           4       ///< Integer arguments per record
+#define DLOG_RING_LEN           128     ///< Records in ring (power of 2, 4 KB)
+#define DLOG_ENCODED_MAX_LEN    (7 + 4 * DLOG_MAX_ARGS)  ///< Bytes of one exported record
+
+_Static_assert((DLOG_RING_LEN & (DLOG_RING_LEN - 1)) == 0, "DLOG_RING_LEN must be a power of 2");
+
+/**
+ * @brief One log record
+ */
+typedef struct {
+    uint32_t time_ms;                ///< Caller-supplied timestamp
+    uint16_t id;                     ///< Message ID (dlog_msgs.h)
+    uint8_t argc;                    ///< Valid entries in args
+    int32_t args[DLOG_MAX_ARGS];     ///< Raw arguments
+} dlog_record_t;
+
+#if DLOG_MODE == DLOG_MODE_OFF
+#define DLOG(now_ms, id, ...)   ((void)0)
+#else
+/**
+ * @brief Log message id with integer arguments (at most DLOG_MAX_ARGS)
+ */
+#define DLOG(now_ms, id, ...) \
+    dlog_write((now_ms), (id), (const int32_t[]){__VA_ARGS__}, \
+               (uint8_t)(sizeof((const int32_t[]){__VA_ARGS__}) / sizeof(int32_t)))
+#endif
+
+/**
+ * @brief Empty the ring and reset the drop counter (before any writer runs)
+ */
+void dlog_init(void);
+
+/**
+ * @brief Append record (any task, never blocks)
+ * @param now_ms Timestamp
+ * @param id Message ID
+ * @param args Arguments
+ * @param argc Number of arguments (extra ones are dropped)
+ * @return false if the ring was full and the record was dropped
+ */
+bool dlog_write(uint32_t now_ms, uint16_t id, const int32_t *args, uint8_t argc);
+
+/**
+ * @brief Take oldest record (single reader)
+ * @param rec Output record
+ * @return false if the ring is empty
+ */
+bool dlog_read(dlog_record_t *rec);
+
+/**
+ * @brief Records dropped because the ring was full (since init)
+ */
+uint32_t dlog_dropped(void);
+
+/**
+ * @brief Serialize record (little endian: time u32, id u16, argc u8, args i32)
+ * @param rec Record
+ * @param buf Output, at least DLOG_ENCODED_MAX_LEN bytes
+ * @return Encoded length
+ */
+size_t dlog_encode(const dlog_record_t *rec, uint8_t *buf);
+
+/**
+ * @brief Parse a serialized record
+ * @param buf Input
+ * @param len Available bytes
+ * @param rec Output record
+ * @return Consumed bytes, 0 if truncated or invalid
+ */
+size_t dlog_decode(const uint8_t *buf, size_t len, dlog_record_t *rec);
+
+#endif // DLOG_H
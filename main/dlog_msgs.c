@@ -0,0 +1,49 @@
+/**
+ * @file dlog_msgs.c
+ * @brief Deferred log message IDs of the sensor path and their formatting
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Runs in the drain task on the device and in host/dlog_decode, so the
+ * text is identical in both places. Integer formatting only.
+ */
+
+#include "dlog_msgs.h"
+#include "report_policy.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CENTI_FMT       "%s%d.%02d"
+#define CENTI_ARGS(v)   ((v) < 0 ? "-" : ""), (int)(labs(v) / 100), (int)(labs(v) % 100)
+
+static const uint8_t msg_argc[] = {
+    [DLOG_MSG_READING] = 2,
+    [DLOG_MSG_REPORT] = 3,
+    [DLOG_MSG_REFRESH] = 2,
+    [DLOG_MSG_ZB_UPDATE] = 2,
+};
+
+int dlog_msg_format(const dlog_record_t *rec, char *buf, size_t len)
+{
+    const int32_t *a = rec->args;
+
+    if (rec->id == 0 || rec->id >= sizeof(msg_argc) || rec->argc < msg_argc[rec->id]) {
+        return snprintf(buf, len, "Unknown message %u (%u args)", rec->id, rec->argc);
+    }
+
+    switch ((dlog_msg_id_t)rec->id) {
+    case DLOG_MSG_READING:
+        return snprintf(buf, len, "Sensor %d: " CENTI_FMT "°C", (int)a[0] + 1, CENTI_ARGS((long)a[1]));
+    case DLOG_MSG_REPORT:
+        return snprintf(buf, len, "Sensor %d: %s at " CENTI_FMT "°C", (int)a[0] + 1,
+                        report_policy_reason_str((report_reason_t)a[1]), CENTI_ARGS((long)a[2]));
+    case DLOG_MSG_REFRESH:
+        return snprintf(buf, len, "Sensor %d: On-demand refresh at " CENTI_FMT "°C (stale read)", (int)a[0] + 1,
+                        CENTI_ARGS((long)a[1]));
+    case DLOG_MSG_ZB_UPDATE:
+        return snprintf(buf, len, "Zigbee update -> endpoint %d | temp " CENTI_FMT "C | payload [%02X %02X]",
+                        (int)a[0], CENTI_ARGS((long)a[1]), (unsigned)(a[1] & 0xFF), (unsigned)((a[1] >> 8) & 0xFF));
+    }
+    return snprintf(buf, len, "Unknown message %u (%u args)", rec->id, rec->argc);
+}
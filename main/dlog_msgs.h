@@ -0,0 +1,37 @@
+/**
+ * @file dlog_msgs.h
+ * @brief Deferred log message IDs of the sensor path and their formatting
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * IDs are part of the raw export format read by host/dlog_decode: append
+ * new messages, never renumber. Temperatures are passed in centidegrees.
+ */
+
+#ifndef DLOG_MSGS_H
+#define DLOG_MSGS_H
+
+#include <stddef.h>
+#include "dlog.h"
+
+/**
+ * @brief Message IDs (arguments in brackets)
+ */
+typedef enum {
+    DLOG_MSG_READING = 1,           ///< Cycle reading [slot, centidegrees]
+    DLOG_MSG_REPORT,                ///< Report decision [slot, report_reason_t, centidegrees]
+    DLOG_MSG_REFRESH,               ///< On-demand refresh [slot, centidegrees]
+    DLOG_MSG_ZB_UPDATE,             ///< Attribute update [endpoint, centidegrees]
+} dlog_msg_id_t;
+
+/**
+ * @brief Format record as a log line (without timestamp)
+ * @param rec Record
+ * @param buf Output buffer
+ * @param len Buffer size
+ * @return snprintf result
+ */
+int dlog_msg_format(const dlog_record_t *rec, char *buf, size_t len);
+
+#endif // DLOG_MSGS_H
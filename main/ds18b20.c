@@ -9,18 +9,25 @@
  * Supports:
  * - MATCH ROM mode: Multiple sensors on one bus with individual addressing
  * - SKIP ROM mode: Single sensor mode (faster, no ROM addressing)
+ * - DS18B20_MATCH_ROM_ENABLED=0: SKIP ROM only, MATCH ROM compiled out
  * - Temperature range: -55°C to +125°C
  * - Resolution: 12-bit (0.0625°C)
  * - CRC8 validation for data integrity
  * 
  * @note Conversion time: 750ms at 12-bit resolution
  * @note Uses FreeRTOS task suspension during critical OneWire operations
+ * @note Holds the bus (onewire_bus_acquire) only for the trigger and read
+ *       transactions, other clients may use it during conversion
+ * @note Suspended-scheduler windows and conversion waits are accounted to
+ *       the calling task (cpu_account.h)
  */
 
 #include "ds18b20.h"
+#include "cpu_account.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include <string.h>
 
 static const char *TAG = "DS18B20";
@@ -33,6 +40,7 @@ static const char *TAG = "DS18B20";
 #define DS18B20_CMD_CONVERT_T 0x44       ///< Start temperature conversion
 #define DS18B20_CMD_READ_SCRATCHPAD 0xBE ///< Read temperature data and configuration
 
+#if DS18B20_MATCH_ROM_ENABLED
 /**
  * @brief Initialize DS18B20 device with MATCH ROM addressing
  * 
@@ -51,8 +59,11 @@ void ds18b20_init(ds18b20_device_t *device, onewire_bus_handle_t *bus, const uin
     device->bus = bus;
     memcpy(device->rom, rom, 8);
     device->use_skip_rom = false;
+    device->read_samples = 0;
+    memset(&device->stats, 0, sizeof(device->stats));
     ESP_LOGI(TAG, "DS18B20 initialized with MATCH ROM");
 }
+#endif
 
 /**
  * @brief Initialize DS18B20 device with SKIP ROM mode
@@ -71,6 +82,8 @@ void ds18b20_init_skip_rom(ds18b20_device_t *device, onewire_bus_handle_t *bus)
     device->bus = bus;
     memset(device->rom, 0, 8);
     device->use_skip_rom = true;
+    device->read_samples = 0;
+    memset(&device->stats, 0, sizeof(device->stats));
     ESP_LOGI(TAG, "DS18B20 initialized with SKIP ROM (single sensor mode)");
 }
 
@@ -87,14 +100,16 @@ void ds18b20_init_skip_rom(ds18b20_device_t *device, onewire_bus_handle_t *bus)
  */
 static void ds18b20_select(const ds18b20_device_t *device)
 {
-    if (device->use_skip_rom) {
-        onewire_bus_write_byte(device->bus, DS18B20_CMD_SKIP_ROM);
-    } else {
+#if DS18B20_MATCH_ROM_ENABLED
+    if (!device->use_skip_rom) {
         onewire_bus_write_byte(device->bus, DS18B20_CMD_MATCH_ROM);
         for (int i = 0; i < 8; i++) {
             onewire_bus_write_byte(device->bus, device->rom[i]);
         }
+        return;
     }
+#endif
+    onewire_bus_write_byte(device->bus, DS18B20_CMD_SKIP_ROM);
 }
 
 /**
@@ -114,11 +129,12 @@ static void ds18b20_select(const ds18b20_device_t *device)
  * @note Caller MUST wait 750ms before reading temperature
  * @note During conversion, DS18B20 pulls data line LOW (parasite power mode)
  */
-static bool ds18b20_trigger_temperature_conversion(const ds18b20_device_t *device)
+static bool ds18b20_trigger_temperature_conversion(ds18b20_device_t *device)
 {
     // Standard Arduino library sequence: reset → select → CONVERT_T
     if (!onewire_bus_reset(device->bus)) {
         ESP_LOGW(TAG, "No presence pulse during conversion trigger");
+        device->stats.presence_failures++;
         return false;
     }
     
@@ -155,11 +171,12 @@ static bool ds18b20_trigger_temperature_conversion(const ds18b20_device_t *devic
  * 
  * @note Always validate CRC8 after reading
  */
-static bool ds18b20_read_scratchpad(const ds18b20_device_t *device, uint8_t *scratchpad)
+static bool ds18b20_read_scratchpad(ds18b20_device_t *device, uint8_t *scratchpad)
 {
     // Standard Arduino library sequence: reset → select → READ_SCRATCHPAD → read 9 bytes → reset
     if (!onewire_bus_reset(device->bus)) {
         ESP_LOGW(TAG, "No presence pulse during read");
+        device->stats.presence_failures++;
         return false;
     }
     
@@ -173,92 +190,224 @@ static bool ds18b20_read_scratchpad(const ds18b20_device_t *device, uint8_t *scr
     // Arduino library does reset again after reading
     if (!onewire_bus_reset(device->bus)) {
         ESP_LOGW(TAG, "No presence pulse after read");
+        device->stats.presence_failures++;
         return false;
     }
     
     return true;
 }
 
+/**
+ * @brief Check scratchpad contents
+ * 
+ * @param scratchpad 9-byte scratchpad
+ * @return true if not all 0xFF (line stuck high) and CRC8 matches
+ */
+static bool ds18b20_scratchpad_valid(const uint8_t *scratchpad)
+{
+    // Check for all FF pattern (indicates read failure)
+    bool all_ff = true;
+    for (int i = 0; i < 9; i++) {
+        if (scratchpad[i] != 0xFF) {
+            all_ff = false;
+            break;
+        }
+    }
+    
+    if (all_ff) {
+        ESP_LOGW(TAG, "Invalid temperature data (all 0xFF)");
+        return false;
+    }
+    
+    // Verify CRC (like Arduino library does in isConnected())
+    uint8_t crc = onewire_bus_crc8(scratchpad, 8);
+    if (crc != scratchpad[8]) {
+        ESP_LOGW(TAG, "CRC mismatch: calculated=0x%02X, received=0x%02X", crc, scratchpad[8]);
+        return false;
+    }
+    
+    return true;
+}
+
+/**
+ * @brief Read and validate scratchpad, re-reading after a bad CRC
+ * 
+ * @param device Pointer to DS18B20 device structure
+ * @param prio Bus arbitration priority of the caller
+ * @param temperature Pointer to float variable for temperature result
+ * @return ESP_OK on success, ESP_ERR_TIMEOUT if the bus stayed busy, ESP_FAIL on error
+ */
+static esp_err_t ds18b20_read_result(ds18b20_device_t *device, onewire_bus_prio_t prio, float *temperature)
+{
+    uint8_t scratchpad[9];
+    for (int attempt = 0; ; attempt++) {
+        if (onewire_bus_acquire(device->bus, prio, DS18B20_BUS_TIMEOUT_MS) != ESP_OK) {
+            ESP_LOGW(TAG, "Bus busy, scratchpad not read");
+            device->stats.bus_timeouts++;
+            return ESP_ERR_TIMEOUT;
+        }
+        
+#if !ONEWIRE_FIXED_TIMING
+        // Device override (benchmark runs) applies to this hold only, other clients keep the bus timing
+        onewire_timing_t bus_timing = device->bus->timing;
+        bool override = device->read_samples != 0 && device->read_samples != device->bus->read_samples;
+        if (override) {
+            onewire_timing_set_read_samples(&device->bus->timing, device->read_samples);
+        }
+#endif
+        
+        // Disable task switching again for reading
+        int64_t t0 = esp_timer_get_time();
+        vTaskSuspendAll();
+        
+        // 2. Reset → select → READ_SCRATCHPAD → read 9 bytes → reset
+        bool read_ok = ds18b20_read_scratchpad(device, scratchpad);
+        
+        // Re-enable task switching
+        xTaskResumeAll();
+        cpu_account_add(CPU_ACCOUNT_SUSPENDED, (uint32_t)(esp_timer_get_time() - t0));
+#if !ONEWIRE_FIXED_TIMING
+        if (override) {
+            device->bus->timing = bus_timing;
+        }
+#endif
+        onewire_bus_release(device->bus);
+        
+        if (!read_ok) {
+            return ESP_FAIL;
+        }
+        if (ds18b20_scratchpad_valid(scratchpad)) {
+            break;
+        }
+        
+        // Bad CRC is usually a bit error on the line: the converted value is
+        // still in the scratchpad, so re-read instead of reconverting
+        device->stats.crc_errors++;
+        if (attempt >= DS18B20_READ_RETRIES) {
+            return ESP_FAIL;
+        }
+        device->stats.retries++;
+    }
+    
+    // Parse temperature
+    int16_t raw_temp = (scratchpad[1] << 8) | scratchpad[0];
+    *temperature = raw_temp / 16.0f;
+    
+    return ESP_OK;
+}
+
 /**
  * @brief Read temperature from DS18B20 sensor
  * 
- * Complete temperature reading sequence with FreeRTOS task protection:
- * 1. Suspend all tasks (critical section for GPIO)
+ * Complete temperature reading sequence with bus arbitration and FreeRTOS task protection:
+ * 1. Acquire bus, suspend all tasks (critical section for GPIO)
  * 2. Trigger temperature conversion
- * 3. Resume tasks
+ * 3. Resume tasks, release bus
  * 4. Wait 750ms for conversion
- * 5. Suspend tasks again
+ * 5. Acquire bus, suspend tasks again
  * 6. Read scratchpad
- * 7. Resume tasks
- * 8. Validate CRC8
+ * 7. Resume tasks, release bus
+ * 8. Validate CRC8 (bad read: re-read scratchpad up to DS18B20_READ_RETRIES times)
  * 9. Parse and return temperature
  * 
  * @param device Pointer to DS18B20 device structure
+ * @param prio Bus arbitration priority of the caller
  * @param temperature Pointer to float variable for temperature result
- * @return ESP_OK on success, ESP_FAIL on error
+ * @return ESP_OK on success, ESP_ERR_TIMEOUT if the bus stayed busy, ESP_FAIL on error
  * 
  * @note Temperature is returned in degrees Celsius
  * @note Resolution: 0.0625°C (12-bit)
  * @note Range: -55°C to +125°C
  * @note Task suspension prevents Zigbee/other tasks from disrupting OneWire timing
+ * @note Sensors must be externally powered: the bus is released during conversion
  * @note All 0xFF pattern indicates sensor communication failure
  */
-esp_err_t ds18b20_get_temperature(ds18b20_device_t *device, float *temperature)
+esp_err_t ds18b20_get_temperature(ds18b20_device_t *device, onewire_bus_prio_t prio, float *temperature)
 {
+    // Bus ownership first (may block), task suspension only around bit timing
+    if (onewire_bus_acquire(device->bus, prio, DS18B20_BUS_TIMEOUT_MS) != ESP_OK) {
+        ESP_LOGW(TAG, "Bus busy, conversion not started");
+        device->stats.bus_timeouts++;
+        return ESP_ERR_TIMEOUT;
+    }
+    
     // CRITICAL SECTION: Disable FreeRTOS task switching during OneWire communication
     // This prevents Zigbee or other tasks from interfering with GPIO state
+    int64_t t0 = esp_timer_get_time();
     vTaskSuspendAll();
     
     // Standard Arduino library sequence:
     // 1. Reset → select → CONVERT_T
-    if (!ds18b20_trigger_temperature_conversion(device)) {
-        xTaskResumeAll();
-        return ESP_FAIL;
-    }
+    bool started = ds18b20_trigger_temperature_conversion(device);
     
-    // Re-enable task switching during the long conversion delay
+    // Re-enable task switching and free the bus during the long conversion delay
     xTaskResumeAll();
+    cpu_account_add(CPU_ACCOUNT_SUSPENDED, (uint32_t)(esp_timer_get_time() - t0));
+    onewire_bus_release(device->bus);
     
-    // Wait for conversion outside critical section
-    vTaskDelay(pdMS_TO_TICKS(750));
-    
-    // Disable task switching again for reading
-    vTaskSuspendAll();
-    
-    // 2. Reset → select → READ_SCRATCHPAD → read 9 bytes → reset
-    uint8_t scratchpad[9];
-    if (!ds18b20_read_scratchpad(device, scratchpad)) {
-        xTaskResumeAll();
+    if (!started) {
         return ESP_FAIL;
     }
     
-    // Re-enable task switching
-    xTaskResumeAll();
+    // Wait for conversion outside critical section
+    int64_t conversion_start = esp_timer_get_time();
+    vTaskDelay(pdMS_TO_TICKS(DS18B20_CONVERSION_MS));
+    cpu_account_add(CPU_ACCOUNT_CONVERSION_WAIT, (uint32_t)(esp_timer_get_time() - conversion_start));
     
-    // Check for all FF pattern (indicates read failure)
-    bool all_ff = true;
-    for (int i = 0; i < 9; i++) {
-        if (scratchpad[i] != 0xFF) {
-            all_ff = false;
-            break;
-        }
+    esp_err_t err = ds18b20_read_result(device, prio, temperature);
+    if (err == ESP_OK) {
+        device->stats.last_conversion_ms = (uint16_t)((esp_timer_get_time() - conversion_start) / 1000);
     }
-    
-    if (all_ff) {
-        ESP_LOGW(TAG, "Invalid temperature data (all 0xFF)");
-        return ESP_FAIL;
+    return err;
+}
+
+/**
+ * @brief Start conversion on all sensors of the bus at once
+ * 
+ * SKIP ROM addresses every device, so all sensors convert in parallel and
+ * one 750 ms wait covers the whole bus.
+ * 
+ * @param bus Pointer to OneWire bus handle
+ * @param prio Bus arbitration priority of the caller
+ * @return ESP_OK on success, ESP_ERR_TIMEOUT if the bus stayed busy, ESP_ERR_NOT_FOUND without presence pulse
+ */
+esp_err_t ds18b20_convert_all(onewire_bus_handle_t *bus, onewire_bus_prio_t prio)
+{
+    if (onewire_bus_acquire(bus, prio, DS18B20_BUS_TIMEOUT_MS) != ESP_OK) {
+        ESP_LOGW(TAG, "Bus busy, conversion not started");
+        return ESP_ERR_TIMEOUT;
     }
     
-    // Verify CRC (like Arduino library does in isConnected())
-    uint8_t crc = onewire_bus_crc8(scratchpad, 8);
-    if (crc != scratchpad[8]) {
-        ESP_LOGW(TAG, "CRC mismatch: calculated=0x%02X, received=0x%02X", crc, scratchpad[8]);
-        return ESP_FAIL;
+    int64_t t0 = esp_timer_get_time();
+    vTaskSuspendAll();
+    bool presence = onewire_bus_reset(bus);
+    if (presence) {
+        onewire_bus_write_byte(bus, DS18B20_CMD_SKIP_ROM);
+        onewire_bus_write_byte(bus, DS18B20_CMD_CONVERT_T);
     }
+    xTaskResumeAll();
+    cpu_account_add(CPU_ACCOUNT_SUSPENDED, (uint32_t)(esp_timer_get_time() - t0));
+    onewire_bus_release(bus);
     
-    // Parse temperature
-    int16_t raw_temp = (scratchpad[1] << 8) | scratchpad[0];
-    *temperature = raw_temp / 16.0f;
-    
+    if (!presence) {
+        ESP_LOGW(TAG, "No presence pulse during conversion trigger");
+        return ESP_ERR_NOT_FOUND;
+    }
     return ESP_OK;
 }
+
+/**
+ * @brief Read the result of a finished conversion
+ * 
+ * For conversions started with ds18b20_convert_all(); validates CRC and
+ * re-reads like ds18b20_get_temperature().
+ * 
+ * @param device Pointer to DS18B20 device structure
+ * @param prio Bus arbitration priority of the caller
+ * @param temperature Pointer to float variable for temperature result
+ * @return ESP_OK on success, ESP_ERR_TIMEOUT if the bus stayed busy, ESP_FAIL on error
+ */
+esp_err_t ds18b20_read_temperature(ds18b20_device_t *device, onewire_bus_prio_t prio, float *temperature)
+{
+    return ds18b20_read_result(device, prio, temperature);
+}
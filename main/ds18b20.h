@@ -11,6 +11,21 @@
 #include "onewire_bus.h"
 #include "esp_err.h"
 
+#ifndef DS18B20_MATCH_ROM_ENABLED
+#define DS18B20_MATCH_ROM_ENABLED   1   ///< MATCH ROM addressing (0 = SKIP ROM only, CONFIG_THERMO_SKIP_ROM)
+#endif
+
+/**
+ * @brief Per-sensor error counters (single writer: the reading task)
+ */
+typedef struct {
+    uint32_t crc_errors;             ///< Scratchpad reads with bad CRC or all 0xFF
+    uint32_t presence_failures;      ///< Missing presence pulse on trigger or read
+    uint32_t retries;                ///< Scratchpad re-reads after a bad read
+    uint32_t bus_timeouts;           ///< Bus stayed busy (arbitration timeout)
+    uint16_t last_conversion_ms;     ///< Conversion start to successful read
+} ds18b20_stats_t;
+
 /**
  * @brief DS18B20 device handle structure
  * 
@@ -20,8 +35,11 @@ typedef struct {
     onewire_bus_handle_t *bus;  ///< Pointer to OneWire bus handle
     uint8_t rom[8];              ///< 64-bit ROM code (unique device ID)
     bool use_skip_rom;           ///< true = SKIP ROM mode, false = MATCH ROM mode
+    uint8_t read_samples;        ///< Read slot samples for this device's scratchpad reads (0 = bus setting)
+    ds18b20_stats_t stats;       ///< Error counters since init
 } ds18b20_device_t;
 
+#if DS18B20_MATCH_ROM_ENABLED
 /**
  * @brief Initialize DS18B20 with MATCH ROM addressing
  * 
@@ -30,6 +48,7 @@ typedef struct {
  * @param rom Pointer to 8-byte ROM code
  */
 void ds18b20_init(ds18b20_device_t *device, onewire_bus_handle_t *bus, const uint8_t *rom);
+#endif
 
 /**
  * @brief Initialize DS18B20 with SKIP ROM mode (single sensor)
@@ -39,13 +58,40 @@ void ds18b20_init(ds18b20_device_t *device, onewire_bus_handle_t *bus, const uin
  */
 void ds18b20_init_skip_rom(ds18b20_device_t *device, onewire_bus_handle_t *bus);
 
+#define DS18B20_BUS_TIMEOUT_MS  100     ///< Max wait for the bus per transaction
+#define DS18B20_READ_RETRIES    1       ///< Scratchpad re-reads after a bad CRC (no reconversion)
+#define DS18B20_CONVERSION_MS   750     ///< 12-bit conversion time
+
 /**
  * @brief Read temperature from DS18B20
  * 
  * @param device Pointer to device structure
+ * @param prio Bus arbitration priority of the caller
+ * @param temperature Pointer to store temperature (°C)
+ * @return ESP_OK on success, ESP_ERR_TIMEOUT if the bus stayed busy, ESP_FAIL on error
+ */
+esp_err_t ds18b20_get_temperature(ds18b20_device_t *device, onewire_bus_prio_t prio, float *temperature);
+
+/**
+ * @brief Start conversion on all sensors of the bus at once (SKIP ROM + CONVERT_T)
+ * 
+ * The caller waits DS18B20_CONVERSION_MS (e.g. in light sleep) and then
+ * reads each sensor with ds18b20_read_temperature().
+ * 
+ * @param bus Pointer to OneWire bus handle
+ * @param prio Bus arbitration priority of the caller
+ * @return ESP_OK on success, ESP_ERR_TIMEOUT if the bus stayed busy, ESP_ERR_NOT_FOUND without presence pulse
+ */
+esp_err_t ds18b20_convert_all(onewire_bus_handle_t *bus, onewire_bus_prio_t prio);
+
+/**
+ * @brief Read the result of a finished conversion (no new conversion)
+ * 
+ * @param device Pointer to device structure
+ * @param prio Bus arbitration priority of the caller
  * @param temperature Pointer to store temperature (°C)
- * @return ESP_OK on success, ESP_FAIL on error
+ * @return ESP_OK on success, ESP_ERR_TIMEOUT if the bus stayed busy, ESP_FAIL on error
  */
-esp_err_t ds18b20_get_temperature(ds18b20_device_t *device, float *temperature);
+esp_err_t ds18b20_read_temperature(ds18b20_device_t *device, onewire_bus_prio_t prio, float *temperature);
 
 #endif // DS18B20_H
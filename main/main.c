@@ -5,29 +5,50 @@
  * @date 2025-12-29
  * 
  * @details
- * This application reads temperature from up to two DS18B20 sensors on a OneWire bus
- * and reports changes via Zigbee to Home Assistant through Zigbee2MQTT.
- * The ESP32-C6 operates as a Zigbee Router (always powered, extends network range).
+ * This application reads temperature from up to SENSOR_MAX_COUNT (default two) DS18B20
+ * sensors on a OneWire bus and reports changes via Zigbee to Home Assistant through Zigbee2MQTT.
+ * The ESP32-C6 operates as a Zigbee Router (always powered, extends network range), or
+ * as a sleepy end device that deep-sleeps between samples (CONFIG_THERMO_SLEEPY_END_DEVICE).
  * 
  * Features:
  * - Dual DS18B20 sensor support with automatic ROM detection
- * - Two independent Zigbee endpoints (11, 12) for separate sensor reporting
+ * - Hot-plug: rate-limited background rescans add and remove sensors live
+ * - Independent Zigbee endpoints (11, 12, ...) for separate sensor reporting
+ * - Optional packed report frame carrying all sensors (cluster 0xFC00)
  * - Smart temperature reporting (threshold-based + periodic)
+ * - Read Attributes served from a bounded-staleness cache (out-of-cycle refresh)
+ * - RAM history per sensor (raw hour + 1-minute/15-minute min/avg/max)
+ * - Flash-backed delta-encoded log in dedicated "tlog" partition
+ * - Backfill of offline readings after rejoin (batched, throttled, cluster 0xFC00)
  * - Manual pairing via BOOT button (5 second long press)
  * - Factory reset on startup if BOOT button held
+ * - Reports follow the binding table (unicast and group bindings), coordinator fallback
  * - Seeed XIAO ESP32-C6 RF switch configuration for Zigbee
+ * - Battery variant: sleepy end device, radio only started when a report is due
+ * - Dynamic CPU frequency scaling, pinned to max only during 1-Wire transactions
  * 
- * @note TEST MODE: Set USE_SKIP_ROM_MODE to true for single sensor testing
+ * @note Bus GPIO, sensor count, addressing, slot timing and report thresholds
+ *       are set in menuconfig (Thermometer -> Sensors and 1-Wire bus)
  * @warning RF switch configuration (GPIO14/15) is CRITICAL for Zigbee functionality
  */
 
 #include <math.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/time.h>
 #include "esp_attr.h"
 #include "esp_log.h"
 #include "esp_check.h"
+#include "esp_console.h"
+#include "esp_mac.h"
+#include "esp_system.h"
+#include "esp_heap_caps.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "nvs_flash.h"
@@ -37,18 +58,91 @@
 #include "aps/esp_zigbee_aps.h"
 #include "zcl/esp_zigbee_zcl_command.h"
 #include "zcl/esp_zigbee_zcl_temperature_meas.h"
+#include "zdo/esp_zigbee_zdo_command.h"
+#include "zboss_api.h"
 
 #include "onewire_bus.h"
 #include "ds18b20.h"
+#include "temp_history.h"
+#include "tlog.h"
+#include "backfill.h"
+#include "report_frame.h"
+#include "sensor_config.h"
+#include "report_scheduler.h"
+#include "report_policy.h"
+#include "report_cycle.h"
+#include "diag_counters.h"
+#include "reading_cache.h"
+#include "bus_budget.h"
+#include "cpu_account.h"
+#include "bench_cmd.h"
+#include "dlog.h"
+#include "dlog_msgs.h"
+#include "boot_profile.h"
 #include "driver/gpio.h"
 
 /* Configuration */
-#define ONEWIRE_GPIO            GPIO_NUM_20  // GPIO20 (D9, MISO)
+#define ONEWIRE_GPIO            ((gpio_num_t)CONFIG_THERMO_ONEWIRE_GPIO) // Default GPIO20 (D9, MISO) (Kconfig)
+#ifdef CONFIG_THERMO_ONEWIRE_READ_SAMPLES
+#define ONEWIRE_READ_SAMPLES    CONFIG_THERMO_ONEWIRE_READ_SAMPLES // Majority vote per read slot (Kconfig)
+#else
+#define ONEWIRE_READ_SAMPLES    1           // Fixed timing: single sample
+#endif
 #define BOOT_BUTTON_GPIO        GPIO_NUM_9   // GPIO9 - BOOT button for manual pairing
-#define TEMP_REPORT_THRESHOLD   1.0f        // Report when temperature changes by 1°C
-#define TEMP_MAX_REPORT_INTERVAL_MS (1 * 60 * 1000) // Force report every 1 minute even without change
+#define BOOT_BUTTON_LONG_PRESS_MS 5000      // Hold time that starts manual pairing
+#define BOOT_BUTTON_DEBOUNCE_MS 30          // Level must be stable this long after the last edge
+#define TEMP_REPORT_THRESHOLD   (CONFIG_THERMO_REPORT_THRESHOLD_CENTI / 100.0f) // °C change that triggers a report (Kconfig)
+#define TEMP_MAX_REPORT_INTERVAL_MS (CONFIG_THERMO_REPORT_MAX_INTERVAL_S * 1000) // Force report without change (Kconfig)
+#define READ_MAX_AGE_MS         (CONFIG_THERMO_READ_MAX_AGE_S * 1000) // Older attribute: refresh on Read Attributes (Kconfig)
 #define TEMP_MIN_VALUE_CENTI   (-5500)      // -55.00°C valid range lower bound
 #define TEMP_MAX_VALUE_CENTI    12500       // 125.00°C valid range upper bound
+#define SENSOR_LOOP_PERIOD_MS   CONFIG_THERMO_SENSOR_PERIOD_MS // Nominal measurement cycle period (jittered, Kconfig)
+#define REPORT_STATS_LOG_CYCLES 60          // Log report/APS counters every N cycles (~5 minutes)
+#define SENSOR_NOTIFY_REFRESH   (1 << 0)    // Sensor task notification: stale Read Attributes pending
+#define SENSOR_NOTIFY_RESCAN    (1 << 1)    // Sensor task notification: console requested a full rescan
+#ifdef CONFIG_THERMO_SLEEPY_END_DEVICE
+#define SLEEPY_END_DEVICE       1           // Battery variant: deep sleep between samples (Kconfig)
+#else
+#define SLEEPY_END_DEVICE       0
+#endif
+#define BENCH_CONSOLE_ENABLE    (!SLEEPY_END_DEVICE) // Benchmark/diagnostics REPL on the USB-serial port (bench_cmd.c)
+#define ZB_TASK_STACK_SIZE      CONFIG_THERMO_ZB_TASK_STACK      // Bytes, statically allocated (Kconfig)
+#define SENSOR_TASK_STACK_SIZE  CONFIG_THERMO_SENSOR_TASK_STACK  // Bytes, statically allocated (Kconfig)
+#define CONSOLE_TASK_STACK_SIZE CONFIG_THERMO_CONSOLE_TASK_STACK // Bytes (Kconfig)
+#define DLOG_TASK_STACK_SIZE    CONFIG_THERMO_DLOG_TASK_STACK    // Bytes, statically allocated (Kconfig)
+#define MEM_CMD_MAX_TASKS       24          // Task snapshot size of the 'mem' console command
+#define MEM_HEAP_CAPS           (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT) // Heap measured by 'mem' and 'zbcap'
+#define DLOG_DRAIN_PERIOD_MS    1000        // Deferred log drain interval (ring holds 128 records)
+#define BUS_READY_TIMEOUT_MS    100         // Max wait for a first presence pulse before the ROM search
+#define BUS_READY_POLL_MS       2           // Presence poll interval while waiting (one reset is ~1 ms)
+#define RESCAN_INTERVAL_MS      (CONFIG_THERMO_RESCAN_INTERVAL_S * 1000) // Verify known sensors (Kconfig, 30 s)
+#define RESCAN_FULL_EVERY       10          // Full search for new sensors every N rounds (~5 minutes)
+#define RESCAN_BUS_PERMILLE     10          // Rescans use at most 1% of bus time
+#define RESCAN_STEP_COST_US     15000       // One verify or search step (reset + 64 x 3 slots)
+#define RESCAN_MISS_LIMIT       2           // Consecutive failed verifies before a sensor is removed
+#if !SLEEPY_END_DEVICE
+#define ZB_MAX_CHILDREN         CONFIG_THERMO_ZB_MAX_CHILDREN    // End-device children accepted (Kconfig)
+#define ZB_NETWORK_SIZE         CONFIG_THERMO_ZB_NETWORK_SIZE    // Sizes neighbor/routing/address tables (Kconfig)
+#define ZB_IO_BUFFERS           CONFIG_THERMO_ZB_IO_BUFFERS      // Stack frame buffers (Kconfig)
+#define ZB_HEAP_RESERVE         16384       // Heap left free when estimating the largest network size
+#if ZB_MAX_CHILDREN > ZB_NETWORK_SIZE
+#error "CONFIG_THERMO_ZB_MAX_CHILDREN must not exceed CONFIG_THERMO_ZB_NETWORK_SIZE"
+#endif
+#endif
+_Static_assert(SENSOR_MAX_COUNT <= REPORT_FRAME_PACKED_MAX_SENSORS, "all sensors must fit one packed readings frame");
+_Static_assert(SENSOR_MAX_COUNT <= TLOG_MAX_SENSORS, "flash log records must hold all sensors");
+_Static_assert(REPORT_FRAME_HISTORY_HEADER_LEN + REPORT_FRAME_HISTORY_RECORD_MAX_LEN <= REPORT_FRAME_MAX_LEN,
+               "one backfill record must fit a history frame");
+#if SLEEPY_END_DEVICE
+#define SLEEPY_PERIOD_MS        (CONFIG_THERMO_SLEEP_PERIOD_S * 1000)      // Wake-up to wake-up (Kconfig)
+#define SLEEPY_MAX_SILENT_MS    (CONFIG_THERMO_SLEEPY_MAX_SILENT_S * 1000) // Report at least this often (Kconfig)
+#define SLEEPY_MIN_SLEEP_MS     1000        // Shortest deep sleep after a long awake phase
+#define SLEEPY_JOIN_TIMEOUT_MS  10000       // Rejoin wait on a timer wake before giving up the cycle
+#define SLEEPY_PAIRING_WINDOW_MS 180000     // Cold boot without network: stay awake for BOOT-button pairing
+#define SLEEPY_CONFIRM_TIMEOUT_MS 3000      // Wait for APS confirms of the reports before sleeping
+#define SLEEPY_SEARCH_EVERY     288         // Full ROM search every N wakes (~1 day at 5 minutes)
+#define SLEEPY_RTC_MAGIC        0x534C5031  // "SLP1": RTC state valid
+#endif
 
 /**
  * @brief Seeed XIAO ESP32-C6 RF switch configuration (CRITICAL for Zigbee!)
@@ -64,13 +158,31 @@
 #define WIFI_ENABLE             GPIO_NUM_15  // RF enable pin (active LOW)
 #define WIFI_ANT_CONFIG         GPIO_NUM_14  // Antenna select (LOW = internal)
 
-// TEST MODE: Set to true to use SKIP ROM (single sensor only!)
-#define USE_SKIP_ROM_MODE       false
+// Single sensor addressed with SKIP ROM; search and MATCH ROM are compiled out (Kconfig)
+#ifdef CONFIG_THERMO_SKIP_ROM
+#define USE_SKIP_ROM_MODE       1
+#else
+#define USE_SKIP_ROM_MODE       0
+#endif
 
 #define INSTALLCODE_POLICY_ENABLE false     // Set to true if using install code
 
+/* Report mode (report_cycle.h): writable at runtime via cluster 0xFC00, persisted in NVS */
+#define REPORT_MODE_DEFAULT     REPORT_MODE_STANDARD
+#define THERMO_NVS_NAMESPACE    "thermo"
+#define THERMO_NVS_KEY_REPORT_MODE "report_mode"
+#define THERMO_NVS_KEY_BOOT_COUNT "boot_count"
+#define THERMO_NVS_KEY_BACKFILL_ACK "backfill_ack"  // Backfill delivery watermark (log time, s)
+#define BACKFILL_ACK_SAVE_INTERVAL_S TLOG_FLUSH_INTERVAL_S  // NVS write at most once per log flush interval
+
 static const char *TAG = "ZIGBEE_THERMO";
 
+/* Boot milestone at the current esp_timer time (ms since startup) */
+#define BOOT_MARK(phase)        boot_profile_mark((phase), (uint32_t)(esp_timer_get_time() / 1000))
+
+/* Per-reading logs: ID + raw centidegrees into the deferred log ring (dlog.c), formatted by the drain task */
+#define SENSOR_LOG(id, ...)     DLOG(esp_log_timestamp(), id, __VA_ARGS__)
+
 /**
  * @brief Zigbee commissioning source tracking
  * 
@@ -99,37 +211,173 @@ static esp_zb_platform_config_t zigbee_platform_config = {
         .install_code_policy = INSTALLCODE_POLICY_ENABLE,      \
         .nwk_cfg = {                                           \
             .zczr_cfg = {                                      \
-                .max_children = 10,                            \
+                .max_children = ZB_MAX_CHILDREN,               \
+            },                                                 \
+        },                                                     \
+    }
+
+/* Zigbee configuration - Sleepy end device (battery, polls its parent only while awake) */
+#define ESP_ZB_ZED_CONFIG()                                      \
+    {                                                           \
+        .esp_zb_role = ESP_ZB_DEVICE_TYPE_ED,                  \
+        .install_code_policy = INSTALLCODE_POLICY_ENABLE,      \
+        .nwk_cfg = {                                           \
+            .zed_cfg = {                                       \
+                .ed_timeout = ESP_ZB_ED_AGING_TIMEOUT_64MIN,   \
+                .keep_alive = 3000,                            \
             },                                                 \
         },                                                     \
     }
 
 /* Zigbee endpoint and cluster IDs */
-#define ESP_TEMP_SENSOR_ENDPOINT_1  11
-#define ESP_TEMP_SENSOR_ENDPOINT_2  12
-#define ZB_COORDINATOR_SHORT_ADDR   0x0000
+#define ESP_TEMP_SENSOR_ENDPOINT_1  SENSOR_ENDPOINT_BASE  // Also hosts manufacturer-specific cluster
+#define ZB_COORDINATOR_SHORT_ADDR   0x0000      // Fallback report destination (no binding)
 #define ZB_COORDINATOR_ENDPOINT     1
+#define REPORT_BINDING_FIRST_CHECK_MS   30000   // Let the coordinator configure bindings after joining
+#define REPORT_BINDING_REFRESH_MS       300000  // Re-read own binding table every 5 minutes
+
+/* Manufacturer-specific extension cluster (endpoint 11, decoded by esp32c6_thermometer.js) */
+#define ZB_THERMO_EXT_CLUSTER_ID            0xFC00
+#define ZB_THERMO_EXT_ATTR_HISTORY_BATCH    0x0000  // Octet string: backfill history batch frame
+#define ZB_THERMO_EXT_ATTR_PACKED_READINGS  0x0001  // Octet string: all current readings in one frame
+#define ZB_THERMO_EXT_ATTR_REPORT_MODE      0x0002  // Enum8 (R/W): report_mode_t
+#define ZB_THERMO_EXT_ATTR_CPU_BUSY         0x0003  // U16: sensor busy-wait share of CPU time (per mille, last stats interval)
+#define ZB_THERMO_EXT_ATTR_SUSPEND_MAX      0x0004  // U32: longest scheduler-suspended window (µs, last stats interval)
+/* Per-sensor diagnostics (cluster 0xFC00 on every sensor endpoint) */
+#define ZB_THERMO_EXT_ATTR_CRC_ERRORS       0x0010  // U32: scratchpad reads with bad CRC
+#define ZB_THERMO_EXT_ATTR_PRESENCE_FAILS   0x0011  // U32: missing presence pulses
+#define ZB_THERMO_EXT_ATTR_READ_RETRIES     0x0012  // U32: scratchpad re-reads
+#define ZB_THERMO_EXT_ATTR_LAST_CONV_MS     0x0013  // U16: conversion start to successful read (ms)
+/* Device diagnostics (cluster 0xFC00 on the first endpoint) */
+#define ZB_THERMO_EXT_ATTR_REPORT_FAILS     0x0020  // U32: reports rejected by the stack or not confirmed
+#define ZB_THERMO_EXT_ATTR_HEAP_FREE_MIN    0x0021  // U32: minimum free heap since boot (bytes)
+#define ZB_THERMO_EXT_ATTR_STACK_SENSOR     0x0022  // U16: sensor task stack high-water mark (bytes free)
+#define ZB_THERMO_EXT_ATTR_STACK_ZIGBEE     0x0023  // U16: Zigbee task stack high-water mark (bytes free)
+#define ZB_THERMO_EXT_ATTR_BOOT_REPORT_MS   0x0024  // U32: startup to first temperature report of this boot (ms)
+#define ZB_THERMO_EXT_ATTR_AWAKE_MS         0x0025  // U16: awake time of the previous sleep cycle (ms, sleepy build)
+#define ZB_THERMO_EXT_ATTR_LOG_RECORDS      0x0026  // U32: flash log records appended since boot
+#define ZB_THERMO_EXT_ATTR_LOG_ERASES       0x0027  // U32: flash log sector erases since boot
+#define ZB_THERMO_EXT_ATTR_LOG_BYTES        0x0028  // U32: flash log bytes programmed since boot
+
+/* ZCL Diagnostics cluster (0x0B05) attributes, first endpoint */
+#define ZB_DIAG_ATTR_NUMBER_OF_RESETS       0x0000  // U16
+#define ZB_DIAG_ATTR_APS_TX_UCAST_SUCCESS   0x0109  // U16 (wraps)
+#define ZB_DIAG_ATTR_APS_TX_UCAST_FAIL      0x010B  // U16 (wraps)
+
+/* Report destination per (endpoint, cluster), learned from own binding table */
+#define REPORT_BOUND_TEMP_MEAS  (1 << 0)   // Temperature Measurement cluster has a binding
+#define REPORT_BOUND_THERMO_EXT (1 << 1)   // Cluster 0xFC00 has a binding
+
+/**
+ * @brief Per-sensor state (slot index = endpoint offset = position in packed frame)
+ */
+typedef struct {
+    ds18b20_device_t dev;            ///< Driver handle
+    bool found;                      ///< Slot assigned to a ROM (kept while sensor is unplugged)
+    bool present;                    ///< Sensor currently answers on the bus
+    uint8_t misses;                  ///< Consecutive failed presence verifications
+} sensor_slot_t;
 
 /* Global variables */
 static onewire_bus_handle_t onewire_bus;
-static ds18b20_device_t sensor1;
-static ds18b20_device_t sensor2;
-
-static float last_temp1 = NAN;
-static float last_temp2 = NAN;
+#if ONEWIRE_TRACE_ENABLED
+static onewire_trace_t onewire_trace;
+static bool onewire_trace_dumped;    ///< One dump per stats interval
+#endif
+static sensor_slot_t sensors[SENSOR_MAX_COUNT];
+static uint8_t sensor_count = 0;     ///< Number of populated slots (slots 0..count-1)
+static portMUX_TYPE sensor_table_lock = portMUX_INITIALIZER_UNLOCKED; ///< Slot changes vs. Zigbee task/console readers
+static TaskHandle_t sensor_task_handle = NULL;
+static TaskHandle_t zb_task_handle = NULL;
+static StackType_t sensor_task_stack[SENSOR_TASK_STACK_SIZE];
+static StaticTask_t sensor_task_tcb;
+static StackType_t zb_task_stack[ZB_TASK_STACK_SIZE];
+static StaticTask_t zb_task_tcb;
+#if DLOG_MODE != DLOG_MODE_OFF && !SLEEPY_END_DEVICE
+static StackType_t dlog_task_stack[DLOG_TASK_STACK_SIZE];
+static StaticTask_t dlog_task_tcb;
+#endif
+static uint16_t boot_count = 0;      ///< Persistent reset counter (Diagnostics NumberOfResets)
 
-static TickType_t last_report_tick1 = 0;
-static TickType_t last_report_tick2 = 0;
+/**
+ * @brief Heap taken by the Zigbee stack per startup step (Zigbee task, written once)
+ */
+static struct {
+    uint32_t init;                   ///< esp_zb_init: tables sized by network size, children and buffers
+    uint32_t endpoints;              ///< Endpoint and cluster descriptors, one endpoint per sensor slot
+    uint32_t start;                  ///< esp_zb_start: radio and commissioning
+} zb_heap;
 
-static bool sensor1_found = false;
-static bool sensor2_found = false;
+/**
+ * @brief Background rescan state (sensor task only)
+ */
+typedef enum {
+    RESCAN_PHASE_IDLE = 0,           ///< Waiting for next round
+    RESCAN_PHASE_VERIFY,             ///< Targeted verification of known ROMs
+    RESCAN_PHASE_SEARCH,             ///< Full search for new ROMs
+} rescan_phase_t;
+
+#if !SLEEPY_END_DEVICE
+static struct {
+    rescan_phase_t phase;
+    uint8_t index;                   ///< Next slot to verify
+    uint32_t round;
+    bool full;                       ///< Round ends with a full search
+    bool requested;                  ///< Full round requested out of schedule
+    bool search_due;                 ///< A sensor was removed or added: search in the next round
+    int64_t next_round_us;
+    onewire_search_state_t search;
+    bus_budget_t budget;
+} rescan;
+#endif
+
+static uint8_t report_mode = REPORT_MODE_DEFAULT;
+#if !SLEEPY_END_DEVICE
+static report_scheduler_t report_sched;
+#endif
+static report_policy_t report_policy;        ///< Last reported values (sensor task only)
+static uint8_t packed_frame_seq = 0;
+static uint16_t cpu_busy_permille = 0;      ///< ZB_THERMO_EXT_ATTR_CPU_BUSY value
+static uint32_t cpu_suspend_max_us = 0;     ///< ZB_THERMO_EXT_ATTR_SUSPEND_MAX value
 
 static bool network_connected = false;
 static bool manual_pairing_pending = false;
 static volatile bool zigbee_stack_ready = false;
 static commissioning_source_t commissioning_source = COMMISSION_SOURCE_NONE;
+static bool backfill_scheduled = false;
+static uint32_t backfill_ack_saved_s = 0;   ///< Watermark last written to NVS (sensor task)
+static uint8_t report_bindings[SENSOR_MAX_COUNT];          ///< REPORT_BOUND_* flags per endpoint (Zigbee lock)
+static uint8_t report_bindings_scan[SENSOR_MAX_COUNT];     ///< Flags collected while reading table pages
+static uint8_t report_group_bindings = 0;                  ///< Group bindings seen in last complete scan
+static bool binding_check_scheduled = false;
 RTC_DATA_ATTR static bool rtc_wait_for_manual_pairing = false;
 
+#if SLEEPY_END_DEVICE
+/**
+ * @brief Sleepy end-device state kept in RTC memory across deep sleep
+ * 
+ * Valid after a timer wake when magic matches; a cold boot (power-on,
+ * reset button, crash) starts from scratch with a ROM search.
+ */
+typedef struct {
+    uint32_t magic;                             ///< SLEEPY_RTC_MAGIC when valid
+    uint8_t sensor_count;                       ///< Sensors found by the last ROM search
+    uint8_t roms[SENSOR_MAX_COUNT][8];          ///< Their ROM codes, by slot
+    report_policy_t policy;                     ///< Last reported values and report times
+    bool search_pending;                        ///< Run a ROM search on the next wake (read failure)
+    uint16_t wakes_since_search;                ///< Timer wakes since the last ROM search
+    uint32_t cycles;                            ///< Sleep cycles since cold boot
+    uint32_t radio_cycles;                      ///< Cycles that started the Zigbee stack
+    uint16_t awake_last_ms;                     ///< Awake time of the previous cycle
+    uint16_t awake_max_ms;                      ///< Longest awake time since cold boot
+    uint64_t awake_total_ms;                    ///< Sum of awake times since cold boot
+    uint16_t boot_count;                        ///< Reset counter read from NVS at cold boot
+} sleepy_rtc_state_t;
+
+RTC_DATA_ATTR static sleepy_rtc_state_t sleepy_rtc;
+static bool sleepy_cold_boot = true;        ///< Power-on/reset instead of a timer wake (set in app_main)
+#endif
+
 static const char *commission_source_to_str(commissioning_source_t source)
 {
     switch (source) {
@@ -193,6 +441,7 @@ static void handle_manual_pairing_request(void)
     manual_pairing_pending = true;
     rtc_wait_for_manual_pairing = true;
     ESP_LOGW(TAG, "Commissioning busy (%s), performing Zigbee factory reset", commission_source_to_str(commissioning_source));
+    tlog_flush();   // Factory reset restarts the chip; keep the buffered log records
     esp_zb_factory_reset();
 }
 
@@ -247,86 +496,301 @@ static const char zb_manufacturer[] = {9, 'E', 's', 'p', 'r', 'e', 's', 's', 'i'
 static const char zb_model[] = {10, 'E', 'S', 'P', '3', '2', 'C', '6', '.', 'T', 'H'};
 
 /**
- * @brief Initialize DS18B20 sensors on OneWire bus
+ * @brief Initialize and calibrate the OneWire bus
  * 
- * Initializes the OneWire bus on configured GPIO and scans for DS18B20 sensors.
- * Supports two modes:
- * - MATCH ROM mode: Detects up to 2 sensors and addresses them individually
- * - SKIP ROM mode: Single sensor only (for testing)
+ * Runs in app_main before the console and sensor task can use the bus.
+ * Sensor discovery is left to the sensor task (discover_sensors), so it
+ * overlaps with the Zigbee stack start.
  * 
- * @note Sensor family code 0x28 identifies DS18B20 devices
- * @note Uses GPIO20 (D9/MISO on Seeed XIAO ESP32-C6)
+ * @note Uses CONFIG_THERMO_ONEWIRE_GPIO (default GPIO20, D9/MISO on Seeed XIAO ESP32-C6)
  */
-static void init_sensors(void)
+static void init_onewire_bus(void)
 {
-    ESP_LOGI(TAG, "Initializing DS18B20 sensor(s)...");
-    ESP_LOGI(TAG, "TEST MODE: SKIP ROM = %s", USE_SKIP_ROM_MODE ? "ENABLED" : "DISABLED");
-    
-    // Initialize OneWire bus
     onewire_bus_config_t bus_config = {
         .pin = ONEWIRE_GPIO,
     };
     
     ESP_ERROR_CHECK(onewire_bus_init(&bus_config, &onewire_bus));
+    onewire_bus_set_read_samples(&onewire_bus, ONEWIRE_READ_SAMPLES);
+#if ONEWIRE_TRACE_ENABLED
+    onewire_trace_clear(&onewire_trace);
+    onewire_bus_set_trace(&onewire_bus, &onewire_trace);
+    ESP_LOGW(TAG, "1-Wire edge trace enabled (dumped after a failed read)");
+#endif
     ESP_LOGI(TAG, "OneWire bus initialized on GPIO%d", ONEWIRE_GPIO);
+}
+
+/**
+ * @brief Wait until a sensor answers a reset with a presence pulse
+ * 
+ * Replaces a fixed settle delay: returns at the first presence pulse
+ * (usually the first reset) and gives up after BUS_READY_TIMEOUT_MS, e.g.
+ * with no sensor connected (hot-plug detection adds sensors later).
+ * 
+ * @return true if a presence pulse was seen
+ */
+static bool wait_for_bus_ready(void)
+{
+    int64_t deadline_us = esp_timer_get_time() + (int64_t)BUS_READY_TIMEOUT_MS * 1000;
+    bool presence;
+
+    do {
+        presence = false;
+        if (onewire_bus_acquire(&onewire_bus, ONEWIRE_BUS_PRIO_PERIODIC, DS18B20_BUS_TIMEOUT_MS) == ESP_OK) {
+            presence = onewire_bus_reset(&onewire_bus);
+            onewire_bus_release(&onewire_bus);
+        }
+        if (!presence) {
+            vTaskDelay(pdMS_TO_TICKS(BUS_READY_POLL_MS));
+        }
+    } while (!presence && esp_timer_get_time() < deadline_us);
+
+    return presence;
+}
+
+/**
+ * @brief Change one slot of the sensor table (sensor task only)
+ * 
+ * The sensor task is the only writer and reads the table without locking;
+ * the Zigbee task and the console read it through sensor_count_get() and
+ * console_sensor_get(), so slot changes are published under sensor_table_lock.
+ * 
+ * @param slot Slot index
+ * @param dev New driver handle (slot becomes assigned), NULL to keep the current one
+ * @param present Sensor answers on the bus
+ */
+static void sensor_slot_set(uint8_t slot, const ds18b20_device_t *dev, bool present)
+{
+    portENTER_CRITICAL(&sensor_table_lock);
+    if (dev) {
+        sensors[slot].dev = *dev;
+        sensors[slot].found = true;
+        sensors[slot].misses = 0;
+    }
+    sensors[slot].present = present;
+    if (slot >= sensor_count) {
+        sensor_count = slot + 1;
+    }
+    portEXIT_CRITICAL(&sensor_table_lock);
+}
+
+/**
+ * @brief Number of populated slots, for readers outside the sensor task
+ */
+static uint8_t sensor_count_get(void)
+{
+    portENTER_CRITICAL(&sensor_table_lock);
+    uint8_t count = sensor_count;
+    portEXIT_CRITICAL(&sensor_table_lock);
+    return count;
+}
+
+/**
+ * @brief Scan OneWire bus for DS18B20 sensors (sensor task)
+ * 
+ * Supports two modes:
+ * - MATCH ROM mode: Detects up to SENSOR_MAX_COUNT sensors and addresses them individually
+ * - SKIP ROM mode: Single sensor only (for testing)
+ * 
+ * @note Sensor family code 0x28 identifies DS18B20 devices
+ */
+static void discover_sensors(void)
+{
+    ESP_LOGI(TAG, "Initializing DS18B20 sensor(s)...");
     
-    // Small delay for stability
-    vTaskDelay(pdMS_TO_TICKS(100));
+    ESP_LOGI(TAG, "SKIP ROM = %s", USE_SKIP_ROM_MODE ? "ENABLED" : "DISABLED");
     
-    if (USE_SKIP_ROM_MODE) {
-        // SKIP ROM mode - assumes only ONE sensor on bus
-        ESP_LOGW(TAG, "SKIP ROM MODE: Ensure only ONE DS18B20 is connected!");
-        ds18b20_init_skip_rom(&sensor1, &onewire_bus);
-        sensor1_found = true;
-    } else {
-        // Scan for sensors (MATCH ROM mode)
-        uint8_t rom_code[8];
-        bool search_mode = false;
-        int device_count = 0;
+    if (!wait_for_bus_ready()) {
+        ESP_LOGW(TAG, "No presence pulse within %dms", BUS_READY_TIMEOUT_MS);
+    }
+    BOOT_MARK(BOOT_PHASE_BUS_READY);
+    
+#if USE_SKIP_ROM_MODE
+    // SKIP ROM mode - assumes only ONE sensor on bus
+    ESP_LOGW(TAG, "SKIP ROM MODE: Ensure only ONE DS18B20 is connected!");
+    ds18b20_device_t dev;
+    ds18b20_init_skip_rom(&dev, &onewire_bus);
+    sensor_slot_set(0, &dev, true);
+#else
+    // Scan for sensors (MATCH ROM mode)
+    uint8_t rom_code[8];
+    bool search_mode = false;
+    int device_count = 0;
+    
+    ESP_LOGI(TAG, "Scanning for DS18B20 sensors...");
+    
+    // Search state spans calls, hold the bus for the whole enumeration
+    ESP_ERROR_CHECK(onewire_bus_acquire(&onewire_bus, ONEWIRE_BUS_PRIO_PERIODIC, portMAX_DELAY));
+    while (onewire_bus_search(&onewire_bus, rom_code, search_mode)) {
+        search_mode = true;
+        device_count++;
         
-        ESP_LOGI(TAG, "Scanning for DS18B20 sensors...");
+        ESP_LOGI(TAG, "Found device %d - ROM: %02X:%02X:%02X:%02X:%02X:%02X:%02X:%02X",
+                 device_count,
+                 rom_code[0], rom_code[1], rom_code[2], rom_code[3],
+                 rom_code[4], rom_code[5], rom_code[6], rom_code[7]);
         
-        while (onewire_bus_search(&onewire_bus, rom_code, search_mode)) {
-            search_mode = true;
-            device_count++;
-            
-            ESP_LOGI(TAG, "Found device %d - ROM: %02X:%02X:%02X:%02X:%02X:%02X:%02X:%02X",
-                     device_count,
-                     rom_code[0], rom_code[1], rom_code[2], rom_code[3],
-                     rom_code[4], rom_code[5], rom_code[6], rom_code[7]);
-            
-            // Check if it's a DS18B20 (family code 0x28)
-            if (rom_code[0] == 0x28) {
-                if (device_count == 1) {
-                    ds18b20_init(&sensor1, &onewire_bus, rom_code);
-                    sensor1_found = true;
-                    ESP_LOGI(TAG, "Sensor 1 initialized with MATCH ROM");
-                } else if (device_count == 2) {
-                    ds18b20_init(&sensor2, &onewire_bus, rom_code);
-                    sensor2_found = true;
-                    ESP_LOGI(TAG, "Sensor 2 initialized with MATCH ROM");
-                }
-            } else {
-                ESP_LOGW(TAG, "Device is not DS18B20 (family code: 0x%02X)", rom_code[0]);
-            }
-            
-            if (device_count >= 2) {
-                break;  // Stop after finding 2 sensors
-            }
+        // Check if it's a DS18B20 (family code 0x28)
+        if (rom_code[0] == 0x28) {
+            ds18b20_device_t dev;
+            ds18b20_init(&dev, &onewire_bus, rom_code);
+            sensor_slot_set(sensor_count, &dev, true);
+            ESP_LOGI(TAG, "Sensor %u initialized with MATCH ROM", sensor_count);
+        } else {
+            ESP_LOGW(TAG, "Device is not DS18B20 (family code: 0x%02X)", rom_code[0]);
         }
         
-        ESP_LOGI(TAG, "Scan complete. Found %d DS18B20 sensor(s)", device_count);
+        if (sensor_count >= SENSOR_MAX_COUNT) {
+            break;  // Stop after filling all sensor slots
+        }
     }
+    onewire_bus_release(&onewire_bus);
     
-    if (!sensor1_found) {
+    ESP_LOGI(TAG, "Scan complete. Found %d device(s), %u DS18B20 sensor(s)", device_count, sensor_count);
+#endif
+    
+    if (sensor_count == 0) {
         ESP_LOGW(TAG, "No DS18B20 sensors found!");
     }
     
+    BOOT_MARK(BOOT_PHASE_SENSORS_FOUND);
     ESP_LOGI(TAG, "DS18B20 initialization complete");
 }
 
+/**
+ * @brief Load report mode from NVS (falls back to REPORT_MODE_DEFAULT)
+ */
+static void load_report_mode(void)
+{
+    nvs_handle_t handle;
+    uint8_t mode = REPORT_MODE_DEFAULT;
+    
+    if (nvs_open(THERMO_NVS_NAMESPACE, NVS_READONLY, &handle) == ESP_OK) {
+        if (nvs_get_u8(handle, THERMO_NVS_KEY_REPORT_MODE, &mode) != ESP_OK || mode > REPORT_MODE_BOTH) {
+            mode = REPORT_MODE_DEFAULT;
+        }
+        nvs_close(handle);
+    }
+    
+    report_mode = mode;
+    ESP_LOGI(TAG, "Report mode: %s", mode == REPORT_MODE_STANDARD ? "standard" : mode == REPORT_MODE_PACKED ? "packed" : "packed+standard");
+}
+
+/**
+ * @brief Persist report mode written via cluster 0xFC00
+ */
+static void save_report_mode(uint8_t mode)
+{
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(THERMO_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err == ESP_OK) {
+        err = nvs_set_u8(handle, THERMO_NVS_KEY_REPORT_MODE, mode);
+        if (err == ESP_OK) {
+            err = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to persist report mode (%s)", esp_err_to_name(err));
+    }
+}
+
+/**
+ * @brief Increment persistent reset counter (Diagnostics NumberOfResets)
+ */
+static void count_boot(void)
+{
+    nvs_handle_t handle;
+    if (nvs_open(THERMO_NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK) {
+        return;
+    }
+    nvs_get_u16(handle, THERMO_NVS_KEY_BOOT_COUNT, &boot_count);
+    boot_count++;
+    if (nvs_set_u16(handle, THERMO_NVS_KEY_BOOT_COUNT, boot_count) == ESP_OK) {
+        nvs_commit(handle);
+    }
+    nvs_close(handle);
+    ESP_LOGI(TAG, "Boot #%u", boot_count);
+}
+
+#if !SLEEPY_END_DEVICE
+/**
+ * @brief Persist the backfill delivery watermark (sensor task)
+ * 
+ * Written when it has advanced by BACKFILL_ACK_SAVE_INTERVAL_S of log time,
+ * so NVS sees at most one write per log flush interval. After a reboot up
+ * to that much already delivered history is sent again; nothing is lost.
+ */
+static void backfill_ack_save_poll(void)
+{
+    uint32_t acked = backfill_acked_until();
+    if (acked < backfill_ack_saved_s + BACKFILL_ACK_SAVE_INTERVAL_S) {
+        return;
+    }
+
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(THERMO_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err == ESP_OK) {
+        err = nvs_set_u32(handle, THERMO_NVS_KEY_BACKFILL_ACK, acked);
+        if (err == ESP_OK) {
+            err = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to persist backfill watermark (%s)", esp_err_to_name(err));
+    }
+    backfill_ack_saved_s = acked;   // Also on failure: retry one interval later
+}
+
+/**
+ * @brief tlog_foreach() callback: re-queue records newer than the watermark
+ */
+static bool backfill_rebuild_cb(const tlog_record_t *record, void *ctx)
+{
+    if (record->time_s > backfill_ack_saved_s) {
+        backfill_push(record->time_s, record->values, record->sensor_count);
+        (*(uint32_t *)ctx)++;
+    }
+    return true;
+}
+
+/**
+ * @brief Rebuild the backfill queue from the flash log after a reboot
+ * 
+ * Records newer than the delivery watermark in NVS were taken offline and
+ * never sent (or sent within the last save interval). Without a watermark
+ * (first boot with this firmware, or after a factory reset) the current log
+ * time becomes the watermark and nothing is re-queued. Runs before the
+ * sensor task starts, so rebuilt samples stay ahead of new ones.
+ */
+static void backfill_rebuild_from_log(void)
+{
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(THERMO_NVS_NAMESPACE, NVS_READONLY, &handle);
+    if (err == ESP_OK) {
+        err = nvs_get_u32(handle, THERMO_NVS_KEY_BACKFILL_ACK, &backfill_ack_saved_s);
+        nvs_close(handle);
+    }
+    if (err != ESP_OK) {
+        backfill_ack_saved_s = tlog_time_now();
+        return;
+    }
+
+    uint32_t requeued = 0;
+    int64_t start_us = esp_timer_get_time();
+    if (tlog_foreach(backfill_rebuild_cb, &requeued) == ESP_OK && requeued > 0) {
+        ESP_LOGI(TAG, "Backfill rebuilt from flash log: %u record(s) after %us (%u ms scan, %u dropped)",
+                 (unsigned)requeued, (unsigned)backfill_ack_saved_s,
+                 (unsigned)((esp_timer_get_time() - start_us) / 1000), (unsigned)backfill_dropped());
+    }
+}
+#endif
+
 /**
  * @brief Zigbee attribute handler
+ * 
+ * Handles writes to the report mode attribute of cluster 0xFC00.
  */
 static esp_err_t zb_attribute_handler(const esp_zb_zcl_set_attr_value_message_t *message)
 {
@@ -342,6 +806,16 @@ static esp_err_t zb_attribute_handler(const esp_zb_zcl_set_attr_value_message_t
              message->attribute.id, 
              message->attribute.data.size);
     
+    if (message->info.cluster == ZB_THERMO_EXT_CLUSTER_ID &&
+        message->attribute.id == ZB_THERMO_EXT_ATTR_REPORT_MODE &&
+        message->attribute.data.value) {
+        uint8_t mode = *(const uint8_t *)message->attribute.data.value;
+        ESP_RETURN_ON_FALSE(mode <= REPORT_MODE_BOTH, ESP_ERR_INVALID_ARG, TAG, "Invalid report mode %u", mode);
+        report_mode = mode;
+        save_report_mode(mode);
+        ESP_LOGI(TAG, "Report mode set to %u", mode);
+    }
+    
     return ret;
 }
 
@@ -372,6 +846,272 @@ static void bdb_start_top_level_commissioning_cb(uint8_t mode_mask)
     ESP_ERROR_CHECK_WITHOUT_ABORT(esp_zb_bdb_start_top_level_commissioning(mode_mask));
 }
 
+/**
+ * @brief REPORT_BOUND_* flag for a reported cluster (0 = not tracked)
+ */
+static uint8_t report_binding_flag(uint16_t cluster_id)
+{
+    switch (cluster_id) {
+    case ESP_ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT:
+        return REPORT_BOUND_TEMP_MEAS;
+    case ZB_THERMO_EXT_CLUSTER_ID:
+        return REPORT_BOUND_THERMO_EXT;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Send attribute report to bound devices (caller holds Zigbee lock)
+ * 
+ * If the own binding table has an entry for the source endpoint and cluster,
+ * the report is sent without destination address, so the APS layer delivers
+ * it to every binding: one unicast per bound device and a single multicast
+ * per bound group. Local consumers (thermostats, heating controllers) then
+ * receive readings directly instead of via the coordinator.
+ * 
+ * Without a binding the report falls back to coordinator unicast (0x0000,
+ * endpoint 1), which keeps unconfigured devices working.
+ * 
+ * @param endpoint Source endpoint
+ * @param cluster_id Reported cluster (server role)
+ * @param attr_id Reported attribute
+ * @return Result of esp_zb_zcl_report_attr_cmd_req()
+ */
+static esp_err_t send_attribute_report(uint8_t endpoint, uint16_t cluster_id, uint16_t attr_id)
+{
+    uint8_t slot = endpoint - SENSOR_ENDPOINT_BASE;
+    bool bound = slot < SENSOR_MAX_COUNT && (report_bindings[slot] & report_binding_flag(cluster_id));
+
+    esp_zb_zcl_report_attr_cmd_t report_cmd = {0};
+    if (bound) {
+        report_cmd.address_mode = ESP_ZB_APS_ADDR_MODE_DST_ADDR_ENDP_NOT_PRESENT;
+    } else {
+        report_cmd.zcl_basic_cmd.dst_addr_u.addr_short = ZB_COORDINATOR_SHORT_ADDR;
+        report_cmd.zcl_basic_cmd.dst_endpoint = ZB_COORDINATOR_ENDPOINT;
+        report_cmd.address_mode = ESP_ZB_APS_ADDR_MODE_16_ENDP_PRESENT;
+    }
+    report_cmd.zcl_basic_cmd.src_endpoint = endpoint;
+    report_cmd.clusterID = cluster_id;
+    report_cmd.direction = ESP_ZB_ZCL_CMD_DIRECTION_TO_CLI;
+    report_cmd.dis_default_resp = 1;
+    report_cmd.attributeID = attr_id;
+
+    esp_err_t err = esp_zb_zcl_report_attr_cmd_req(&report_cmd);
+    DIAG_INC(report_requests);
+    if (err != ESP_OK) {
+        DIAG_INC(report_request_failures);
+    }
+    return err;
+}
+
+/**
+ * @brief Binding table response (Zigbee task context)
+ * 
+ * Collects which reported clusters of our endpoints have a binding. Large
+ * tables arrive in pages; flags are applied once the last page was read, so
+ * a half-read table never switches reports back to the coordinator.
+ */
+static void report_binding_table_cb(const esp_zb_zdo_binding_table_info_t *table_info, void *user_ctx)
+{
+    (void)user_ctx;
+
+    if (!table_info || table_info->status != ESP_ZB_ZDP_STATUS_SUCCESS) {
+        ESP_LOGW(TAG, "Binding table request failed (status 0x%02x), keeping current report destinations",
+                 table_info ? table_info->status : 0xFF);
+        return;
+    }
+
+    if (table_info->index == 0) {
+        memset(report_bindings_scan, 0, sizeof(report_bindings_scan));
+        report_group_bindings = 0;
+    }
+
+    for (esp_zb_zdo_binding_table_record_t *record = table_info->record; record; record = record->next) {
+        uint8_t slot = record->src_endp - SENSOR_ENDPOINT_BASE;
+        uint8_t flag = report_binding_flag(record->cluster_id);
+        if (slot >= SENSOR_MAX_COUNT || flag == 0) {
+            continue;
+        }
+        report_bindings_scan[slot] |= flag;
+        if (record->dst_addr_mode == ESP_ZB_ZDO_BIND_DST_ADDR_MODE_16_BIT_GROUP) {
+            report_group_bindings++;
+        }
+    }
+
+    uint8_t next_index = table_info->index + table_info->count;
+    if (table_info->count > 0 && next_index < table_info->total) {
+        esp_zb_zdo_mgmt_bind_param_t req = {
+            .start_index = next_index,
+            .dst_addr = esp_zb_get_short_address(),
+        };
+        esp_zb_zdo_binding_table_req(&req, report_binding_table_cb, NULL);
+        return;
+    }
+
+    if (memcmp(report_bindings, report_bindings_scan, sizeof(report_bindings)) != 0) {
+        memcpy(report_bindings, report_bindings_scan, sizeof(report_bindings));
+        for (uint8_t i = 0; i < SENSOR_MAX_COUNT; i++) {
+            ESP_LOGI(TAG, "Endpoint %u reports: temperature -> %s, 0xFC00 -> %s", SENSOR_ENDPOINT_BASE + i,
+                     (report_bindings[i] & REPORT_BOUND_TEMP_MEAS) ? "bindings" : "coordinator",
+                     (report_bindings[i] & REPORT_BOUND_THERMO_EXT) ? "bindings" : "coordinator");
+        }
+        ESP_LOGI(TAG, "Binding table: %u entr%s, %u group binding(s) for reported clusters",
+                 table_info->total, table_info->total == 1 ? "y" : "ies", report_group_bindings);
+    }
+}
+
+/**
+ * @brief Read own binding table and re-arm periodic check (Zigbee task context)
+ * 
+ * Bindings are created and removed remotely (Bind_req/Unbind_req from the
+ * coordinator or a commissioning tool) without notifying the application, so
+ * the table is re-read periodically while joined.
+ */
+static void report_binding_check_cb(uint8_t param)
+{
+    (void)param;
+    binding_check_scheduled = false;
+
+    if (!network_connected) {
+        return;
+    }
+
+    esp_zb_zdo_mgmt_bind_param_t req = {
+        .start_index = 0,
+        .dst_addr = esp_zb_get_short_address(),
+    };
+    esp_zb_zdo_binding_table_req(&req, report_binding_table_cb, NULL);
+
+    binding_check_scheduled = true;
+    esp_zb_scheduler_alarm(report_binding_check_cb, 0, REPORT_BINDING_REFRESH_MS);
+}
+
+/**
+ * @brief Start periodic binding table checks after (re)joining (Zigbee task context)
+ */
+static void report_binding_start(uint32_t delay_ms)
+{
+    if (binding_check_scheduled) {
+        return;
+    }
+    binding_check_scheduled = true;
+    esp_zb_scheduler_alarm(report_binding_check_cb, 0, delay_ms);
+}
+
+/**
+ * @brief Send one backfill history batch frame (Zigbee task context)
+ * 
+ * Runs from the Zigbee scheduler, so the stack lock is already held. Sends at
+ * most one frame per call and re-arms itself every BACKFILL_FRAME_INTERVAL_MS
+ * until the queue is empty, which throttles backfill traffic on the mesh.
+ * 
+ * @param param Unused scheduler parameter
+ * 
+ * @note Samples are removed from the queue only after the report was accepted
+ */
+static void backfill_send_cb(uint8_t param)
+{
+    (void)param;
+    backfill_scheduled = false;
+
+    if (!network_connected || backfill_pending() == 0) {
+        return;
+    }
+
+    // Octet string attribute: first byte is payload length
+    uint8_t attr_value[REPORT_FRAME_MAX_LEN + 1];
+    size_t len = backfill_build_frame(&attr_value[1], REPORT_FRAME_MAX_LEN, tlog_time_now());
+    if (len == 0) {
+        return;
+    }
+    attr_value[0] = (uint8_t)len;
+
+    esp_zb_zcl_set_attribute_val(ESP_TEMP_SENSOR_ENDPOINT_1,
+                                 ZB_THERMO_EXT_CLUSTER_ID,
+                                 ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 ZB_THERMO_EXT_ATTR_HISTORY_BATCH,
+                                 attr_value,
+                                 false);
+
+    esp_err_t err = send_attribute_report(ESP_TEMP_SENSOR_ENDPOINT_1, ZB_THERMO_EXT_CLUSTER_ID, ZB_THERMO_EXT_ATTR_HISTORY_BATCH);
+    if (err == ESP_OK) {
+        backfill_commit();
+        ESP_LOGI(TAG, "Backfill frame sent (%u bytes, %u samples still queued)", (unsigned)len, (unsigned)backfill_pending());
+    } else {
+        ESP_LOGW(TAG, "Backfill frame send failed (%s), will retry", esp_err_to_name(err));
+    }
+
+    if (backfill_pending() > 0) {
+        backfill_scheduled = true;
+        esp_zb_scheduler_alarm(backfill_send_cb, 0, BACKFILL_FRAME_INTERVAL_MS);
+    }
+}
+
+/**
+ * @brief Start draining offline readings after (re)joining (Zigbee task context)
+ */
+static void backfill_start(void)
+{
+    size_t pending = backfill_pending();
+    if (pending == 0 || backfill_scheduled) {
+        return;
+    }
+
+    ESP_LOGI(TAG, "Backfilling %u offline reading(s) (%u dropped while offline)",
+             (unsigned)pending, (unsigned)backfill_dropped());
+    backfill_scheduled = true;
+    esp_zb_scheduler_alarm(backfill_send_cb, 0, BACKFILL_FRAME_INTERVAL_MS);
+}
+
+/**
+ * @brief Raw ZCL command hook (Zigbee task context)
+ * 
+ * Watches Read Attributes requests on the Temperature Measurement cluster.
+ * If the attribute value of the addressed sensor was written more than
+ * READ_MAX_AGE_MS ago, the sensor task is notified to run an
+ * out-of-cycle conversion and push the fresh value as a report. The request
+ * itself is still answered immediately by the stack, the Zigbee task never
+ * waits for the 750 ms conversion.
+ * 
+ * @param bufid ZBOSS buffer holding the parsed ZCL command
+ * @return false - command is always processed by the stack as usual
+ */
+static bool zb_raw_command_handler(uint8_t bufid)
+{
+    zb_zcl_parsed_hdr_t *cmd_info = ZB_BUF_GET_PARAM(bufid, zb_zcl_parsed_hdr_t);
+
+    if (cmd_info->is_common_command &&
+        cmd_info->cmd_id == ZB_ZCL_CMD_READ_ATTRIB &&
+        cmd_info->cluster_id == ESP_ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT) {
+        uint8_t slot = ZB_ZCL_PARSED_HDR_SHORT_DATA(cmd_info).dst_endpoint - SENSOR_ENDPOINT_BASE;
+        if (slot < sensor_count_get() && sensor_task_handle &&
+            reading_cache_request_refresh(slot, READ_MAX_AGE_MS)) {
+            xTaskNotify(sensor_task_handle, SENSOR_NOTIFY_REFRESH, eSetBits);
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief ZCL command send status callback (APS confirm of every report)
+ * 
+ * Counts delivered and failed frames so the effect of report jitter on
+ * channel contention (retries, missing ACKs) is measurable.
+ * 
+ * @param message Send status of one ZCL command
+ */
+static void zb_command_send_status_handler(esp_zb_zcl_command_send_status_message_t message)
+{
+    if (message.status == ESP_OK) {
+        DIAG_INC(aps_send_ok);
+    } else {
+        DIAG_INC(aps_send_failures);
+        ESP_LOGD(TAG, "APS send failed: tsn %u, endpoint %u, status %d", message.tsn, message.src_endpoint, message.status);
+    }
+}
+
 /**
  * @brief Zigbee signal handler
  */
@@ -397,7 +1137,10 @@ void esp_zb_app_signal_handler(esp_zb_app_signal_t *signal_struct)
             network_connected = true;
             commissioning_source = COMMISSION_SOURCE_NONE;
             manual_pairing_pending = false;
+            BOOT_MARK(BOOT_PHASE_NETWORK_UP);
             ESP_LOGI(TAG, "Device rebooted and rejoined existing Zigbee network");
+            report_binding_start(0);
+            backfill_start();
         } else {
             network_connected = false;
             ESP_LOGW(TAG, "Device rebooted but Zigbee network is not available (%s)", esp_err_to_name(err_status));
@@ -415,8 +1158,11 @@ void esp_zb_app_signal_handler(esp_zb_app_signal_t *signal_struct)
                      esp_zb_get_pan_id(), esp_zb_get_current_channel());
 
             network_connected = true;
+            BOOT_MARK(BOOT_PHASE_NETWORK_UP);
             manual_pairing_pending = false;
             commissioning_source = COMMISSION_SOURCE_NONE;
+            report_binding_start(REPORT_BINDING_FIRST_CHECK_MS);
+            backfill_start();
         } else {
             ESP_LOGW(TAG, "Network steering (%s) failed (status: %s)", commission_source_to_str(source), esp_err_to_name(err_status));
             network_connected = false;
@@ -443,28 +1189,47 @@ void esp_zb_app_signal_handler(esp_zb_app_signal_t *signal_struct)
 }
 
 /**
- * @brief Update temperature attribute in Zigbee cluster and send report
- * 
- * Updates the ZCL temperature measurement attribute for the specified endpoint
- * and immediately sends a ZCL report command to the coordinator.
- * 
- * @param endpoint Zigbee endpoint ID (11 or 12)
- * @param temperature Temperature value in degrees Celsius
+ * @brief Log the boot profile and publish time to first report (once per boot)
+ * 
+ * Called by the sensor task right after the first report was accepted;
+ * the value is reported like the other device diagnostics, so the
+ * coordinator keeps a history across reboots.
+ */
+static void publish_boot_profile(void)
+{
+    char line[160];
+    uint32_t first_report_ms = (uint32_t)boot_profile_get(BOOT_PHASE_FIRST_REPORT);
+
+    boot_profile_format(line, sizeof(line));
+    ESP_LOGI(TAG, "Boot profile: %s", line);
+
+    esp_zb_lock_acquire(portMAX_DELAY);
+    esp_zb_zcl_set_attribute_val(ESP_TEMP_SENSOR_ENDPOINT_1, ZB_THERMO_EXT_CLUSTER_ID, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 ZB_THERMO_EXT_ATTR_BOOT_REPORT_MS, &first_report_ms, false);
+    esp_zb_lock_release();
+}
+
+/**
+ * @brief Update temperature attribute in Zigbee cluster and send report
+ * 
+ * Updates the ZCL temperature measurement attribute for the specified endpoint
+ * and immediately sends a ZCL report command to all bound devices (or the
+ * coordinator if the endpoint has no binding).
+ * 
+ * @param endpoint Zigbee endpoint ID (11, 12, ...)
+ * @param temperature Temperature value in degrees Celsius
+ * @param send_report false = only update attribute (packed report mode)
  * 
  * @note Temperature is converted to centidegrees (int16_t) for ZCL
  * @note Acquires Zigbee lock during attribute update and report transmission
  * @note Skips report if not connected to network
  */
-static void update_temperature_attribute(uint8_t endpoint, float temperature)
+static void update_temperature_attribute(uint8_t endpoint, float temperature, bool send_report)
 {
     int16_t measured_value = (int16_t)(temperature * 100);
-    uint8_t payload[2] = {
-        (uint8_t)(measured_value & 0xFF),
-        (uint8_t)((measured_value >> 8) & 0xFF)
-    };
 
-    ESP_LOGI(TAG, "Zigbee update -> endpoint %u | temp %.2fC | payload [%02X %02X]",
-             endpoint, temperature, payload[0], payload[1]);
+    SENSOR_LOG(DLOG_MSG_ZB_UPDATE, endpoint, measured_value);
+    reading_cache_store(endpoint - SENSOR_ENDPOINT_BASE, measured_value);   // Age of what Read Attributes returns
     
     // Acquire Zigbee lock before updating attribute / sending report
     esp_zb_lock_acquire(portMAX_DELAY);
@@ -477,83 +1242,519 @@ static void update_temperature_attribute(uint8_t endpoint, float temperature)
                                  false);
 
     esp_err_t report_status = ESP_ERR_INVALID_STATE;
-    if (network_connected) {
-        esp_zb_zcl_report_attr_cmd_t report_cmd = {0};
-        report_cmd.zcl_basic_cmd.dst_addr_u.addr_short = ZB_COORDINATOR_SHORT_ADDR;
-        report_cmd.zcl_basic_cmd.dst_endpoint = ZB_COORDINATOR_ENDPOINT;
-        report_cmd.zcl_basic_cmd.src_endpoint = endpoint;
-        report_cmd.address_mode = ESP_ZB_APS_ADDR_MODE_16_ENDP_PRESENT;
-        report_cmd.clusterID = ESP_ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT;
-        report_cmd.direction = ESP_ZB_ZCL_CMD_DIRECTION_TO_CLI;
-        report_cmd.dis_default_resp = 1;
-        report_cmd.attributeID = ESP_ZB_ZCL_ATTR_TEMP_MEASUREMENT_VALUE_ID;
-
-        report_status = esp_zb_zcl_report_attr_cmd_req(&report_cmd);
+    if (network_connected && send_report) {
+        report_status = send_attribute_report(endpoint, ESP_ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT,
+                                              ESP_ZB_ZCL_ATTR_TEMP_MEASUREMENT_VALUE_ID);
     }
 
     // Release Zigbee lock before logging
     esp_zb_lock_release();
 
-    if (!network_connected) {
+    if (!send_report) {
+        return;
+    } else if (report_status == ESP_OK && BOOT_MARK(BOOT_PHASE_FIRST_REPORT)) {
+        publish_boot_profile();
+    } else if (!network_connected) {
         ESP_LOGW(TAG, "Skipping Zigbee report for endpoint %u - not joined to a network", endpoint);
     } else if (report_status != ESP_OK) {
         ESP_LOGW(TAG, "Failed to send Zigbee report for endpoint %u (%s)", endpoint, esp_err_to_name(report_status));
     }
 }
 
+/* BOOT button state (edge time written by the ISR, the rest by esp_timer callbacks) */
+static esp_timer_handle_t button_debounce_timer;
+static esp_timer_handle_t button_long_press_timer;
+static volatile int64_t button_edge_us;      ///< First edge of the current bounce burst
+static int64_t button_press_start_us;        ///< Debounced press start
+static bool button_pressed;                  ///< Debounced state
+
 /**
- * @brief Task to monitor BOOT button for manual Zigbee pairing
+ * @brief BOOT button edge interrupt
  * 
- * Monitors the BOOT button (GPIO9) and triggers manual Zigbee commissioning
- * when the button is held for 5 seconds. The device will:
+ * Stamps the first edge of a bounce burst and (re)arms the debounce timer;
+ * all decisions happen in the esp_timer task.
+ */
+static void boot_button_isr(void *arg)
+{
+    if (!esp_timer_is_active(button_debounce_timer)) {
+        button_edge_us = esp_timer_get_time();
+    }
+    esp_timer_stop(button_debounce_timer);
+    esp_timer_start_once(button_debounce_timer, BOOT_BUTTON_DEBOUNCE_MS * 1000);
+}
+
+/**
+ * @brief Evaluate the settled button level after an edge burst
+ * 
+ * A press arms the one-shot long-press timer for the rest of the hold time
+ * (measured from the first edge), a release disarms it.
+ */
+static void boot_button_debounce_cb(void *arg)
+{
+    bool pressed = gpio_get_level(BOOT_BUTTON_GPIO) == 0;   // Active LOW
+    if (pressed == button_pressed) {
+        return;
+    }
+    button_pressed = pressed;
+
+    if (pressed) {
+        button_press_start_us = button_edge_us;
+        int64_t remaining_us = (int64_t)BOOT_BUTTON_LONG_PRESS_MS * 1000 - (esp_timer_get_time() - button_press_start_us);
+        esp_timer_start_once(button_long_press_timer, remaining_us > 0 ? remaining_us : 0);
+        ESP_LOGI(TAG, "BOOT button pressed - hold for 5 seconds to start Zigbee pairing");
+    } else {
+        esp_timer_stop(button_long_press_timer);
+        int64_t held_us = button_edge_us - button_press_start_us;
+        if (held_us < (int64_t)BOOT_BUTTON_LONG_PRESS_MS * 1000) {
+            ESP_LOGI(TAG, "BOOT button released (%dms)", (int)(held_us / 1000));
+        }
+    }
+}
+
+/**
+ * @brief Long press elapsed: start manual Zigbee pairing
+ * 
+ * The device will:
  * - Leave current network if already paired
  * - Start network steering to join a new coordinator
  * - Appear in Zigbee2MQTT for pairing
+ */
+static void boot_button_long_press_cb(void *arg)
+{
+    if (gpio_get_level(BOOT_BUTTON_GPIO) != 0) {
+        return;
+    }
+    ESP_LOGW(TAG, "BOOT button long press detected - requesting manual pairing now");
+    handle_manual_pairing_request();
+}
+
+/**
+ * @brief Watch the BOOT button (GPIO9) for a 5 second long press
  * 
- * @param pvParameters Unused FreeRTOS task parameter
+ * Event-driven: an any-edge interrupt plus two one-shot esp_timers
+ * (debounce, long press), so nothing wakes up while the button is idle
+ * and the hold time is measured from the edge instead of a 100 ms poll.
  * 
- * @note Long press duration: 5 seconds
- * @note Button is active LOW (pressed = 0)
- * @note Checks button state every 100ms
+ * @note Button is active LOW (pressed = 0); GPIO must already be configured
+ *       as input with pull-up and GPIO_INTR_ANYEDGE
  */
-static void boot_button_monitor_task(void *pvParameters)
+static void boot_button_start(void)
 {
-    const uint32_t LONG_PRESS_TIME_MS = 5000;  // 5 seconds
-    const uint32_t CHECK_INTERVAL_MS = 100;     // Check every 100ms
-    uint32_t press_duration = 0;
-    bool was_pressed = false;
-    bool pairing_triggered = false;
-    
-    while (1) {
-        // Read BOOT button state (GPIO9, active LOW)
-        int button_state = gpio_get_level(BOOT_BUTTON_GPIO);
-        
-        if (button_state == 0) {  // Button pressed
-            if (!was_pressed) {
-                was_pressed = true;
-                press_duration = 0;
-                pairing_triggered = false;
-                ESP_LOGI(TAG, "BOOT button pressed - hold for 5 seconds to start Zigbee pairing");
-            }
-            
-            press_duration += CHECK_INTERVAL_MS;
-            
-            // Check if button was held long enough
-            if (!pairing_triggered && press_duration >= LONG_PRESS_TIME_MS) {
-                pairing_triggered = true;
-                ESP_LOGW(TAG, "BOOT button long press detected - requesting manual pairing now");
-                handle_manual_pairing_request();
+    const esp_timer_create_args_t debounce_args = {
+        .callback = boot_button_debounce_cb,
+        .name = "btn_debounce",
+    };
+    const esp_timer_create_args_t long_press_args = {
+        .callback = boot_button_long_press_cb,
+        .name = "btn_long_press",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&debounce_args, &button_debounce_timer));
+    ESP_ERROR_CHECK(esp_timer_create(&long_press_args, &button_long_press_timer));
+
+    esp_err_t err = gpio_install_isr_service(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {   // INVALID_STATE: already installed
+        ESP_ERROR_CHECK(err);
+    }
+    ESP_ERROR_CHECK(gpio_isr_handler_add(BOOT_BUTTON_GPIO, boot_button_isr, NULL));
+
+    // Held since boot: no edge will come, start timing now
+    if (gpio_get_level(BOOT_BUTTON_GPIO) == 0) {
+        button_edge_us = esp_timer_get_time();
+        boot_button_debounce_cb(NULL);
+    }
+}
+
+/**
+ * @brief Send all current readings in one packed frame (cluster 0xFC00)
+ * 
+ * Replaces one ZCL report per sensor endpoint with a single manufacturer-specific
+ * attribute report carrying every sensor value (REPORT_FRAME_TYPE_READINGS).
+ * 
+ * @param values Centidegrees per sensor slot (REPORT_FRAME_VALUE_INVALID if no reading)
+ * @param count Number of sensor slots
+ * @return true if the stack accepted the report; false if the frame could not be
+ *         encoded (counted as report failure) or the send failed
+ * 
+ * @note Acquires Zigbee lock during attribute update and report transmission
+ */
+static bool send_packed_readings(const int16_t *values, uint8_t count)
+{
+    // Octet string attribute: first byte is payload length
+    uint8_t attr_value[REPORT_FRAME_MAX_LEN + 1];
+    size_t len = report_frame_encode_readings(&attr_value[1], REPORT_FRAME_MAX_LEN, packed_frame_seq++, values, count);
+    if (len == 0) {
+        DIAG_INC(report_request_failures);
+        ESP_LOGW(TAG, "Packed readings frame encode failed (%u sensors)", (unsigned)count);
+        return false;
+    }
+    attr_value[0] = (uint8_t)len;
+
+    esp_zb_lock_acquire(portMAX_DELAY);
+
+    esp_zb_zcl_set_attribute_val(ESP_TEMP_SENSOR_ENDPOINT_1,
+                                 ZB_THERMO_EXT_CLUSTER_ID,
+                                 ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 ZB_THERMO_EXT_ATTR_PACKED_READINGS,
+                                 attr_value,
+                                 false);
+
+    esp_err_t report_status = send_attribute_report(ESP_TEMP_SENSOR_ENDPOINT_1, ZB_THERMO_EXT_CLUSTER_ID,
+                                                    ZB_THERMO_EXT_ATTR_PACKED_READINGS);
+
+    esp_zb_lock_release();
+
+    if (report_status != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to send packed readings frame (%s)", esp_err_to_name(report_status));
+    } else if (BOOT_MARK(BOOT_PHASE_FIRST_REPORT)) {
+        publish_boot_profile();
+    }
+    return report_status == ESP_OK;
+}
+
+/**
+ * @brief Readings of the cycle being sent (report_cycle_sink_t argument)
+ */
+typedef struct {
+    const report_reason_t *reasons;
+    const float *temps;
+    const int16_t *values;
+} cycle_readings_t;
+
+static bool cycle_send_packed(const int16_t *values, uint8_t count, void *arg)
+{
+    (void)arg;
+    return send_packed_readings(values, count);
+}
+
+static void cycle_send_standard(uint8_t sensor, bool send_report, void *arg)
+{
+    const cycle_readings_t *r = arg;
+    SENSOR_LOG(DLOG_MSG_REPORT, sensor, r->reasons[sensor], r->values[sensor]);
+    update_temperature_attribute(SENSOR_ENDPOINT_BASE + sensor, r->temps[sensor], send_report);
+}
+
+/**
+ * @brief Send the reports decided for this cycle (report_cycle_send() with report_mode)
+ * 
+ * @param reasons Per sensor: report reason (REPORT_REASON_NONE = skip)
+ * @param temps Per sensor: reading (°C)
+ * @param values Per sensor: reading in centidegrees (REPORT_FRAME_VALUE_INVALID if none)
+ */
+static void send_cycle_reports(const report_reason_t *reasons, const float *temps, const int16_t *values)
+{
+    cycle_readings_t readings = { .reasons = reasons, .temps = temps, .values = values };
+    const report_cycle_sink_t sink = {
+        .send_packed = cycle_send_packed,
+        .send_standard = cycle_send_standard,
+        .arg = &readings,
+    };
+
+    report_cycle_send((report_mode_t)report_mode, reasons, values, sensor_count, &sink);
+}
+
+#if !SLEEPY_END_DEVICE
+/* Router variant: continuous sensor loop with hot-plug rescans and periodic diagnostics */
+
+/**
+ * @brief Log CPU accounting of the last stats interval and publish it as attributes
+ * 
+ * @param interval_us Wall time since the previous call
+ */
+static void publish_cpu_account(uint64_t interval_us)
+{
+    cpu_account_stats_t total;
+    static uint64_t last_busy_us;
+
+    cpu_account_log(interval_us);
+#ifdef CONFIG_PM_PROFILING
+    esp_pm_dump_locks(stdout);      // Time per frequency mode and per PM lock since boot
+#endif
+    cpu_account_get_total(&total);
+
+    uint64_t busy_us = total.total_us[CPU_ACCOUNT_BUSY_WAIT] - last_busy_us;
+    last_busy_us = total.total_us[CPU_ACCOUNT_BUSY_WAIT];
+    cpu_busy_permille = interval_us ? (uint16_t)(busy_us * 1000 / interval_us) : 0;
+    cpu_suspend_max_us = total.max_us[CPU_ACCOUNT_SUSPENDED];
+    cpu_account_reset_max();
+
+    ESP_LOGI(TAG, "Sensor CPU: busy-wait %u.%u%%, longest suspended window %uus",
+             (unsigned)(cpu_busy_permille / 10), (unsigned)(cpu_busy_permille % 10), (unsigned)cpu_suspend_max_us);
+
+    esp_zb_lock_acquire(portMAX_DELAY);
+    esp_zb_zcl_set_attribute_val(ESP_TEMP_SENSOR_ENDPOINT_1, ZB_THERMO_EXT_CLUSTER_ID, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 ZB_THERMO_EXT_ATTR_CPU_BUSY, &cpu_busy_permille, false);
+    esp_zb_zcl_set_attribute_val(ESP_TEMP_SENSOR_ENDPOINT_1, ZB_THERMO_EXT_CLUSTER_ID, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 ZB_THERMO_EXT_ATTR_SUSPEND_MAX, &cpu_suspend_max_us, false);
+    esp_zb_lock_release();
+}
+
+/**
+ * @brief Copy diagnostic counters into the Diagnostics and 0xFC00 attributes
+ * 
+ * Counters are plain increments on the hot path (diag_counters, ds18b20
+ * stats); attributes are refreshed once per stats interval, and the stack
+ * reports them to bound clients according to their reporting configuration.
+ */
+static void publish_diagnostics(void)
+{
+    uint32_t report_fails = diag_counters.report_request_failures + diag_counters.aps_send_failures;
+    uint32_t heap_free_min = esp_get_minimum_free_heap_size();
+    uint16_t stack_sensor = (uint16_t)uxTaskGetStackHighWaterMark(sensor_task_handle);
+    uint16_t stack_zigbee = zb_task_handle ? (uint16_t)uxTaskGetStackHighWaterMark(zb_task_handle) : 0;
+    uint16_t aps_ok = (uint16_t)diag_counters.aps_send_ok;
+    uint16_t aps_fail = (uint16_t)diag_counters.aps_send_failures;
+    tlog_stats_t log_stats;
+    tlog_get_stats(&log_stats);
+
+    ESP_LOGI(TAG, "Diagnostics: heap min %u, stack free sensor %u / zigbee %u, report failures %u",
+             (unsigned)heap_free_min, stack_sensor, stack_zigbee, (unsigned)report_fails);
+    ESP_LOGI(TAG, "Flash log: %u records, %u blocks / %u bytes programmed, %u of %u sectors erased",
+             (unsigned)log_stats.records_appended, (unsigned)log_stats.blocks_written,
+             (unsigned)log_stats.bytes_programmed, (unsigned)log_stats.sectors_erased, (unsigned)log_stats.sector_count);
+
+    esp_zb_lock_acquire(portMAX_DELAY);
+    esp_zb_zcl_set_attribute_val(ESP_TEMP_SENSOR_ENDPOINT_1, ESP_ZB_ZCL_CLUSTER_ID_DIAGNOSTICS, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 ZB_DIAG_ATTR_APS_TX_UCAST_SUCCESS, &aps_ok, false);
+    esp_zb_zcl_set_attribute_val(ESP_TEMP_SENSOR_ENDPOINT_1, ESP_ZB_ZCL_CLUSTER_ID_DIAGNOSTICS, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 ZB_DIAG_ATTR_APS_TX_UCAST_FAIL, &aps_fail, false);
+    esp_zb_zcl_set_attribute_val(ESP_TEMP_SENSOR_ENDPOINT_1, ZB_THERMO_EXT_CLUSTER_ID, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 ZB_THERMO_EXT_ATTR_REPORT_FAILS, &report_fails, false);
+    esp_zb_zcl_set_attribute_val(ESP_TEMP_SENSOR_ENDPOINT_1, ZB_THERMO_EXT_CLUSTER_ID, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 ZB_THERMO_EXT_ATTR_HEAP_FREE_MIN, &heap_free_min, false);
+    esp_zb_zcl_set_attribute_val(ESP_TEMP_SENSOR_ENDPOINT_1, ZB_THERMO_EXT_CLUSTER_ID, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 ZB_THERMO_EXT_ATTR_STACK_SENSOR, &stack_sensor, false);
+    esp_zb_zcl_set_attribute_val(ESP_TEMP_SENSOR_ENDPOINT_1, ZB_THERMO_EXT_CLUSTER_ID, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 ZB_THERMO_EXT_ATTR_STACK_ZIGBEE, &stack_zigbee, false);
+    esp_zb_zcl_set_attribute_val(ESP_TEMP_SENSOR_ENDPOINT_1, ZB_THERMO_EXT_CLUSTER_ID, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 ZB_THERMO_EXT_ATTR_LOG_RECORDS, &log_stats.records_appended, false);
+    esp_zb_zcl_set_attribute_val(ESP_TEMP_SENSOR_ENDPOINT_1, ZB_THERMO_EXT_CLUSTER_ID, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 ZB_THERMO_EXT_ATTR_LOG_ERASES, &log_stats.sectors_erased, false);
+    esp_zb_zcl_set_attribute_val(ESP_TEMP_SENSOR_ENDPOINT_1, ZB_THERMO_EXT_CLUSTER_ID, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 ZB_THERMO_EXT_ATTR_LOG_BYTES, &log_stats.bytes_programmed, false);
+
+    for (uint8_t i = 0; i < sensor_count; i++) {
+        ds18b20_stats_t st = sensors[i].dev.stats;
+        uint8_t endpoint = SENSOR_ENDPOINT_BASE + i;
+        esp_zb_zcl_set_attribute_val(endpoint, ZB_THERMO_EXT_CLUSTER_ID, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                     ZB_THERMO_EXT_ATTR_CRC_ERRORS, &st.crc_errors, false);
+        esp_zb_zcl_set_attribute_val(endpoint, ZB_THERMO_EXT_CLUSTER_ID, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                     ZB_THERMO_EXT_ATTR_PRESENCE_FAILS, &st.presence_failures, false);
+        esp_zb_zcl_set_attribute_val(endpoint, ZB_THERMO_EXT_CLUSTER_ID, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                     ZB_THERMO_EXT_ATTR_READ_RETRIES, &st.retries, false);
+        esp_zb_zcl_set_attribute_val(endpoint, ZB_THERMO_EXT_CLUSTER_ID, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                     ZB_THERMO_EXT_ATTR_LAST_CONV_MS, &st.last_conversion_ms, false);
+    }
+    esp_zb_lock_release();
+
+    for (uint8_t i = 0; i < sensor_count; i++) {
+        const ds18b20_stats_t *st = &sensors[i].dev.stats;
+        ESP_LOGI(TAG, "Sensor %u: CRC errors %u, presence failures %u, retries %u, bus timeouts %u, last conversion %ums",
+                 i + 1, (unsigned)st->crc_errors, (unsigned)st->presence_failures, (unsigned)st->retries,
+                 (unsigned)st->bus_timeouts, st->last_conversion_ms);
+    }
+}
+
+#if !USE_SKIP_ROM_MODE
+/**
+ * @brief Attach sensor found by a rescan to the sensor table
+ * 
+ * A known ROM returns to its previous slot (same endpoint as before). A new
+ * ROM takes the first unassigned slot, or else the slot of an unplugged
+ * sensor, so replacing a probe keeps its endpoint.
+ * 
+ * @param rom 8-byte ROM code of a DS18B20
+ */
+static void sensor_attach(const uint8_t *rom)
+{
+    int free_slot = -1;
+    int absent_slot = -1;
+
+    for (uint8_t i = 0; i < SENSOR_MAX_COUNT; i++) {
+        sensor_slot_t *slot = &sensors[i];
+        if (slot->found && memcmp(slot->dev.rom, rom, 8) == 0) {
+            slot->misses = 0;
+            if (!slot->present) {
+                sensor_slot_set(i, NULL, true);
+                ESP_LOGI(TAG, "Sensor %u reconnected", i + 1);
             }
-        } else {  // Button released
-            if (was_pressed && press_duration < LONG_PRESS_TIME_MS) {
-                ESP_LOGI(TAG, "BOOT button released (%.1f seconds)", press_duration / 1000.0f);
+            return;
+        }
+        if (!slot->found && free_slot < 0) {
+            free_slot = i;
+        } else if (slot->found && !slot->present && absent_slot < 0) {
+            absent_slot = i;
+        }
+    }
+
+    int i = free_slot >= 0 ? free_slot : absent_slot;
+    if (i < 0) {
+        ESP_LOGW(TAG, "New sensor %02X:...:%02X ignored - all %d slots in use", rom[0], rom[7], SENSOR_MAX_COUNT);
+        return;
+    }
+
+    ds18b20_device_t dev;
+    ds18b20_init(&dev, &onewire_bus, rom);
+    sensor_slot_set(i, &dev, true);
+    report_policy_forget(&report_policy, i);
+    rescan.search_due = true;       // Several probes are often plugged in at once
+    ESP_LOGI(TAG, "Sensor %d added - ROM: %02X:%02X:%02X:%02X:%02X:%02X:%02X:%02X", i + 1,
+             rom[0], rom[1], rom[2], rom[3], rom[4], rom[5], rom[6], rom[7]);
+}
+
+/**
+ * @brief Run one rescan bus step (one transaction)
+ * @return true if a step ran (bus time was used)
+ */
+static bool sensor_rescan_step(void)
+{
+    if (onewire_bus_acquire(&onewire_bus, ONEWIRE_BUS_PRIO_BACKGROUND, DS18B20_BUS_TIMEOUT_MS) != ESP_OK) {
+        return false;
+    }
+
+    int64_t start = esp_timer_get_time();
+
+    if (rescan.phase == RESCAN_PHASE_VERIFY) {
+        while (rescan.index < sensor_count && !sensors[rescan.index].found) {
+            rescan.index++;
+        }
+        if (rescan.index < sensor_count) {
+            sensor_slot_t *slot = &sensors[rescan.index];
+            vTaskSuspendAll();
+            bool present = onewire_bus_verify_rom(&onewire_bus, slot->dev.rom);
+            xTaskResumeAll();
+
+            if (present) {
+                slot->misses = 0;
+                if (!slot->present) {
+                    sensor_slot_set(rescan.index, NULL, true);
+                    ESP_LOGI(TAG, "Sensor %u reconnected", rescan.index + 1);
+                }
+            } else if (slot->present && ++slot->misses >= RESCAN_MISS_LIMIT) {
+                sensor_slot_set(rescan.index, NULL, false);
+                rescan.search_due = true;   // Probe may have been replaced by one with a new ROM
+                ESP_LOGW(TAG, "Sensor %u removed (no answer to ROM verification)", rescan.index + 1);
             }
-            was_pressed = false;
-            pairing_triggered = false;
-            press_duration = 0;
+            rescan.index++;
+        }
+        if (rescan.index >= sensor_count) {
+            rescan.phase = rescan.full ? RESCAN_PHASE_SEARCH : RESCAN_PHASE_IDLE;
+            onewire_bus_search_reset(&rescan.search);
+        }
+    } else {
+        uint8_t rom[8];
+        vTaskSuspendAll();
+        bool found = onewire_bus_search_next(&onewire_bus, &rescan.search, rom);
+        xTaskResumeAll();
+
+        if (found && rom[0] == 0x28 && onewire_bus_crc8(rom, 7) == rom[7]) {
+            sensor_attach(rom);
+        }
+        if (!found || rescan.search.last_device_flag) {
+            rescan.phase = RESCAN_PHASE_IDLE;
+        }
+    }
+
+    onewire_bus_release(&onewire_bus);
+    bus_budget_charge(&rescan.budget, esp_timer_get_time() - start);
+    return true;
+}
+
+/**
+ * @brief Advance background rescan as far as the bus-time budget allows
+ * 
+ * Every RESCAN_INTERVAL_MS a round verifies each known ROM with a targeted
+ * search (one pass per sensor instead of walking the whole search tree);
+ * every RESCAN_FULL_EVERY rounds, and in the round after a sensor was
+ * removed or added, a full search looks for new devices; a console
+ * rescan request (SENSOR_NOTIFY_RESCAN) starts a full round at once. Steps run only
+ * while the token bucket holds credit, which caps rescans at
+ * RESCAN_BUS_PERMILLE of bus time.
+ */
+static void sensor_rescan_poll(void)
+{
+    int64_t now = esp_timer_get_time();
+    if (rescan.phase == RESCAN_PHASE_IDLE) {
+        if (now < rescan.next_round_us && !rescan.requested) {
+            return;
+        }
+        rescan.next_round_us = now + (int64_t)RESCAN_INTERVAL_MS * 1000;
+        rescan.round++;
+        rescan.index = 0;
+        rescan.phase = RESCAN_PHASE_VERIFY;
+        rescan.full = rescan.requested || rescan.search_due || rescan.round % RESCAN_FULL_EVERY == 0;
+        rescan.requested = false;
+        rescan.search_due = false;
+    }
+
+    while (rescan.phase != RESCAN_PHASE_IDLE &&
+           bus_budget_allow(&rescan.budget, esp_timer_get_time(), RESCAN_STEP_COST_US)) {
+        if (!sensor_rescan_step()) {
+            break;
+        }
+    }
+}
+#else
+static void sensor_rescan_poll(void)
+{
+    // Single sensor addressed with SKIP ROM: nothing to verify or search
+}
+#endif // !USE_SKIP_ROM_MODE
+
+/**
+ * @brief Run out-of-cycle conversions requested by stale Read Attributes
+ * 
+ * One conversion per marked sensor, no matter how many reads arrived; the
+ * fresh value is written to the attribute and reported right away.
+ */
+static void serve_read_refreshes(void)
+{
+    uint32_t pending = reading_cache_pending();
+
+    for (uint8_t i = 0; i < sensor_count; i++) {
+        if (!(pending & (1u << i))) {
+            continue;
+        }
+        if (!sensors[i].present) {
+            reading_cache_cancel_refresh(i);
+            continue;
+        }
+
+        float temp;
+        if (ds18b20_get_temperature(&sensors[i].dev, ONEWIRE_BUS_PRIO_ON_DEMAND, &temp) != ESP_OK) {
+            reading_cache_cancel_refresh(i);
+            ESP_LOGW(TAG, "Sensor %u: On-demand refresh failed", i + 1);
+            continue;
+        }
+
+        int16_t value = (int16_t)(temp * 100);
+        SENSOR_LOG(DLOG_MSG_REFRESH, i, value);
+        update_temperature_attribute(SENSOR_ENDPOINT_BASE + i, temp, true);
+        report_policy_mark_reported(&report_policy, i, temp, pdTICKS_TO_MS(xTaskGetTickCount()));
+    }
+}
+
+/**
+ * @brief Sleep until the next cycle, serving refresh requests meanwhile
+ * @param delay_ms Time until the next measurement cycle
+ */
+static void sensor_task_wait(uint32_t delay_ms)
+{
+    TickType_t start = xTaskGetTickCount();
+    TickType_t period = pdMS_TO_TICKS(delay_ms);
+    TickType_t elapsed;
+
+    while ((elapsed = xTaskGetTickCount() - start) < period) {
+        uint32_t bits = 0;
+        if (xTaskNotifyWait(0, UINT32_MAX, &bits, period - elapsed) != pdTRUE) {
+            continue;
+        }
+        if (bits & SENSOR_NOTIFY_REFRESH) {
+            serve_read_refreshes();
+        }
+        if (bits & SENSOR_NOTIFY_RESCAN) {
+            rescan.requested = true;
+            sensor_rescan_poll();
         }
-        
-        vTaskDelay(pdMS_TO_TICKS(CHECK_INTERVAL_MS));
     }
 }
 
@@ -561,105 +1762,976 @@ static void boot_button_monitor_task(void *pvParameters)
  * @brief Task to read temperature and report via Zigbee
  * 
  * Periodically reads temperature from detected DS18B20 sensors and decides
- * whether to report based on:
+ * whether to report (report_policy.c) based on:
  * - Initial report: First reading after startup
  * - Threshold report: Temperature changed by ≥1°C
  * - Periodic report: Maximum interval elapsed (1 minute)
- * - Peer sync: One sensor triggered report, sync the other
+ * - Peer sync: One sensor triggered report, sync all others
+ * 
+ * Depending on report_mode, a report is sent as one packed frame with all
+ * sensors (cluster 0xFC00), as standard per-endpoint reports, or both.
+ * 
+ * Every successful reading is also stored in the RAM history (temp_history)
+ * and the flash log (tlog), independent of network state, so data taken
+ * while offline survives both coordinator outages and reboots. Readings
+ * taken while not joined are queued and backfilled after rejoin.
+ * 
+ * Between cycles the task serves out-of-cycle refreshes requested by stale
+ * Read Attributes (see zb_raw_command_handler()) and advances the rate-limited
+ * hot-plug rescan (see sensor_rescan_poll()).
  * 
  * @param pvParameters Unused FreeRTOS task parameter
  * 
- * @note Runs every 5 seconds
- * @note Both sensors are synchronized to report together when one triggers
+ * Loop phase, loop period and periodic refresh interval are jittered per
+ * device (report_scheduler, seeded from the IEEE address), so routers that
+ * powered on together do not sample and report in lockstep.
+ * 
+ * @note Runs every 5 seconds (± jitter)
+ * @note All sensors are synchronized to report together when one triggers
  */
 static void temperature_sensor_task(void *pvParameters)
 {
+    uint8_t ieee_addr[8];
+    ESP_ERROR_CHECK(esp_read_mac(ieee_addr, ESP_MAC_IEEE802154));
+    report_scheduler_init(&report_sched, ieee_addr, SENSOR_LOOP_PERIOD_MS, TEMP_MAX_REPORT_INTERVAL_MS);
+    
+    uint32_t refresh_interval_ms = report_scheduler_next_interval_ms(&report_sched);
+    uint32_t initial_delay_ms = report_scheduler_initial_delay_ms(&report_sched);
+    uint32_t cycle = 0;
+    int64_t stats_start_us = esp_timer_get_time();
+
+    // Discovery runs while the Zigbee stack starts and counts against the report phase delay
+    report_policy_init(&report_policy, TEMP_REPORT_THRESHOLD);
+    discover_sensors();
+    uint32_t discovery_ms = (uint32_t)((esp_timer_get_time() - stats_start_us) / 1000);
+    
+    bus_budget_init(&rescan.budget, RESCAN_BUS_PERMILLE, 4 * RESCAN_STEP_COST_US, esp_timer_get_time());
+    rescan.next_round_us = esp_timer_get_time() + (int64_t)RESCAN_INTERVAL_MS * 1000;
+    
+    ESP_LOGI(TAG, "Report schedule: phase %ums (discovery took %ums), first refresh interval %ums",
+             (unsigned)initial_delay_ms, (unsigned)discovery_ms, (unsigned)refresh_interval_ms);
+    sensor_task_wait(initial_delay_ms > discovery_ms ? initial_delay_ms - discovery_ms : 0);
+    
     while (1) {
-        float temp1 = NAN;
-        float temp2 = NAN;
-        bool sensor1_ok = false;
-        bool sensor2_ok = false;
-
-        if (sensor1_found) {
-            if (ds18b20_get_temperature(&sensor1, &temp1) == ESP_OK) {
-                sensor1_ok = true;
-                ESP_LOGI(TAG, "Sensor 1: %.2f°C", temp1);
+        float temps[SENSOR_MAX_COUNT];
+        bool ok[SENSOR_MAX_COUNT] = {false};
+        int16_t values[SENSOR_MAX_COUNT];
+        cpu_account_stats_t cycle_start, cycle_end;
+
+        cpu_account_get(NULL, &cycle_start);
+
+        for (uint8_t i = 0; i < sensor_count; i++) {
+            temps[i] = NAN;
+            values[i] = REPORT_FRAME_VALUE_INVALID;
+            if (!sensors[i].present) {
+                continue;
+            }
+            if (ds18b20_get_temperature(&sensors[i].dev, ONEWIRE_BUS_PRIO_PERIODIC, &temps[i]) == ESP_OK) {
+                ok[i] = true;
+                BOOT_MARK(BOOT_PHASE_FIRST_READING);
+                values[i] = (int16_t)(temps[i] * 100);
+                temp_history_add(i, tlog_time_now(), values[i]);
+                SENSOR_LOG(DLOG_MSG_READING, i, values[i]);
             } else {
-                ESP_LOGW(TAG, "Sensor 1: Failed to read temperature");
+                ESP_LOGW(TAG, "Sensor %u: Failed to read temperature", i + 1);
+#if ONEWIRE_TRACE_ENABLED
+                if (!onewire_trace_dumped &&
+                    onewire_bus_acquire(&onewire_bus, ONEWIRE_BUS_PRIO_BACKGROUND, DS18B20_BUS_TIMEOUT_MS) == ESP_OK) {
+                    onewire_bus_trace_dump(&onewire_bus);
+                    onewire_bus_release(&onewire_bus);
+                    onewire_trace_dumped = true;
+                }
+#endif
             }
         }
 
-        if (sensor2_found) {
-            if (ds18b20_get_temperature(&sensor2, &temp2) == ESP_OK) {
-                sensor2_ok = true;
-                ESP_LOGI(TAG, "Sensor 2: %.2f°C", temp2);
+        if (sensor_count > 0) {
+            // Persist cycle to flash log (batched in RAM, programmed per 256-byte block)
+            tlog_record_t record = {
+                .time_s = tlog_time_now(),
+                .sensor_count = sensor_count,   // <= TLOG_MAX_SENSORS, checked at compile time
+            };
+            memcpy(record.values, values, record.sensor_count * sizeof(int16_t));
+            esp_err_t log_err = tlog_append(&record);
+            if (log_err != ESP_OK && log_err != ESP_ERR_INVALID_STATE) {
+                ESP_LOGW(TAG, "Failed to append flash log record (%s)", esp_err_to_name(log_err));
+            }
+
+            // Queue for backfill instead of dropping it while offline
+            if (!network_connected) {
+                backfill_push(record.time_s, values, sensor_count);
             } else {
-                ESP_LOGW(TAG, "Sensor 2: Failed to read temperature");
+                backfill_skip(record.time_s);
             }
+            backfill_ack_save_poll();
         }
 
-        TickType_t now = xTaskGetTickCount();
-        TickType_t interval_ticks = pdMS_TO_TICKS(TEMP_MAX_REPORT_INTERVAL_MS);
-
-        bool can_publish1 = network_connected && sensor1_ok;
-        bool first1 = can_publish1 && isnan(last_temp1);
-        bool threshold1 = can_publish1 && !first1 && fabsf(temp1 - last_temp1) >= TEMP_REPORT_THRESHOLD;
-        bool interval1 = can_publish1 && last_report_tick1 && (now - last_report_tick1 >= interval_ticks);
-        bool publish1 = can_publish1 && (first1 || threshold1 || interval1);
-
-        bool can_publish2 = network_connected && sensor2_ok;
-        bool first2 = can_publish2 && isnan(last_temp2);
-        bool threshold2 = can_publish2 && !first2 && fabsf(temp2 - last_temp2) >= TEMP_REPORT_THRESHOLD;
-        bool interval2 = can_publish2 && last_report_tick2 && (now - last_report_tick2 >= interval_ticks);
-        bool publish2 = can_publish2 && (first2 || threshold2 || interval2);
-
-        bool sync1 = can_publish1 && !publish1 && publish2;
-        bool sync2 = can_publish2 && !publish2 && publish1;
-
-        if (publish1 || sync1) {
-            const char *reason;
-            if (threshold1) {
-                reason = "Temperature changed";
-            } else if (first1) {
-                reason = "Initial report";
-            } else if (interval1) {
-                reason = "Periodic refresh";
-            } else {
-                reason = "Peer sync";
+        report_reason_t reasons[SENSOR_MAX_COUNT];
+        if (report_policy_decide(&report_policy, pdTICKS_TO_MS(xTaskGetTickCount()), refresh_interval_ms,
+                                 network_connected, ok, temps, sensor_count, reasons)) {
+            send_cycle_reports(reasons, temps, values);
+            refresh_interval_ms = report_scheduler_next_interval_ms(&report_sched);
+        }
+
+        cpu_account_get(NULL, &cycle_end);
+        ESP_LOGD(TAG, "Cycle CPU: busy-wait %uus, suspended %uus, conversion wait %ums",
+                 (unsigned)(cycle_end.total_us[CPU_ACCOUNT_BUSY_WAIT] - cycle_start.total_us[CPU_ACCOUNT_BUSY_WAIT]),
+                 (unsigned)(cycle_end.total_us[CPU_ACCOUNT_SUSPENDED] - cycle_start.total_us[CPU_ACCOUNT_SUSPENDED]),
+                 (unsigned)((cycle_end.total_us[CPU_ACCOUNT_CONVERSION_WAIT] -
+                             cycle_start.total_us[CPU_ACCOUNT_CONVERSION_WAIT]) / 1000));
+
+        if (++cycle % REPORT_STATS_LOG_CYCLES == 0) {
+            ESP_LOGI(TAG, "Report stats: requests %u (rejected %u), APS ok %u, APS failed %u",
+                     (unsigned)diag_counters.report_requests, (unsigned)diag_counters.report_request_failures,
+                     (unsigned)diag_counters.aps_send_ok, (unsigned)diag_counters.aps_send_failures);
+
+            onewire_bus_stats_t bus_stats;
+            onewire_bus_get_stats(&onewire_bus, &bus_stats);
+            for (int p = 0; p < ONEWIRE_BUS_PRIO_COUNT; p++) {
+                ESP_LOGI(TAG, "Bus prio %d: %u acquisitions, %u timeouts, max wait %uus", p,
+                         (unsigned)bus_stats.acquisitions[p], (unsigned)bus_stats.timeouts[p],
+                         (unsigned)bus_stats.max_wait_us[p]);
             }
-            ESP_LOGI(TAG, "Sensor 1: %s at %.2f°C", reason, temp1);
-            update_temperature_attribute(ESP_TEMP_SENSOR_ENDPOINT_1, temp1);
-            last_temp1 = temp1;
-            last_report_tick1 = now;
-        }
-
-        if (publish2 || sync2) {
-            const char *reason;
-            if (threshold2) {
-                reason = "Temperature changed";
-            } else if (first2) {
-                reason = "Initial report";
-            } else if (interval2) {
-                reason = "Periodic refresh";
-            } else {
-                reason = "Peer sync";
+
+            onewire_bus_line_stats_t line_stats;
+            onewire_bus_get_line_stats(&onewire_bus, &line_stats);
+            ESP_LOGI(TAG, "Bus line: %u read slots, %u noisy, %u outvoted samples",
+                     (unsigned)line_stats.read_bits, (unsigned)line_stats.noisy_bits,
+                     (unsigned)line_stats.minority_samples);
+#if ONEWIRE_TRACE_ENABLED
+            onewire_trace_dumped = false;
+#endif
+
+            int64_t now_us = esp_timer_get_time();
+            publish_cpu_account((uint64_t)(now_us - stats_start_us));
+            publish_diagnostics();
+            stats_start_us = now_us;
+        }
+
+        sensor_rescan_poll();
+        sensor_task_wait(report_scheduler_next_loop_delay_ms(&report_sched));
+    }
+}
+#endif
+
+#if DLOG_MODE != DLOG_MODE_OFF
+/**
+ * @brief Print and empty the deferred log ring
+ * 
+ * Deferred mode formats each record with its original timestamp; raw mode
+ * writes "DLOG <hex>" lines for `host/dlog_decode monitor.log`, so the
+ * device does no formatting at all. Drops (ring full) are reported once.
+ */
+static void dlog_drain(void)
+{
+    static uint32_t reported_drops = 0;
+    dlog_record_t rec;
+
+    while (dlog_read(&rec)) {
+#if DLOG_MODE == DLOG_MODE_RAW
+        static const char digits[] = "0123456789abcdef";
+        uint8_t bin[DLOG_ENCODED_MAX_LEN];
+        char hex[2 * DLOG_ENCODED_MAX_LEN + 1];
+        size_t n = dlog_encode(&rec, bin);
+        for (size_t i = 0; i < n; i++) {
+            hex[2 * i] = digits[bin[i] >> 4];
+            hex[2 * i + 1] = digits[bin[i] & 0x0F];
+        }
+        hex[2 * n] = '\0';
+        ESP_LOGI(TAG, "DLOG %s", hex);
+#else
+        char line[96];
+        dlog_msg_format(&rec, line, sizeof(line));
+        ESP_LOGI(TAG, "[%u] %s", (unsigned)rec.time_ms, line);
+#endif
+    }
+
+    uint32_t drops = dlog_dropped();
+    if (drops != reported_drops) {
+        ESP_LOGW(TAG, "Deferred log: %u records dropped (ring full)", (unsigned)(drops - reported_drops));
+        reported_drops = drops;
+    }
+}
+
+#if !SLEEPY_END_DEVICE
+/**
+ * @brief Deferred log drain task (lowest application priority)
+ * 
+ * Empties the deferred log ring once per DLOG_DRAIN_PERIOD_MS. The sleepy
+ * variant drains once per wake instead, right before deep sleep.
+ */
+static void dlog_drain_task(void *pvParameters)
+{
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(DLOG_DRAIN_PERIOD_MS));
+        dlog_drain();
+    }
+}
+#endif
+#endif
+
+#if SLEEPY_END_DEVICE
+static void esp_zb_task(void *pvParameters);
+
+/**
+ * @brief Wall clock in ms for the report policy (RTC timer, keeps running in deep sleep)
+ */
+static uint32_t sleepy_clock_ms(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint32_t)((uint64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000);
+}
+
+/**
+ * @brief Restore the sensor table from RTC memory, or search the bus
+ * 
+ * The ROM search runs after a cold boot, after a failed read (sensor
+ * replaced or unplugged) and every SLEEPY_SEARCH_EVERY wakes. Slots whose
+ * ROM changed lose their report state, so the new sensor is reported.
+ * A SKIP ROM build has no ROMs to keep and re-initializes its sensor.
+ */
+static void sleepy_restore_sensors(void)
+{
+#if !USE_SKIP_ROM_MODE
+    if (!sleepy_cold_boot && !sleepy_rtc.search_pending && sleepy_rtc.wakes_since_search < SLEEPY_SEARCH_EVERY) {
+        for (uint8_t i = 0; i < sleepy_rtc.sensor_count; i++) {
+            ds18b20_device_t dev;
+            ds18b20_init(&dev, &onewire_bus, sleepy_rtc.roms[i]);
+            sensor_slot_set(i, &dev, true);
+        }
+        BOOT_MARK(BOOT_PHASE_SENSORS_FOUND);
+        return;
+    }
+#endif
+
+    discover_sensors();
+    for (uint8_t i = 0; i < sensor_count; i++) {
+        if (i >= sleepy_rtc.sensor_count || memcmp(sleepy_rtc.roms[i], sensors[i].dev.rom, 8) != 0) {
+            report_policy_forget(&report_policy, i);
+        }
+        memcpy(sleepy_rtc.roms[i], sensors[i].dev.rom, 8);
+    }
+    sleepy_rtc.sensor_count = sensor_count;
+    sleepy_rtc.search_pending = false;
+    sleepy_rtc.wakes_since_search = 0;
+}
+
+/**
+ * @brief Convert all sensors at once and read them after a light sleep
+ * 
+ * Sensors are externally powered and convert on their own, so the CPU
+ * sleeps through the 750 ms instead of idling with the clocks running.
+ */
+static void sleepy_read_sensors(float *temps, bool *ok, int16_t *values)
+{
+    for (uint8_t i = 0; i < sensor_count; i++) {
+        temps[i] = NAN;
+        ok[i] = false;
+        values[i] = REPORT_FRAME_VALUE_INVALID;
+    }
+    if (sensor_count == 0) {
+        return;
+    }
+    if (ds18b20_convert_all(&onewire_bus, ONEWIRE_BUS_PRIO_PERIODIC) != ESP_OK) {
+        sleepy_rtc.search_pending = true;
+        return;
+    }
+
+    int64_t conversion_start = esp_timer_get_time();
+    int64_t conversion_end = conversion_start + (int64_t)DS18B20_CONVERSION_MS * 1000;
+    esp_sleep_enable_timer_wakeup((uint64_t)DS18B20_CONVERSION_MS * 1000);
+    if (esp_light_sleep_start() != ESP_OK) {
+        ESP_LOGW(TAG, "Light sleep rejected, waiting for the conversion awake");
+    }
+    int64_t left_us = conversion_end - esp_timer_get_time();
+    if (left_us > 0) {
+        vTaskDelay(pdMS_TO_TICKS(left_us / 1000 + 1));
+    }
+    cpu_account_add(CPU_ACCOUNT_CONVERSION_WAIT, (uint32_t)(esp_timer_get_time() - conversion_start));
+
+    for (uint8_t i = 0; i < sensor_count; i++) {
+        if (ds18b20_read_temperature(&sensors[i].dev, ONEWIRE_BUS_PRIO_PERIODIC, &temps[i]) == ESP_OK) {
+            ok[i] = true;
+            BOOT_MARK(BOOT_PHASE_FIRST_READING);
+            values[i] = (int16_t)(temps[i] * 100);
+            SENSOR_LOG(DLOG_MSG_READING, i, values[i]);
+        } else {
+            ESP_LOGW(TAG, "Sensor %u: Failed to read temperature", i + 1);
+            sleepy_rtc.search_pending = true;
+        }
+    }
+}
+
+/**
+ * @brief Wait until joined (rejoin after wake, or pairing after cold boot)
+ * @param timeout_ms Give up after this time
+ * @return true if joined
+ */
+static bool sleepy_wait_network(uint32_t timeout_ms)
+{
+    TickType_t start = xTaskGetTickCount();
+
+    while (!network_connected && xTaskGetTickCount() - start < pdMS_TO_TICKS(timeout_ms)) {
+        vTaskDelay(pdMS_TO_TICKS(50));
+    }
+    return network_connected;
+}
+
+/**
+ * @brief Report the awake time of the previous cycle (attribute 0x0025)
+ */
+static void publish_awake_time(void)
+{
+    uint16_t awake_ms = sleepy_rtc.awake_last_ms;
+
+    esp_zb_lock_acquire(portMAX_DELAY);
+    esp_zb_zcl_set_attribute_val(ESP_TEMP_SENSOR_ENDPOINT_1, ZB_THERMO_EXT_CLUSTER_ID, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 ZB_THERMO_EXT_ATTR_AWAKE_MS, &awake_ms, false);
+    send_attribute_report(ESP_TEMP_SENSOR_ENDPOINT_1, ZB_THERMO_EXT_CLUSTER_ID, ZB_THERMO_EXT_ATTR_AWAKE_MS);
+    esp_zb_lock_release();
+}
+
+/**
+ * @brief Send the due reports and wait for their APS confirms
+ * @return true if no report was rejected or failed
+ */
+static bool sleepy_send_reports(const report_reason_t *reasons, const float *temps, const int16_t *values)
+{
+    diag_counters_t before = diag_counters;
+
+    publish_awake_time();
+    send_cycle_reports(reasons, temps, values);
+
+    uint32_t accepted = (diag_counters.report_requests - before.report_requests) -
+                        (diag_counters.report_request_failures - before.report_request_failures);
+    TickType_t start = xTaskGetTickCount();
+    while ((diag_counters.aps_send_ok - before.aps_send_ok) + (diag_counters.aps_send_failures - before.aps_send_failures) <
+               accepted &&
+           xTaskGetTickCount() - start < pdMS_TO_TICKS(SLEEPY_CONFIRM_TIMEOUT_MS)) {
+        vTaskDelay(pdMS_TO_TICKS(20));
+    }
+
+    return diag_counters.report_request_failures == before.report_request_failures &&
+           diag_counters.aps_send_failures == before.aps_send_failures;
+}
+
+/**
+ * @brief Log awake time statistics and enter deep sleep until the next sample
+ * @param radio Zigbee stack was started in this cycle
+ */
+static void sleepy_enter_deep_sleep(bool radio)
+{
+    uint32_t awake_ms = (uint32_t)(esp_timer_get_time() / 1000);
+
+#if DLOG_MODE != DLOG_MODE_OFF
+    dlog_drain();
+#endif
+    sleepy_rtc.policy = report_policy;
+    sleepy_rtc.magic = SLEEPY_RTC_MAGIC;
+    sleepy_rtc.cycles++;
+    sleepy_rtc.awake_last_ms = awake_ms > UINT16_MAX ? UINT16_MAX : (uint16_t)awake_ms;
+    if (sleepy_rtc.awake_last_ms > sleepy_rtc.awake_max_ms) {
+        sleepy_rtc.awake_max_ms = sleepy_rtc.awake_last_ms;
+    }
+    sleepy_rtc.awake_total_ms += awake_ms;
+
+    uint32_t sleep_ms = awake_ms + SLEEPY_MIN_SLEEP_MS < SLEEPY_PERIOD_MS ? SLEEPY_PERIOD_MS - awake_ms : SLEEPY_MIN_SLEEP_MS;
+    ESP_LOGI(TAG, "Cycle %u: awake %ums (%s), mean %ums, max %ums, radio in %u of %u cycles - sleeping %ums",
+             (unsigned)sleepy_rtc.cycles, (unsigned)awake_ms, radio ? "radio" : "sensors only",
+             (unsigned)(sleepy_rtc.awake_total_ms / sleepy_rtc.cycles), sleepy_rtc.awake_max_ms,
+             (unsigned)sleepy_rtc.radio_cycles, (unsigned)sleepy_rtc.cycles, (unsigned)sleep_ms);
+
+    esp_sleep_enable_timer_wakeup((uint64_t)sleep_ms * 1000);
+    esp_deep_sleep_start();
+}
+
+/**
+ * @brief One sleepy end-device cycle per wake (replaces temperature_sensor_task)
+ * 
+ * 1. Restore ROMs and report state from RTC memory (ROM search when needed)
+ * 2. Start one conversion on all sensors and light-sleep through it
+ * 3. Read, then decide with report_policy (threshold / SLEEPY_MAX_SILENT_MS)
+ * 4. Only if a report is due (or after a cold boot): start the Zigbee stack,
+ *    rejoin, send reports and wait for their confirms
+ * 5. Deep sleep for the rest of SLEEPY_PERIOD_MS
+ * 
+ * Reports that could not be delivered are forgotten by the policy, so the
+ * next wake reports them again. The awake time of every cycle is logged
+ * and reported with the next report (attribute 0x0025).
+ * 
+ * @param pvParameters Unused FreeRTOS task parameter
+ */
+static void sleepy_cycle_task(void *pvParameters)
+{
+    float temps[SENSOR_MAX_COUNT];
+    bool ok[SENSOR_MAX_COUNT];
+    int16_t values[SENSOR_MAX_COUNT];
+    report_reason_t reasons[SENSOR_MAX_COUNT];
+
+    if (sleepy_cold_boot) {
+        memset(&sleepy_rtc, 0, sizeof(sleepy_rtc));
+        sleepy_rtc.boot_count = boot_count;
+        report_policy_init(&report_policy, TEMP_REPORT_THRESHOLD);
+    } else {
+        report_policy = sleepy_rtc.policy;
+        sleepy_rtc.wakes_since_search++;
+    }
+
+    sleepy_restore_sensors();
+    sleepy_read_sensors(temps, ok, values);
+
+    bool due = report_policy_decide(&report_policy, sleepy_clock_ms(), SLEEPY_MAX_SILENT_MS, true, ok, temps,
+                                    sensor_count, reasons);
+    bool radio = due || sleepy_cold_boot;
+    if (radio) {
+        sleepy_rtc.radio_cycles++;
+        zb_task_handle = xTaskCreateStatic(esp_zb_task, "Zigbee_main", ZB_TASK_STACK_SIZE, NULL, 5,
+                                           zb_task_stack, &zb_task_tcb);
+
+        // A cold boot without a stored network stays awake for BOOT-button pairing
+        bool joined = sleepy_wait_network(sleepy_cold_boot ? SLEEPY_PAIRING_WINDOW_MS : SLEEPY_JOIN_TIMEOUT_MS);
+        if (due && !(joined && sleepy_send_reports(reasons, temps, values))) {
+            ESP_LOGW(TAG, "Reports not delivered (%s) - retrying on the next wake", joined ? "send failed" : "no network");
+            for (uint8_t i = 0; i < sensor_count; i++) {
+                if (reasons[i] != REPORT_REASON_NONE) {
+                    report_policy_forget(&report_policy, i);
+                }
             }
-            ESP_LOGI(TAG, "Sensor 2: %s at %.2f°C", reason, temp2);
-            update_temperature_attribute(ESP_TEMP_SENSOR_ENDPOINT_2, temp2);
-            last_temp2 = temp2;
-            last_report_tick2 = now;
         }
+    }
+
+    sleepy_enter_deep_sleep(radio);
+}
+#endif
+
+#if BENCH_CONSOLE_ENABLE
+static uint8_t console_sensor_count(void)
+{
+    return sensor_count_get();
+}
+
+static bool console_sensor_get(uint8_t slot, ds18b20_device_t *dev)
+{
+    bool valid = false;
+
+    if (slot < SENSOR_MAX_COUNT) {
+        portENTER_CRITICAL(&sensor_table_lock);
+        valid = sensors[slot].found && sensors[slot].present;
+        if (valid) {
+            *dev = sensors[slot].dev;
+        }
+        portEXIT_CRITICAL(&sensor_table_lock);
+    }
+    return valid;
+}
+
+static void console_rescan(void)
+{
+    xTaskNotify(sensor_task_handle, SENSOR_NOTIFY_RESCAN, eSetBits);
+}
+
+/* Static DRAM bounds from the IDF linker script */
+extern int _data_start, _data_end, _bss_start, _bss_end;
+
+/**
+ * @brief Configured stack of one of our tasks (0 = created elsewhere)
+ */
+static uint32_t mem_cmd_configured_stack(const char *name)
+{
+    if (strcmp(name, "Zigbee_main") == 0) {
+        return ZB_TASK_STACK_SIZE;
+    }
+    if (strcmp(name, "temp_sensor") == 0) {
+        return SENSOR_TASK_STACK_SIZE;
+    }
+    if (strcmp(name, "dlog") == 0) {
+        return DLOG_TASK_STACK_SIZE;
+    }
+    if (strcmp(name, "console_repl") == 0) {
+        return CONSOLE_TASK_STACK_SIZE;
+    }
+    return 0;
+}
+
+/**
+ * @brief Console 'mem': task stack high-water marks, heap and static DRAM
+ * 
+ * Firmware only (the host console has no tasks or heap regions to show).
+ * Stack sizes in Kconfig should keep roughly 25% of the configured stack
+ * free at the high-water mark after a few hours of operation.
+ */
+static int console_mem_cmd(int argc, char **argv)
+{
+    static TaskStatus_t tasks[MEM_CMD_MAX_TASKS];
+    (void)argc;
+    (void)argv;
+    UBaseType_t count = uxTaskGetSystemState(tasks, MEM_CMD_MAX_TASKS, NULL);
+    size_t static_stacks = sizeof(sensor_task_stack) + sizeof(zb_task_stack);
+#if DLOG_MODE != DLOG_MODE_OFF
+    static_stacks += sizeof(dlog_task_stack);
+#endif
+
+    if (count == 0) {
+        printf("more than %d tasks, snapshot skipped\n", MEM_CMD_MAX_TASKS);
+    }
+    printf("%-16s %4s %10s %10s\n", "task", "prio", "stack", "min free");
+    for (UBaseType_t i = 0; i < count; i++) {
+        uint32_t configured = mem_cmd_configured_stack(tasks[i].pcTaskName);
+        char size[12] = "-";
+        if (configured) {
+            snprintf(size, sizeof(size), "%u", (unsigned)configured);
+        }
+        printf("%-16s %4u %10s %10u\n", tasks[i].pcTaskName, (unsigned)tasks[i].uxCurrentPriority, size,
+               (unsigned)tasks[i].usStackHighWaterMark);
+    }
+
+    printf("heap: free %u, min free %u, largest block %u (internal 8-bit capable)\n",
+           (unsigned)heap_caps_get_free_size(MEM_HEAP_CAPS),
+           (unsigned)heap_caps_get_minimum_free_size(MEM_HEAP_CAPS),
+           (unsigned)heap_caps_get_largest_free_block(MEM_HEAP_CAPS));
+    printf("static DRAM: data %u, bss %u (task stacks %u of it), SENSOR_MAX_COUNT %d\n",
+           (unsigned)((char *)&_data_end - (char *)&_data_start),
+           (unsigned)((char *)&_bss_end - (char *)&_bss_start),
+           (unsigned)static_stacks, SENSOR_MAX_COUNT);
+    return 0;
+}
+
+/**
+ * @brief Console 'boot': startup milestones of this boot and the steps between them
+ */
+static int console_boot_cmd(int argc, char **argv)
+{
+    int32_t prev = 0;
+    (void)argc;
+    (void)argv;
+
+    printf("%-10s %10s %10s\n", "phase", "at ms", "step ms");
+    for (int i = 0; i < BOOT_PHASE_COUNT; i++) {
+        int32_t t = boot_profile_get((boot_phase_t)i);
+        if (t < 0) {
+            printf("%-10s %10s %10s\n", boot_profile_phase_name((boot_phase_t)i), "-", "-");
+            continue;
+        }
+        printf("%-10s %10ld %10ld\n", boot_profile_phase_name((boot_phase_t)i), (long)t, (long)(t - prev));
+        prev = t;
+    }
+    return 0;
+}
 
-        vTaskDelay(pdMS_TO_TICKS(5000));
+/**
+ * @brief Console 'pm': frequency scaling range and time spent per frequency mode
+ * 
+ * Time per mode (CPU max, APB max/min, light sleep) and per lock, including
+ * the 1-Wire "onewire" lock, comes from esp_pm_dump_locks() and needs
+ * CONFIG_PM_PROFILING (sdkconfig.defaults.bench).
+ */
+static int console_pm_cmd(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+
+#ifdef CONFIG_PM_ENABLE
+    esp_pm_config_t pm_config;
+    if (esp_pm_get_configuration(&pm_config) == ESP_OK) {
+        printf("Frequency scaling %d-%d MHz, light sleep %s\n", pm_config.min_freq_mhz, pm_config.max_freq_mhz,
+               pm_config.light_sleep_enable ? "on" : "off");
     }
+#ifdef CONFIG_PM_PROFILING
+    esp_pm_dump_locks(stdout);
+#else
+    printf("Build with sdkconfig.defaults.bench (CONFIG_PM_PROFILING) for time per frequency mode\n");
+#endif
+#else
+    printf("Power management disabled (CONFIG_PM_ENABLE)\n");
+#endif
+    return 0;
+}
+
+/**
+ * @brief Console 'zbcap': router table sizes, Zigbee heap and sensor RAM side by side
+ * 
+ * The cost per network entry is an upper bound (esp_zb_init heap over the
+ * network size, fixed parts included), so the largest network size that
+ * still leaves ZB_HEAP_RESERVE free is a conservative estimate. Static RAM
+ * freed by a smaller SENSOR_MAX_COUNT or history returns to the heap.
+ */
+static int console_zbcap_cmd(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    size_t heap_free = heap_caps_get_free_size(MEM_HEAP_CAPS);
+    size_t history = temp_history_ram_bytes();
+    uint32_t per_entry = (zb_heap.init + ZB_NETWORK_SIZE - 1) / ZB_NETWORK_SIZE;
+    uint32_t headroom = heap_free > ZB_HEAP_RESERVE ? (uint32_t)(heap_free - ZB_HEAP_RESERVE) : 0;
+    uint32_t slot_bytes = (uint32_t)((history + zb_heap.endpoints) / SENSOR_MAX_COUNT);
+
+    printf("router: children %d, network size %d, frame buffers %d\n", ZB_MAX_CHILDREN, ZB_NETWORK_SIZE,
+           ZB_IO_BUFFERS);
+    printf("zigbee heap: init %u (<= %u per network entry), endpoints %u, start %u\n",
+           (unsigned)zb_heap.init, (unsigned)per_entry, (unsigned)zb_heap.endpoints, (unsigned)zb_heap.start);
+    printf("sensor RAM: history %u, backfill %u (static), endpoints %u (heap), SENSOR_MAX_COUNT %d\n",
+           (unsigned)history, (unsigned)backfill_ram_bytes(), (unsigned)zb_heap.endpoints, SENSOR_MAX_COUNT);
+    printf("heap: free %u, largest block %u, reserve %d\n", (unsigned)heap_free,
+           (unsigned)heap_caps_get_largest_free_block(MEM_HEAP_CAPS), ZB_HEAP_RESERVE);
+    tlog_stats_t log_stats;
+    tlog_get_stats(&log_stats);
+    printf("flash log: %u records, %u blocks / %u bytes programmed, %u of %u sectors erased, boot scan %u us\n",
+           (unsigned)log_stats.records_appended, (unsigned)log_stats.blocks_written,
+           (unsigned)log_stats.bytes_programmed, (unsigned)log_stats.sectors_erased, (unsigned)log_stats.sector_count,
+           (unsigned)log_stats.scan_time_us);
+    if (per_entry == 0) {
+        printf("estimate: Zigbee stack not initialized yet\n");
+        return 0;
+    }
+    printf("estimate: network size up to %u; one sensor slot (history + endpoint, %u bytes) ~ %u network entries\n",
+           (unsigned)(ZB_NETWORK_SIZE + headroom / per_entry), (unsigned)slot_bytes, (unsigned)(slot_bytes / per_entry));
+    return 0;
+}
+
+#define HISTORY_CMD_DEFAULT_ROWS 10      // Rows printed by 'history' without a count
+
+/**
+ * @brief tlog_foreach() state of the 'tlog' command
+ */
+typedef struct {
+    uint32_t skip;       ///< Records left to skip before printing
+    uint32_t count;      ///< Records visited
+} console_tlog_dump_t;
+
+static bool console_tlog_count_cb(const tlog_record_t *record, void *ctx)
+{
+    (void)record;
+    ((console_tlog_dump_t *)ctx)->count++;
+    return true;
+}
+
+static bool console_tlog_print_cb(const tlog_record_t *record, void *ctx)
+{
+    console_tlog_dump_t *dump = ctx;
+    if (dump->skip > 0) {
+        dump->skip--;
+        return true;
+    }
+    printf("%u", (unsigned)record->time_s);
+    for (uint8_t i = 0; i < record->sensor_count; i++) {
+        if (record->values[i] == TLOG_VALUE_INVALID) {
+            printf(",");
+        } else {
+            printf(",%.2f", record->values[i] / 100.0f);
+        }
+    }
+    printf("\n");
+    dump->count++;
+    return true;
+}
+
+/**
+ * @brief Console 'tlog [records]': export the flash log as CSV, oldest first
+ * 
+ * Prints the last @p records records (all without an argument) in the trace
+ * format of host/report_replay (time_s,sensor1,...; empty field = failed
+ * read), RAM block included. Holds the log mutex for the whole walk, so the
+ * sensor task's appends wait until the export is done.
+ */
+static int console_tlog_cmd(int argc, char **argv)
+{
+    long records = argc > 1 ? strtol(argv[1], NULL, 10) : 0;
+    if (argc > 2 || records < 0) {
+        printf("usage: tlog [records]\n");
+        return 1;
+    }
+
+    console_tlog_dump_t dump = {0};
+    esp_err_t err = tlog_foreach(console_tlog_count_cb, &dump);
+    if (err != ESP_OK) {
+        printf("flash log not available (%s)\n", esp_err_to_name(err));
+        return 1;
+    }
+    if (records > 0 && (uint32_t)records < dump.count) {
+        dump.skip = dump.count - (uint32_t)records;
+    }
+
+    printf("time_s");
+    for (int i = 1; i <= SENSOR_MAX_COUNT; i++) {
+        printf(",sensor%d", i);
+    }
+    printf("\n");
+    dump.count = 0;
+    tlog_foreach(console_tlog_print_cb, &dump);
+    printf("# %u record(s)\n", (unsigned)dump.count);
+    return 0;
+}
+
+/**
+ * @brief Console 'history <sensor> [raw|1m|15m] [rows]': RAM history of one sensor, newest first
+ * 
+ * Aggregate tiers start with the bucket still being filled (marked '*').
+ * Times are flash log seconds (tlog_time_now()).
+ */
+static int console_history_cmd(int argc, char **argv)
+{
+    static const char *const tier_names[TEMP_HISTORY_TIER_COUNT] = {"1m", "15m"};
+    int tier = TEMP_HISTORY_TIER_1M;
+    bool raw = false;
+    long rows = HISTORY_CMD_DEFAULT_ROWS;
+    long sensor = argc > 1 ? strtol(argv[1], NULL, 10) : 0;
+
+    if (argc > 2) {
+        raw = strcmp(argv[2], "raw") == 0;
+        tier = strcmp(argv[2], "15m") == 0 ? TEMP_HISTORY_TIER_15M : TEMP_HISTORY_TIER_1M;
+        if (!raw && strcmp(argv[2], tier_names[tier]) != 0) {
+            tier = -1;
+        }
+    }
+    if (argc > 3) {
+        rows = strtol(argv[3], NULL, 10);
+    }
+    if (argc < 2 || argc > 4 || sensor < 1 || sensor > SENSOR_MAX_COUNT || tier < 0 || rows < 1) {
+        printf("usage: history <1..%d> [raw|1m|15m] [rows]\n", SENSOR_MAX_COUNT);
+        return 1;
+    }
+
+    uint8_t slot = (uint8_t)(sensor - 1);
+    printf("sensor %ld, now %us\n", sensor, (unsigned)tlog_time_now());
+    if (raw) {
+        temp_history_sample_t sample;
+        printf("%u raw sample(s)\n", (unsigned)temp_history_raw_count(slot));
+        for (uint16_t age = 0; age < rows && temp_history_get_raw(slot, age, &sample); age++) {
+            printf("  %10u %7.2f\n", (unsigned)sample.time_s, sample.value / 100.0f);
+        }
+        return 0;
+    }
+
+    temp_history_agg_t agg;
+    printf("%s tier: %u completed bucket(s)\n  %10s %7s %7s %7s %5s\n", tier_names[tier],
+           (unsigned)temp_history_agg_count(slot, tier), "start", "min", "avg", "max", "n");
+    if (temp_history_get_current(slot, tier, &agg)) {
+        printf(" *%10u %7.2f %7.2f %7.2f %5u\n", (unsigned)agg.start_s, agg.min / 100.0f, agg.avg / 100.0f,
+               agg.max / 100.0f, (unsigned)agg.count);
+        rows--;
+    }
+    for (uint16_t age = 0; age < rows && temp_history_get_agg(slot, tier, age, &agg); age++) {
+        printf("  %10u %7.2f %7.2f %7.2f %5u\n", (unsigned)agg.start_s, agg.min / 100.0f, agg.avg / 100.0f,
+               agg.max / 100.0f, (unsigned)agg.count);
+    }
+    return 0;
+}
+
+/**
+ * @brief Start benchmark/diagnostics REPL on the USB-serial port
+ * 
+ * Commands come from bench_cmd.c (devices, read, hist, rescan) plus the
+ * firmware-only 'mem' (stack high-water marks and heap), 'boot'
+ * (startup milestones), 'pm' (time per CPU frequency), 'zbcap' (router
+ * tables against sensor RAM and flash log counters), 'history' (RAM
+ * history tiers) and 'tlog' (flash log CSV export) and run in the console
+ * task; benchmark reads use background bus priority so the measurement
+ * cycle is not delayed by more than one transaction. The rescan is handed to the sensor task, which
+ * owns the slot table.
+ */
+static void start_bench_console(void)
+{
+    bench_cmd_ctx_t ctx = {
+        .bus = &onewire_bus,
+        .sensor_count = console_sensor_count,
+        .sensor_get = console_sensor_get,
+        .rescan = console_rescan,
+    };
+    bench_cmd_init(&ctx);
+
+    for (size_t i = 0; i < bench_cmd_count; i++) {
+        esp_console_cmd_t cmd = {
+            .command = bench_cmd_table[i].command,
+            .help = bench_cmd_table[i].help,
+            .hint = bench_cmd_table[i].hint,
+            .func = bench_cmd_table[i].func,
+        };
+        ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+    }
+    const esp_console_cmd_t mem_cmd = {
+        .command = "mem",
+        .help = "Task stack high-water marks, heap and static DRAM",
+        .func = console_mem_cmd,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&mem_cmd));
+    const esp_console_cmd_t boot_cmd = {
+        .command = "boot",
+        .help = "Startup milestones: time since startup and step per phase",
+        .func = console_boot_cmd,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&boot_cmd));
+    const esp_console_cmd_t pm_cmd = {
+        .command = "pm",
+        .help = "Frequency scaling range, time per CPU frequency mode and PM locks",
+        .func = console_pm_cmd,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&pm_cmd));
+    const esp_console_cmd_t zbcap_cmd = {
+        .command = "zbcap",
+        .help = "Router table sizes, Zigbee heap per startup step, sensor RAM, flash log counters and largest network size estimate",
+        .func = console_zbcap_cmd,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&zbcap_cmd));
+    const esp_console_cmd_t history_cmd = {
+        .command = "history",
+        .help = "RAM history of one sensor: raw samples or 1-minute / 15-minute min/avg/max, newest first",
+        .hint = "<sensor> [raw|1m|15m] [rows]",
+        .func = console_history_cmd,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&history_cmd));
+    const esp_console_cmd_t tlog_cmd = {
+        .command = "tlog",
+        .help = "Export the flash log as CSV (time_s,sensor1,...), oldest first; last <records> only if given",
+        .hint = "[records]",
+        .func = console_tlog_cmd,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&tlog_cmd));
+
+    esp_console_repl_t *repl = NULL;
+    esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
+    esp_console_dev_usb_serial_jtag_config_t hw_config = ESP_CONSOLE_DEV_USB_SERIAL_JTAG_CONFIG_DEFAULT();
+    repl_config.prompt = "thermo>";
+    repl_config.task_stack_size = CONSOLE_TASK_STACK_SIZE;
+    repl_config.task_priority = 2;   // Below the sensor and Zigbee tasks
+    ESP_ERROR_CHECK(esp_console_new_repl_usb_serial_jtag(&hw_config, &repl_config, &repl));
+    ESP_ERROR_CHECK(esp_console_register_help_command());
+    ESP_ERROR_CHECK(esp_console_start_repl(repl));
+    ESP_LOGI(TAG, "Benchmark console started (type 'help')");
+}
+#endif
+
+/**
+ * @brief Create manufacturer-specific extension cluster (0xFC00)
+ * 
+ * Every sensor endpoint carries the per-sensor diagnostics (0x0010-0x0013:
+ * CRC errors, presence failures, retries, last conversion time). The first
+ * endpoint additionally carries the device-level attributes:
+ * - 0x0000 History batch (octet string, reportable) - backfill frames
+ * - 0x0001 Packed readings (octet string, reportable) - all sensors in one frame
+ * - 0x0002 Report mode (enum8, writable) - see report_mode_t
+ * - 0x0003 Sensor busy-wait CPU share (uint16 per mille, reportable)
+ * - 0x0004 Longest scheduler-suspended window (uint32 µs, reportable)
+ * - 0x0020 Report send failures, 0x0021 minimum free heap,
+ *   0x0022/0x0023 sensor/Zigbee task stack high-water marks,
+ *   0x0024 startup to first temperature report (ms),
+ *   0x0025 awake time of the previous cycle (ms, sleepy build only),
+ *   0x0026-0x0028 flash log records, sector erases and bytes programmed
+ *   since boot (router build only) (reportable)
+ * 
+ * @param slot Sensor slot of the endpoint
+ * @return Attribute list of the cluster
+ * 
+ * @note Octet string storage is sized by the initial length byte, so frame
+ *       attributes start at maximum length
+ */
+static esp_zb_attribute_list_t *create_thermo_ext_cluster(uint8_t slot)
+{
+    static uint8_t history_batch_init[REPORT_FRAME_MAX_LEN + 1] = {REPORT_FRAME_MAX_LEN};
+    static uint8_t packed_readings_init[REPORT_FRAME_MAX_LEN + 1] = {REPORT_FRAME_MAX_LEN};
+    static const uint32_t zero_u32 = 0;
+    static const uint16_t zero_u16 = 0;
+    const uint8_t diag_access = ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING;
+    
+    esp_zb_attribute_list_t *cluster = esp_zb_zcl_attr_list_create(ZB_THERMO_EXT_CLUSTER_ID);
+    if (slot == 0) {
+        ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(cluster, ZB_THERMO_EXT_ATTR_HISTORY_BATCH,
+                                                              ESP_ZB_ZCL_ATTR_TYPE_OCTET_STRING,
+                                                              ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING,
+                                                              history_batch_init));
+        ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(cluster, ZB_THERMO_EXT_ATTR_PACKED_READINGS,
+                                                              ESP_ZB_ZCL_ATTR_TYPE_OCTET_STRING,
+                                                              ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING,
+                                                              packed_readings_init));
+        ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(cluster, ZB_THERMO_EXT_ATTR_REPORT_MODE,
+                                                              ESP_ZB_ZCL_ATTR_TYPE_8BIT_ENUM,
+                                                              ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE,
+                                                              &report_mode));
+        ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(cluster, ZB_THERMO_EXT_ATTR_CPU_BUSY,
+                                                              ESP_ZB_ZCL_ATTR_TYPE_U16, diag_access, &cpu_busy_permille));
+        ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(cluster, ZB_THERMO_EXT_ATTR_SUSPEND_MAX,
+                                                              ESP_ZB_ZCL_ATTR_TYPE_U32, diag_access, &cpu_suspend_max_us));
+        ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(cluster, ZB_THERMO_EXT_ATTR_REPORT_FAILS,
+                                                              ESP_ZB_ZCL_ATTR_TYPE_U32, diag_access, (void *)&zero_u32));
+        ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(cluster, ZB_THERMO_EXT_ATTR_HEAP_FREE_MIN,
+                                                              ESP_ZB_ZCL_ATTR_TYPE_U32, diag_access, (void *)&zero_u32));
+        ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(cluster, ZB_THERMO_EXT_ATTR_STACK_SENSOR,
+                                                              ESP_ZB_ZCL_ATTR_TYPE_U16, diag_access, (void *)&zero_u16));
+        ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(cluster, ZB_THERMO_EXT_ATTR_STACK_ZIGBEE,
+                                                              ESP_ZB_ZCL_ATTR_TYPE_U16, diag_access, (void *)&zero_u16));
+        ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(cluster, ZB_THERMO_EXT_ATTR_BOOT_REPORT_MS,
+                                                              ESP_ZB_ZCL_ATTR_TYPE_U32, diag_access, (void *)&zero_u32));
+#if SLEEPY_END_DEVICE
+        ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(cluster, ZB_THERMO_EXT_ATTR_AWAKE_MS,
+                                                              ESP_ZB_ZCL_ATTR_TYPE_U16, diag_access, (void *)&zero_u16));
+#else
+        ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(cluster, ZB_THERMO_EXT_ATTR_LOG_RECORDS,
+                                                              ESP_ZB_ZCL_ATTR_TYPE_U32, diag_access, (void *)&zero_u32));
+        ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(cluster, ZB_THERMO_EXT_ATTR_LOG_ERASES,
+                                                              ESP_ZB_ZCL_ATTR_TYPE_U32, diag_access, (void *)&zero_u32));
+        ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(cluster, ZB_THERMO_EXT_ATTR_LOG_BYTES,
+                                                              ESP_ZB_ZCL_ATTR_TYPE_U32, diag_access, (void *)&zero_u32));
+#endif
+    }
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(cluster, ZB_THERMO_EXT_ATTR_CRC_ERRORS,
+                                                          ESP_ZB_ZCL_ATTR_TYPE_U32, diag_access, (void *)&zero_u32));
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(cluster, ZB_THERMO_EXT_ATTR_PRESENCE_FAILS,
+                                                          ESP_ZB_ZCL_ATTR_TYPE_U32, diag_access, (void *)&zero_u32));
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(cluster, ZB_THERMO_EXT_ATTR_READ_RETRIES,
+                                                          ESP_ZB_ZCL_ATTR_TYPE_U32, diag_access, (void *)&zero_u32));
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(cluster, ZB_THERMO_EXT_ATTR_LAST_CONV_MS,
+                                                          ESP_ZB_ZCL_ATTR_TYPE_U16, diag_access, (void *)&zero_u16));
+    return cluster;
+}
+
+/**
+ * @brief Create ZCL Diagnostics cluster (0x0B05) for the first endpoint
+ * 
+ * Standard attributes the application can source without stack internals:
+ * NumberOfResets (persistent boot counter) and APS unicast success/failure
+ * (send confirmations counted in zb_command_send_status_handler()).
+ * 
+ * @return Attribute list of the cluster
+ */
+static esp_zb_attribute_list_t *create_diagnostics_cluster(void)
+{
+    static const uint16_t zero_u16 = 0;
+    const uint8_t access = ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING;
+    
+    esp_zb_attribute_list_t *cluster = esp_zb_zcl_attr_list_create(ESP_ZB_ZCL_CLUSTER_ID_DIAGNOSTICS);
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(cluster, ZB_DIAG_ATTR_NUMBER_OF_RESETS,
+                                                          ESP_ZB_ZCL_ATTR_TYPE_U16, access, &boot_count));
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(cluster, ZB_DIAG_ATTR_APS_TX_UCAST_SUCCESS,
+                                                          ESP_ZB_ZCL_ATTR_TYPE_U16, access, (void *)&zero_u16));
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(cluster, ZB_DIAG_ATTR_APS_TX_UCAST_FAIL,
+                                                          ESP_ZB_ZCL_ATTR_TYPE_U16, access, (void *)&zero_u16));
+    return cluster;
+}
+
+/**
+ * @brief Heap allocated since the mark, and move the mark to now
+ * 
+ * The Zigbee task runs above app_main and the console, so between two marks
+ * of one startup step nearly all allocations are its own.
+ */
+static uint32_t heap_used_since(size_t *mark)
+{
+    size_t now = heap_caps_get_free_size(MEM_HEAP_CAPS);
+    uint32_t used = now < *mark ? (uint32_t)(*mark - now) : 0;
+    *mark = now;
+    return used;
 }
 
 /**
  * @brief Main Zigbee stack initialization and event loop task
  * 
- * Initializes the Zigbee stack as a Router device and configures:
- * - Two temperature sensor endpoints (11, 12) with HA profile
+ * Initializes the Zigbee stack as a Router device (sleepy end device in the
+ * battery variant) and configures:
+ * - One temperature sensor endpoint per sensor slot (11, 12, ...) with HA profile
  * - ZCL clusters: Basic, Identify, Temperature Measurement
+ * - Manufacturer-specific cluster 0xFC00 on every endpoint (frames and
+ *   device diagnostics on the first, per-sensor diagnostics on all)
+ * - ZCL Diagnostics cluster on the first endpoint
  * - Device metadata: Manufacturer (Espressif), Model (ESP32C6.TH)
  * - Primary channel 11 (Zigbee2MQTT default)
  * - Manual commissioning mode (requires BOOT button or auto-rejoin)
@@ -673,79 +2745,73 @@ static void esp_zb_task(void *pvParameters)
 {
     ESP_LOGI(TAG, "Zigbee task started");
     
+#if SLEEPY_END_DEVICE
+    esp_zb_cfg_t zb_nwk_cfg = ESP_ZB_ZED_CONFIG();
+#else
     esp_zb_cfg_t zb_nwk_cfg = ESP_ZB_ROUTER_CONFIG();
+#endif
     ESP_ERROR_CHECK(esp_zb_platform_config(&zigbee_platform_config));
+#if !SLEEPY_END_DEVICE
+    ESP_ERROR_CHECK(esp_zb_overall_network_size_set(ZB_NETWORK_SIZE));
+    ESP_ERROR_CHECK(esp_zb_io_buffer_size_set(ZB_IO_BUFFERS));
+#endif
+    size_t heap_mark = heap_caps_get_free_size(MEM_HEAP_CAPS);
     ESP_LOGI(TAG, "Initializing Zigbee stack...");
     esp_zb_init(&zb_nwk_cfg);
+    zb_heap.init = heap_used_since(&heap_mark);
     ESP_LOGI(TAG, "Zigbee stack initialized");
     
     /* Create customized temperature sensor endpoints */
     esp_zb_ep_list_t *ep_list = esp_zb_ep_list_create();
     ESP_LOGI(TAG, "Endpoint list created");
     
-    /* Endpoint 1 - First temperature sensor */
-    esp_zb_cluster_list_t *cluster_list_1 = esp_zb_zcl_cluster_list_create();
     esp_zb_temperature_meas_cluster_cfg_t temp_cluster_cfg = {
         .measured_value = 0,
         .min_value = TEMP_MIN_VALUE_CENTI,
         .max_value = TEMP_MAX_VALUE_CENTI,
     };
     
-    // Create basic cluster with default attributes
-    esp_zb_basic_cluster_cfg_t basic_cfg = {
-        .zcl_version = ESP_ZB_ZCL_BASIC_ZCL_VERSION_DEFAULT_VALUE,
-        .power_source = 0x01,  // Mains power
-    };
-    esp_zb_attribute_list_t *basic_cluster_1 = esp_zb_basic_cluster_create(&basic_cfg);
-    
-    // Set manufacturer name and model using const char array
-    ESP_ERROR_CHECK(esp_zb_basic_cluster_add_attr(basic_cluster_1, ESP_ZB_ZCL_ATTR_BASIC_MANUFACTURER_NAME_ID, (void *)zb_manufacturer));
-    ESP_ERROR_CHECK(esp_zb_basic_cluster_add_attr(basic_cluster_1, ESP_ZB_ZCL_ATTR_BASIC_MODEL_IDENTIFIER_ID, (void *)zb_model));
-    
-    ESP_ERROR_CHECK(esp_zb_cluster_list_add_basic_cluster(cluster_list_1, basic_cluster_1, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
-    ESP_ERROR_CHECK(esp_zb_cluster_list_add_identify_cluster(cluster_list_1, esp_zb_identify_cluster_create(NULL), ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
-    ESP_ERROR_CHECK(esp_zb_cluster_list_add_temperature_meas_cluster(cluster_list_1, esp_zb_temperature_meas_cluster_create(&temp_cluster_cfg), ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
-    
-    esp_zb_endpoint_config_t endpoint_config_1 = {
-        .endpoint = ESP_TEMP_SENSOR_ENDPOINT_1,
-        .app_profile_id = ESP_ZB_AF_HA_PROFILE_ID,
-        .app_device_id = ESP_ZB_HA_TEMPERATURE_SENSOR_DEVICE_ID,
-        .app_device_version = 0
-    };
-    esp_zb_ep_list_add_ep(ep_list, cluster_list_1, endpoint_config_1);
-    
-    /* Endpoint 2 - Second temperature sensor */
-    esp_zb_cluster_list_t *cluster_list_2 = esp_zb_zcl_cluster_list_create();
-    temp_cluster_cfg.measured_value = 0;
-    
-    // Create basic cluster with default attributes
-    esp_zb_basic_cluster_cfg_t basic_cfg_2 = {
-        .zcl_version = ESP_ZB_ZCL_BASIC_ZCL_VERSION_DEFAULT_VALUE,
-        .power_source = 0x01,  // Mains power
-    };
-    esp_zb_attribute_list_t *basic_cluster_2 = esp_zb_basic_cluster_create(&basic_cfg_2);
-    
-    // Set manufacturer name and model using const char array
-    ESP_ERROR_CHECK(esp_zb_basic_cluster_add_attr(basic_cluster_2, ESP_ZB_ZCL_ATTR_BASIC_MANUFACTURER_NAME_ID, (void *)zb_manufacturer));
-    ESP_ERROR_CHECK(esp_zb_basic_cluster_add_attr(basic_cluster_2, ESP_ZB_ZCL_ATTR_BASIC_MODEL_IDENTIFIER_ID, (void *)zb_model));
-    
-    ESP_ERROR_CHECK(esp_zb_cluster_list_add_basic_cluster(cluster_list_2, basic_cluster_2, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
-    ESP_ERROR_CHECK(esp_zb_cluster_list_add_identify_cluster(cluster_list_2, esp_zb_identify_cluster_create(NULL), ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
-    ESP_ERROR_CHECK(esp_zb_cluster_list_add_temperature_meas_cluster(cluster_list_2, esp_zb_temperature_meas_cluster_create(&temp_cluster_cfg), ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
-    
-    esp_zb_endpoint_config_t endpoint_config_2 = {
-        .endpoint = ESP_TEMP_SENSOR_ENDPOINT_2,
-        .app_profile_id = ESP_ZB_AF_HA_PROFILE_ID,
-        .app_device_id = ESP_ZB_HA_TEMPERATURE_SENSOR_DEVICE_ID,
-        .app_device_version = 0
-    };
-    esp_zb_ep_list_add_ep(ep_list, cluster_list_2, endpoint_config_2);
-    ESP_LOGI(TAG, "Both endpoints configured");
+    /* One endpoint per sensor slot (11, 12, ...) */
+    for (uint8_t i = 0; i < SENSOR_MAX_COUNT; i++) {
+        esp_zb_cluster_list_t *cluster_list = esp_zb_zcl_cluster_list_create();
+        
+        // Create basic cluster with default attributes
+        esp_zb_basic_cluster_cfg_t basic_cfg = {
+            .zcl_version = ESP_ZB_ZCL_BASIC_ZCL_VERSION_DEFAULT_VALUE,
+            .power_source = SLEEPY_END_DEVICE ? 0x03 : 0x01,  // Battery / mains power
+        };
+        esp_zb_attribute_list_t *basic_cluster = esp_zb_basic_cluster_create(&basic_cfg);
+        
+        // Set manufacturer name and model using const char array
+        ESP_ERROR_CHECK(esp_zb_basic_cluster_add_attr(basic_cluster, ESP_ZB_ZCL_ATTR_BASIC_MANUFACTURER_NAME_ID, (void *)zb_manufacturer));
+        ESP_ERROR_CHECK(esp_zb_basic_cluster_add_attr(basic_cluster, ESP_ZB_ZCL_ATTR_BASIC_MODEL_IDENTIFIER_ID, (void *)zb_model));
+        
+        ESP_ERROR_CHECK(esp_zb_cluster_list_add_basic_cluster(cluster_list, basic_cluster, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
+        ESP_ERROR_CHECK(esp_zb_cluster_list_add_identify_cluster(cluster_list, esp_zb_identify_cluster_create(NULL), ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
+        ESP_ERROR_CHECK(esp_zb_cluster_list_add_temperature_meas_cluster(cluster_list, esp_zb_temperature_meas_cluster_create(&temp_cluster_cfg), ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
+        
+        ESP_ERROR_CHECK(esp_zb_cluster_list_add_custom_cluster(cluster_list, create_thermo_ext_cluster(i), ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
+        if (i == 0) {
+            ESP_ERROR_CHECK(esp_zb_cluster_list_add_custom_cluster(cluster_list, create_diagnostics_cluster(), ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
+        }
+        
+        esp_zb_endpoint_config_t endpoint_config = {
+            .endpoint = SENSOR_ENDPOINT_BASE + i,
+            .app_profile_id = ESP_ZB_AF_HA_PROFILE_ID,
+            .app_device_id = ESP_ZB_HA_TEMPERATURE_SENSOR_DEVICE_ID,
+            .app_device_version = 0
+        };
+        esp_zb_ep_list_add_ep(ep_list, cluster_list, endpoint_config);
+    }
+    ESP_LOGI(TAG, "%d sensor endpoint(s) configured", SENSOR_MAX_COUNT);
     
     esp_zb_device_register(ep_list);
+    zb_heap.endpoints = heap_used_since(&heap_mark);
     ESP_LOGI(TAG, "Device registered");
     
     esp_zb_core_action_handler_register(zb_action_handler);
+    esp_zb_zcl_command_send_status_handler_register(zb_command_send_status_handler);
+    esp_zb_raw_command_handler_register(zb_raw_command_handler);
     ESP_LOGI(TAG, "Action handler registered");
     
     // Set PRIMARY channel to 11 (Zigbee2MQTT default channel)
@@ -754,25 +2820,65 @@ static void esp_zb_task(void *pvParameters)
     esp_zb_set_primary_network_channel_set((1l << 11));
     ESP_LOGI(TAG, "Allowing Zigbee commissioning on any coordinator that permits it");
     
+#if SLEEPY_END_DEVICE
+    esp_zb_set_rx_on_when_idle(false);    // Parent buffers frames for us while we sleep
+#endif
     ESP_LOGI(TAG, "Starting Zigbee stack (manual commissioning mode)...");
     esp_err_t err = esp_zb_start(false);  // false = manual commissioning
     if (err != ESP_OK) {
         ESP_LOGW(TAG, "esp_zb_start returned: %s (continuing anyway)", esp_err_to_name(err));
     }
+    zb_heap.start = heap_used_since(&heap_mark);
+    BOOT_MARK(BOOT_PHASE_ZB_STARTED);
+#if SLEEPY_END_DEVICE
+    ESP_LOGI(TAG, "Zigbee heap: init %u, endpoints %u, start %u bytes",
+             (unsigned)zb_heap.init, (unsigned)zb_heap.endpoints, (unsigned)zb_heap.start);
+#else
+    ESP_LOGI(TAG, "Zigbee heap: init %u, endpoints %u, start %u bytes (children %d, network size %d, buffers %d)",
+             (unsigned)zb_heap.init, (unsigned)zb_heap.endpoints, (unsigned)zb_heap.start,
+             ZB_MAX_CHILDREN, ZB_NETWORK_SIZE, ZB_IO_BUFFERS);
+#endif
     ESP_LOGI(TAG, "Entering Zigbee main loop");
     esp_zb_stack_main_loop();
 }
 
+/**
+ * @brief Enable dynamic frequency scaling (CONFIG_PM_ENABLE)
+ * 
+ * The CPU runs at the XTAL frequency whenever no task runs and no PM lock
+ * is held; the 1-Wire layer pins the maximum frequency for each bus
+ * transaction (onewire_bus.c). Automatic light sleep stays off: a router
+ * keeps its receiver on.
+ */
+static void configure_power_management(void)
+{
+#ifdef CONFIG_PM_ENABLE
+    esp_pm_config_t pm_config = {
+        .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = CONFIG_XTAL_FREQ,
+        .light_sleep_enable = false,
+    };
+    esp_err_t err = esp_pm_configure(&pm_config);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Frequency scaling not enabled (%s)", esp_err_to_name(err));
+        return;
+    }
+    ESP_LOGI(TAG, "Frequency scaling: %d-%d MHz", pm_config.min_freq_mhz, pm_config.max_freq_mhz);
+#endif
+}
+
 void app_main(void)
 {
     esp_err_t ret;
 
+    BOOT_MARK(BOOT_PHASE_APP_START);
+
     // CRITICAL: Initialize RF switch for Seeed XIAO ESP32-C6
     // Without this, IEEE 802.15.4 radio won't work!
     ESP_LOGI(TAG, "Configuring RF switch for Zigbee (Seeed XIAO ESP32-C6)");
     gpio_config_t rf_config = {
         .pin_bit_mask = (1ULL << WIFI_ENABLE) | (1ULL << WIFI_ANT_CONFIG),
-        .mode = GPIO_MODE_OUTPUT,
+        .mode = GPIO_MODE_INPUT_OUTPUT,    // Input enabled for the read-back check
         .pull_up_en = GPIO_PULLUP_DISABLE,
         .pull_down_en = GPIO_PULLDOWN_DISABLE,
         .intr_type = GPIO_INTR_DISABLE
@@ -782,8 +2888,13 @@ void app_main(void)
     // Enable RF and select internal antenna for Zigbee
     gpio_set_level(WIFI_ENABLE, 0);        // Enable RF (active low)
     gpio_set_level(WIFI_ANT_CONFIG, 0);    // Select internal antenna
-    vTaskDelay(pdMS_TO_TICKS(100));        // Wait for RF to stabilize
-    ESP_LOGI(TAG, "RF switch configured: Zigbee radio enabled");
+    // The switch settles in microseconds and the radio is first used by esp_zb_start,
+    // hundreds of ms later; checking the pin levels replaces the former 100 ms delay
+    if (gpio_get_level(WIFI_ENABLE) != 0 || gpio_get_level(WIFI_ANT_CONFIG) != 0) {
+        ESP_LOGE(TAG, "RF switch pins did not go low - check GPIO%d/GPIO%d", WIFI_ENABLE, WIFI_ANT_CONFIG);
+    } else {
+        ESP_LOGI(TAG, "RF switch configured: Zigbee radio enabled");
+    }
     
     // Initialize BOOT button for manual pairing control
     gpio_config_t boot_button_config = {
@@ -791,7 +2902,7 @@ void app_main(void)
         .mode = GPIO_MODE_INPUT,
         .pull_up_en = GPIO_PULLUP_ENABLE,
         .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_DISABLE
+        .intr_type = GPIO_INTR_ANYEDGE
     };
     gpio_config(&boot_button_config);
     
@@ -817,15 +2928,62 @@ void app_main(void)
         rtc_wait_for_manual_pairing = false;
     }
 
-    /* Initialize sensors */
-    init_sensors();
-
-    /* Start Zigbee task */
-    xTaskCreate(esp_zb_task, "Zigbee_main", 4096, NULL, 5, NULL);
+    load_report_mode();
+    configure_power_management();
+#if SLEEPY_END_DEVICE
+    /* Timer wake with valid RTC state: no NVS writes, the reset counter comes from RTC memory */
+    sleepy_cold_boot = esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_TIMER || sleepy_rtc.magic != SLEEPY_RTC_MAGIC;
+    if (sleepy_cold_boot) {
+        count_boot();
+    } else {
+        boot_count = sleepy_rtc.boot_count;
+    }
+#else
+    count_boot();
+#endif
+    BOOT_MARK(BOOT_PHASE_NVS_READY);
+    
+    /* Deferred log ring before any task can write to it */
+    dlog_init();
+
+    /* Reading storage used by both tasks (the Zigbee task sends backfill after joining) */
+    temp_history_init();
+#if !SLEEPY_END_DEVICE
+    tlog_init();
+#endif
+    backfill_init();
+    reading_cache_init();
+
+#if SLEEPY_END_DEVICE
+    /* Sensors first: the cycle task starts the Zigbee task only when a report is due */
+    init_onewire_bus();
+    sensor_task_handle = xTaskCreateStatic(sleepy_cycle_task, "temp_sensor", SENSOR_TASK_STACK_SIZE, NULL, 5,
+                                           sensor_task_stack, &sensor_task_tcb);
+#else
+    /* Start Zigbee task first: stack init and rejoin are the longest path to the first report */
+    zb_task_handle = xTaskCreateStatic(esp_zb_task, "Zigbee_main", ZB_TASK_STACK_SIZE, NULL, 5,
+                                       zb_task_stack, &zb_task_tcb);
+
+    /* Bus before the sensor task and console use it; the ROM search runs in the sensor task */
+    init_onewire_bus();
+
+    /* Undelivered flash log records before the sensor task queues new ones */
+    backfill_rebuild_from_log();
 
     /* Start temperature sensor task */
-    xTaskCreate(temperature_sensor_task, "temp_sensor", 4096, NULL, 5, NULL);
+    sensor_task_handle = xTaskCreateStatic(temperature_sensor_task, "temp_sensor", SENSOR_TASK_STACK_SIZE, NULL, 5,
+                                           sensor_task_stack, &sensor_task_tcb);
+#endif
+
+#if DLOG_MODE != DLOG_MODE_OFF && !SLEEPY_END_DEVICE
+    /* Format deferred sensor logs below every other task */
+    xTaskCreateStatic(dlog_drain_task, "dlog", DLOG_TASK_STACK_SIZE, NULL, 1, dlog_task_stack, &dlog_task_tcb);
+#endif
     
-    /* Start BOOT button monitor task for factory reset */
-    xTaskCreate(boot_button_monitor_task, "boot_monitor", 2048, NULL, 3, NULL);
+    /* Watch BOOT button for manual pairing (interrupt driven, no task) */
+    boot_button_start();
+
+#if BENCH_CONSOLE_ENABLE
+    start_bench_console();
+#endif
 }
@@ -15,32 +15,126 @@
  * - ROM search algorithm for device enumeration
  * - Microsecond-precise timing using esp_rom_delay_us()
  * 
- * Timing requirements (standard speed):
+ * Timing requirements (standard speed, defaults before calibration):
  * - Reset pulse: 480µs LOW
  * - Presence detect: 15-60µs after reset
  * - Write 1: 6µs LOW, 64µs HIGH
  * - Write 0: 60µs LOW, 10µs HIGH
  * - Read: 6µs LOW, 9µs sample, 55µs recovery
  * 
+ * Calibration: onewire_bus_init() measures the line rise time and derives
+ * per-bus sample points and recovery gaps (onewire_timing.h), so long cables
+ * are read reliably and short ones use shorter slots.
+ * 
+ * Tracing (ONEWIRE_TRACE_ENABLED): drive changes and read samples are
+ * recorded into a RAM ring (onewire_trace.h) and dumped as hex log lines for
+ * host/onewire_trace_tool. The rise time measurement polls are not traced.
+ * 
+ * Oversampling: optionally each read slot is sampled 3 or 5 times 1µs apart
+ * and the majority wins, so a single glitch no longer costs a scratchpad
+ * retry. Disagreeing samples are counted as a field measure of line noise.
+ * 
+ * Arbitration: ownership is handed over directly on release to the highest
+ * priority waiter (one binary semaphore per priority), so a periodic cycle
+ * cannot be overtaken mid-transaction and an on-demand read never waits
+ * behind queued background work.
+ * 
+ * Frequency scaling (CONFIG_PM_ENABLE): esp_rom_delay_us() and the cycle
+ * counter assume a fixed CPU clock, so a CPU_FREQ_MAX lock is taken when the
+ * bus goes from free to held and dropped when it is free again (hand-overs
+ * keep it). Conversions and idle time run without it.
+ * 
+ * Specialization: with ONEWIRE_FIXED_TIMING the slot functions read a
+ * constant timing table instead of bus->timing, so every delay becomes an
+ * immediate and the sample loop collapses to one sample; calibration and the
+ * rise time measurement are compiled out. ONEWIRE_SEARCH_ENABLED=0 drops the
+ * search and verify code (single sensor, SKIP ROM).
+ * 
  * @note Uses GPIO open-drain mode with external 4.7kΩ pull-up resistor
  * @note No internal pull-up is used (disabled)
  */
 
 #include "onewire_bus.h"
+#include "cpu_account.h"
 #include "esp_rom_sys.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "freertos/task.h"
 #include <string.h>
 
 static const char *TAG = "ONEWIRE";
 
-// 1-Wire Protocol Timing Constants (standard speed, microseconds)
-#define RESET_DELAY_US 480      ///< Reset pulse duration
-#define PRESENCE_DELAY_US 70    ///< Wait time before checking presence pulse
+// Rise time measurement
+#define RISE_SAMPLES            8       ///< Pulses measured, worst one is used
+#define RISE_PULSE_LOW_US       2       ///< Short low pulse (looks like a write-1 slot to slaves)
+#define RISE_TIMEOUT_US         50      ///< Line stuck low / no pull-up
+#define TRACE_DUMP_CHUNK        32      ///< Trace bytes per log line
+
+#if ONEWIRE_FIXED_TIMING
+static const onewire_timing_t onewire_fixed_timing = ONEWIRE_TIMING_DEFAULT();
+#define BUS_TIMING(bus)         (&onewire_fixed_timing)
+#else
+#define BUS_TIMING(bus)         (&(bus)->timing)
+#endif
+
+/**
+ * @brief Pin the CPU frequency for slot timing (no-op without CONFIG_PM_ENABLE)
+ */
+static inline void onewire_bus_lock_freq(const onewire_bus_handle_t *bus)
+{
+#ifdef CONFIG_PM_ENABLE
+    esp_pm_lock_acquire(bus->cpu_lock);
+#else
+    (void)bus;
+#endif
+}
+
+/**
+ * @brief Allow frequency scaling again
+ */
+static inline void onewire_bus_unlock_freq(const onewire_bus_handle_t *bus)
+{
+#ifdef CONFIG_PM_ENABLE
+    esp_pm_lock_release(bus->cpu_lock);
+#else
+    (void)bus;
+#endif
+}
+
+/**
+ * @brief Drive line (0 = pull low, 1 = release), traced when enabled
+ */
+static inline void onewire_bus_drive(const onewire_bus_handle_t *bus, uint32_t level)
+{
+    gpio_set_level(bus->pin, level);
+#if ONEWIRE_TRACE_ENABLED
+    if (bus->trace) {
+        onewire_trace_record(bus->trace, level ? ONEWIRE_TRACE_RELEASE : ONEWIRE_TRACE_DRIVE_LOW,
+                             esp_cpu_get_cycle_count());
+    }
+#endif
+}
+
+/**
+ * @brief Sample line level, traced when enabled
+ */
+static inline int onewire_bus_sample(const onewire_bus_handle_t *bus)
+{
+    int level = gpio_get_level(bus->pin);
+#if ONEWIRE_TRACE_ENABLED
+    if (bus->trace) {
+        onewire_trace_record(bus->trace, level ? ONEWIRE_TRACE_SAMPLE_1 : ONEWIRE_TRACE_SAMPLE_0,
+                             esp_cpu_get_cycle_count());
+    }
+#endif
+    return level;
+}
 
 /**
  * @brief Write single bit to 1-Wire bus
  * 
- * Timing for bit value 1:
+ * Timing for bit value 1 (defaults, see bus->timing):
  * - Pull LOW for 6µs
  * - Release HIGH for 64µs (total slot: 70µs)
  * 
@@ -55,27 +149,30 @@ static const char *TAG = "ONEWIRE";
  */
 static void onewire_bus_write_bit(const onewire_bus_handle_t *bus, bool bit)
 {
+    const onewire_timing_t *t = BUS_TIMING(bus);
+    
     if (bit) {
-        gpio_set_level(bus->pin, 0);
-        esp_rom_delay_us(6);
-        gpio_set_level(bus->pin, 1);
-        esp_rom_delay_us(64);
+        onewire_bus_drive(bus, 0);
+        esp_rom_delay_us(t->write1_low_us);
+        onewire_bus_drive(bus, 1);
+        esp_rom_delay_us(t->write1_high_us);
     } else {
-        gpio_set_level(bus->pin, 0);
-        esp_rom_delay_us(60);
-        gpio_set_level(bus->pin, 1);
-        esp_rom_delay_us(10);
+        onewire_bus_drive(bus, 0);
+        esp_rom_delay_us(t->write0_low_us);
+        onewire_bus_drive(bus, 1);
+        esp_rom_delay_us(t->write0_high_us);
     }
 }
 
 /**
  * @brief Read single bit from 1-Wire bus
  * 
- * Read timing:
+ * Read timing (defaults, see bus->timing):
  * 1. Pull LOW for 6µs (initiate read slot)
  * 2. Release to HIGH
  * 3. Wait 9µs
- * 4. Sample the bit (device pulls LOW for 0, remains HIGH for 1)
+ * 4. Sample the bit (device pulls LOW for 0, remains HIGH for 1),
+ *    with oversampling read_samples times 1µs apart and take the majority
  * 5. Wait 55µs for recovery (total slot: 70µs)
  * 
  * @param bus Pointer to OneWire bus handle
@@ -84,15 +181,30 @@ static void onewire_bus_write_bit(const onewire_bus_handle_t *bus, bool bit)
  * @note Master must release bus within 15µs for slave to respond
  * @note Sampling window is 15µs after slot starts
  */
-static bool onewire_bus_read_bit(const onewire_bus_handle_t *bus)
+static bool onewire_bus_read_bit(onewire_bus_handle_t *bus)
 {
-    gpio_set_level(bus->pin, 0);
-    esp_rom_delay_us(6);
-    gpio_set_level(bus->pin, 1);
-    esp_rom_delay_us(9);
+    const onewire_timing_t *t = BUS_TIMING(bus);
+    uint8_t ones = 0;
+    
+    onewire_bus_drive(bus, 0);
+    esp_rom_delay_us(t->read_low_us);
+    onewire_bus_drive(bus, 1);
+    esp_rom_delay_us(t->read_sample_us);
     
-    bool bit = gpio_get_level(bus->pin);
-    esp_rom_delay_us(55);
+    for (uint8_t i = 0; i < t->read_samples; i++) {
+        if (i > 0) {
+            esp_rom_delay_us(ONEWIRE_TIMING_SAMPLE_GAP_US);
+        }
+        ones += onewire_bus_sample(bus);
+    }
+    esp_rom_delay_us(t->read_recovery_us);
+    
+    bool bit = ones * 2 > t->read_samples;
+    bus->line_stats.read_bits++;
+    if (ones != 0 && ones != t->read_samples) {
+        bus->line_stats.noisy_bits++;
+        bus->line_stats.minority_samples += bit ? t->read_samples - ones : ones;
+    }
     
     return bit;
 }
@@ -109,6 +221,8 @@ static bool onewire_bus_read_bit(const onewire_bus_handle_t *bus)
  * 
  * @note Internal pull-up is disabled (external resistor required)
  * @note Bus is set to idle state (HIGH) after initialization
+ * @note Slot timing is calibrated to the measured line rise time
+ *       (standard timing without calibration with ONEWIRE_FIXED_TIMING)
  */
 esp_err_t onewire_bus_init(const onewire_bus_config_t *config, onewire_bus_handle_t *handle)
 {
@@ -125,13 +239,308 @@ esp_err_t onewire_bus_init(const onewire_bus_config_t *config, onewire_bus_handl
         return ret;
     }
     
+    memset(handle, 0, sizeof(*handle));
+    handle->state_lock = xSemaphoreCreateMutex();
+    if (!handle->state_lock) {
+        return ESP_ERR_NO_MEM;
+    }
+    for (int p = 0; p < ONEWIRE_BUS_PRIO_COUNT; p++) {
+        handle->grant[p] = xSemaphoreCreateBinary();
+        if (!handle->grant[p]) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    
+#ifdef CONFIG_PM_ENABLE
+    ret = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "onewire", &handle->cpu_lock);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+#endif
+    
     handle->pin = config->pin;
+    handle->timing = (onewire_timing_t)ONEWIRE_TIMING_DEFAULT();
+    handle->read_samples = 1;
     gpio_set_level(handle->pin, 1);
     
     ESP_LOGI(TAG, "OneWire bus initialized on GPIO%d", config->pin);
+#if !ONEWIRE_FIXED_TIMING
+    onewire_bus_calibrate(handle);
+#endif
+    return ESP_OK;
+}
+
+#if ONEWIRE_FIXED_TIMING
+esp_err_t onewire_bus_calibrate(onewire_bus_handle_t *bus)
+{
+    (void)bus;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+uint8_t onewire_bus_set_read_samples(onewire_bus_handle_t *bus, uint8_t samples)
+{
+    (void)bus;
+    if (samples > 1) {
+        ESP_LOGW(TAG, "Fixed timing build: %u read samples requested, 1 used", samples);
+    }
+    return 1;
+}
+#else
+
+/**
+ * @brief Measure release-to-high time of the data line
+ * 
+ * Pulls the line low briefly, releases it and busy-polls the level with the
+ * CPU cycle counter. Slaves see the pulses as write-1 slots, so a reset
+ * follows to return them to a defined state.
+ * 
+ * @param bus Pointer to OneWire bus handle
+ * @return Worst rise time in µs (rounded up), UINT8_MAX if the line never rose
+ */
+uint8_t onewire_bus_measure_rise_us(onewire_bus_handle_t *bus)
+{
+    uint32_t ticks_per_us = esp_rom_get_cpu_ticks_per_us();
+    uint32_t worst = 0;
+    
+    for (int i = 0; i < RISE_SAMPLES; i++) {
+        int64_t suspended_at = esp_timer_get_time();
+        vTaskSuspendAll();
+        onewire_bus_drive(bus, 0);
+        esp_rom_delay_us(RISE_PULSE_LOW_US);
+        onewire_bus_drive(bus, 1);
+        uint32_t start = esp_cpu_get_cycle_count();
+        uint32_t elapsed = 0;
+        while (!gpio_get_level(bus->pin)) {
+            elapsed = esp_cpu_get_cycle_count() - start;
+            if (elapsed > RISE_TIMEOUT_US * ticks_per_us) {
+                break;
+            }
+        }
+        esp_rom_delay_us(bus->timing.write1_high_us);
+        xTaskResumeAll();
+        cpu_account_add(CPU_ACCOUNT_SUSPENDED, (uint32_t)(esp_timer_get_time() - suspended_at));
+        
+        if (elapsed > worst) {
+            worst = elapsed;
+        }
+    }
+    
+    onewire_bus_reset(bus);
+    
+    uint32_t rise_us = (worst + ticks_per_us - 1) / ticks_per_us;
+    return worst > RISE_TIMEOUT_US * ticks_per_us ? UINT8_MAX : (uint8_t)rise_us;
+}
+
+/**
+ * @brief Measure rise time and store calibrated slot timing in the bus handle
+ * 
+ * @param bus Pointer to OneWire bus handle
+ * @return ESP_OK if the calibrated timing meets the spec, ESP_ERR_INVALID_STATE
+ *         if the line is too slow (best-effort timing is still applied)
+ */
+esp_err_t onewire_bus_calibrate(onewire_bus_handle_t *bus)
+{
+    // Cycle counter ticks per µs must not change during the measurement
+    onewire_bus_lock_freq(bus);
+    uint8_t rise_us = onewire_bus_measure_rise_us(bus);
+    onewire_bus_unlock_freq(bus);
+    if (rise_us == UINT8_MAX) {
+        ESP_LOGW(TAG, "Line did not rise within %dus - check pull-up, keeping default timing", RISE_TIMEOUT_US);
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    onewire_timing_t timing;
+    bool within_spec = onewire_timing_calibrate(rise_us, &timing);
+    onewire_timing_set_read_samples(&timing, bus->read_samples);
+    bus->timing = timing;
+    
+    uint32_t write1_us, write0_us, read_us;
+    onewire_timing_slot_us(&timing, &write1_us, &write0_us, &read_us);
+    ESP_LOGI(TAG, "Rise time %uus: write1 %u/%u, write0 %u/%u, read %u+%u x%u (slots %u/%u/%uus)",
+             rise_us, timing.write1_low_us, timing.write1_high_us, timing.write0_low_us, timing.write0_high_us,
+             timing.read_low_us, timing.read_sample_us, timing.read_samples,
+             (unsigned)write1_us, (unsigned)write0_us, (unsigned)read_us);
+    
+    if (!within_spec) {
+        ESP_LOGW(TAG, "Rise time %uus exceeds %uus - use a stronger pull-up or shorter cable",
+                 rise_us, ONEWIRE_TIMING_MAX_RISE_US);
+        return ESP_ERR_INVALID_STATE;
+    }
     return ESP_OK;
 }
 
+/**
+ * @brief Set samples per read slot on top of the current (calibrated) timing
+ * 
+ * @param bus Pointer to OneWire bus handle
+ * @param samples Requested samples per slot
+ * @return Samples applied
+ */
+uint8_t onewire_bus_set_read_samples(onewire_bus_handle_t *bus, uint8_t samples)
+{
+    bus->read_samples = samples;
+    uint8_t applied = onewire_timing_set_read_samples(&bus->timing, samples);
+    if (applied != samples) {
+        ESP_LOGW(TAG, "%u read samples requested, %u fit rise time %uus", samples, applied, bus->timing.rise_us);
+    }
+    return applied;
+}
+#endif // ONEWIRE_FIXED_TIMING
+
+void onewire_bus_get_line_stats(const onewire_bus_handle_t *bus, onewire_bus_line_stats_t *stats)
+{
+    *stats = bus->line_stats;
+}
+
+/**
+ * @brief Attach trace ring to the bus
+ * 
+ * @param bus Pointer to OneWire bus handle
+ * @param trace Trace ring, NULL stops tracing
+ */
+void onewire_bus_set_trace(onewire_bus_handle_t *bus, onewire_trace_t *trace)
+{
+    bus->trace = trace;
+}
+
+/**
+ * @brief Log the trace export stream as hex lines ("OWTRACE <hex>")
+ * 
+ * Capture the monitor output and convert it with
+ * `onewire_trace_tool -o trace.vcd monitor.log`.
+ * 
+ * @param bus Pointer to OneWire bus handle
+ */
+void onewire_bus_trace_dump(const onewire_bus_handle_t *bus)
+{
+#if ONEWIRE_TRACE_ENABLED
+    uint8_t chunk[TRACE_DUMP_CHUNK];
+    char hex[2 * TRACE_DUMP_CHUNK + 1];
+    size_t offset = 0;
+    size_t n;
+    
+    if (!bus->trace) {
+        return;
+    }
+    
+    ESP_LOGI(TAG, "Trace dump: %u events (%u bytes)", (unsigned)onewire_trace_count(bus->trace),
+             (unsigned)onewire_trace_export_len(bus->trace));
+    while ((n = onewire_trace_export(bus->trace, (uint16_t)esp_rom_get_cpu_ticks_per_us(), offset,
+                                     chunk, sizeof(chunk))) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            static const char digits[] = "0123456789abcdef";
+            hex[2 * i] = digits[chunk[i] >> 4];
+            hex[2 * i + 1] = digits[chunk[i] & 0x0F];
+        }
+        hex[2 * n] = '\0';
+        ESP_LOGI(TAG, "OWTRACE %s", hex);
+        offset += n;
+    }
+    ESP_LOGI(TAG, "Trace dump end");
+#else
+    (void)bus;
+    ESP_LOGW(TAG, "Trace not compiled in (build with -DONEWIRE_TRACE=1)");
+#endif
+}
+
+/**
+ * @brief Record wait time of a successful acquisition (state lock held)
+ */
+static void onewire_bus_account(onewire_bus_handle_t *bus, onewire_bus_prio_t prio, int64_t start_us)
+{
+    int64_t now_us = esp_timer_get_time();
+    uint32_t waited = (uint32_t)(now_us - start_us);
+    bus->hold_start_us = now_us;
+    bus->stats.acquisitions[prio]++;
+    if (waited > bus->stats.max_wait_us[prio]) {
+        bus->stats.max_wait_us[prio] = waited;
+    }
+}
+
+/**
+ * @brief Acquire exclusive bus access
+ * 
+ * Free bus: taken immediately. Busy bus: the caller registers as waiter of
+ * its priority and blocks on that priority's grant semaphore until
+ * onewire_bus_release() hands ownership over, or the timeout expires.
+ * 
+ * @param bus Pointer to OneWire bus handle
+ * @param prio Client priority
+ * @param timeout_ms Maximum wait time in milliseconds
+ * @return ESP_OK when the bus is held, ESP_ERR_TIMEOUT otherwise
+ * 
+ * @note A grant that races with the timeout is still honoured, so ownership
+ *       is never lost
+ */
+esp_err_t onewire_bus_acquire(onewire_bus_handle_t *bus, onewire_bus_prio_t prio, uint32_t timeout_ms)
+{
+    int64_t start_us = esp_timer_get_time();
+    
+    xSemaphoreTake(bus->state_lock, portMAX_DELAY);
+    if (!bus->owned) {
+        bus->owned = true;
+        onewire_bus_lock_freq(bus);
+        onewire_bus_account(bus, prio, start_us);
+        xSemaphoreGive(bus->state_lock);
+        return ESP_OK;
+    }
+    bus->waiting[prio]++;
+    xSemaphoreGive(bus->state_lock);
+    
+    TickType_t ticks = timeout_ms == portMAX_DELAY ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    bool granted = xSemaphoreTake(bus->grant[prio], ticks) == pdTRUE;
+    
+    xSemaphoreTake(bus->state_lock, portMAX_DELAY);
+    if (!granted) {
+        // Release may have granted this priority right after the timeout
+        granted = xSemaphoreTake(bus->grant[prio], 0) == pdTRUE;
+        if (!granted) {
+            bus->waiting[prio]--;
+            bus->stats.timeouts[prio]++;
+        }
+    }
+    if (granted) {
+        onewire_bus_account(bus, prio, start_us);
+    }
+    xSemaphoreGive(bus->state_lock);
+    
+    return granted ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+/**
+ * @brief Release bus
+ * 
+ * Hands ownership directly to a waiter of the highest waiting priority;
+ * the bus only becomes free when nobody waits.
+ * 
+ * @param bus Pointer to OneWire bus handle
+ */
+void onewire_bus_release(onewire_bus_handle_t *bus)
+{
+    // Owner spun in slot timing for the whole hold
+    cpu_account_add(CPU_ACCOUNT_BUSY_WAIT, (uint32_t)(esp_timer_get_time() - bus->hold_start_us));
+    
+    xSemaphoreTake(bus->state_lock, portMAX_DELAY);
+    for (int p = ONEWIRE_BUS_PRIO_COUNT - 1; p >= 0; p--) {
+        if (bus->waiting[p] > 0) {
+            bus->waiting[p]--;
+            xSemaphoreGive(bus->grant[p]);
+            xSemaphoreGive(bus->state_lock);
+            return;
+        }
+    }
+    bus->owned = false;
+    onewire_bus_unlock_freq(bus);
+    xSemaphoreGive(bus->state_lock);
+}
+
+void onewire_bus_get_stats(onewire_bus_handle_t *bus, onewire_bus_stats_t *stats)
+{
+    xSemaphoreTake(bus->state_lock, portMAX_DELAY);
+    *stats = bus->stats;
+    xSemaphoreGive(bus->state_lock);
+}
+
 /**
  * @brief Perform 1-Wire bus reset and presence detect
  * 
@@ -150,13 +559,15 @@ esp_err_t onewire_bus_init(const onewire_bus_config_t *config, onewire_bus_handl
  */
 bool onewire_bus_reset(const onewire_bus_handle_t *bus)
 {
-    gpio_set_level(bus->pin, 0);
-    esp_rom_delay_us(RESET_DELAY_US);
-    gpio_set_level(bus->pin, 1);
-    esp_rom_delay_us(PRESENCE_DELAY_US);
+    const onewire_timing_t *t = BUS_TIMING(bus);
     
-    bool presence = !gpio_get_level(bus->pin);
-    esp_rom_delay_us(410);
+    onewire_bus_drive(bus, 0);
+    esp_rom_delay_us(t->reset_low_us);
+    onewire_bus_drive(bus, 1);
+    esp_rom_delay_us(t->presence_sample_us);
+    
+    bool presence = !onewire_bus_sample(bus);
+    esp_rom_delay_us(t->reset_recovery_us);
     
     return presence;
 }
@@ -190,7 +601,7 @@ void onewire_bus_write_byte(const onewire_bus_handle_t *bus, uint8_t data)
  * 
  * @note 1-Wire protocol uses LSB-first bit order
  */
-uint8_t onewire_bus_read_byte(const onewire_bus_handle_t *bus)
+uint8_t onewire_bus_read_byte(onewire_bus_handle_t *bus)
 {
     uint8_t data = 0;
     for (int i = 0; i < 8; i++) {
@@ -201,8 +612,21 @@ uint8_t onewire_bus_read_byte(const onewire_bus_handle_t *bus)
     return data;
 }
 
+#if ONEWIRE_SEARCH_ENABLED
+/**
+ * @brief Start new enumeration with caller-owned search state
+ * 
+ * @param state Pointer to search state
+ */
+void onewire_bus_search_reset(onewire_search_state_t *state)
+{
+    memset(state->last_rom, 0, sizeof(state->last_rom));
+    state->last_discrepancy = 0;
+    state->last_device_flag = false;
+}
+
 /**
- * @brief Search for 1-Wire devices on the bus (ROM Search Algorithm)
+ * @brief Search for next 1-Wire device on the bus (ROM Search Algorithm)
  * 
  * Implements Dallas/Maxim ROM Search algorithm to enumerate all devices.
  * Each device has a unique 64-bit ROM code:
@@ -219,27 +643,16 @@ uint8_t onewire_bus_read_byte(const onewire_bus_handle_t *bus)
  * 3. Continue until all devices found
  * 
  * @param bus Pointer to OneWire bus handle
+ * @param state Search state (between calls the bus may be used by others)
  * @param rom_code Pointer to 8-byte buffer for ROM code result
- * @param search_mode false = start new search, true = continue previous search
  * @return true if device found, false if search complete
  * 
- * @note Call repeatedly with search_mode=true to find all devices
- * @note Static variables maintain search state between calls
+ * @note Call repeatedly to find all devices
  * @note Returns false when all devices have been enumerated
  */
-bool onewire_bus_search(onewire_bus_handle_t *bus, uint8_t *rom_code, bool search_mode)
+bool onewire_bus_search_next(onewire_bus_handle_t *bus, onewire_search_state_t *state, uint8_t *rom_code)
 {
-    static uint8_t last_rom[8];
-    static int last_discrepancy = 0;
-    static bool last_device_flag = false;
-    
-    if (!search_mode) {
-        last_discrepancy = 0;
-        last_device_flag = false;
-        memset(last_rom, 0, 8);
-    }
-    
-    if (last_device_flag) {
+    if (state->last_device_flag) {
         return false;
     }
     
@@ -257,6 +670,7 @@ bool onewire_bus_search(onewire_bus_handle_t *bus, uint8_t *rom_code, bool searc
     bool search_result = false;
     uint8_t id_bit, cmp_id_bit;
     uint8_t search_direction;
+    uint8_t *last_rom = state->last_rom;
     
     while (rom_byte_number < 8) {
         id_bit = onewire_bus_read_bit(bus);
@@ -269,10 +683,10 @@ bool onewire_bus_search(onewire_bus_handle_t *bus, uint8_t *rom_code, bool searc
         if (id_bit != cmp_id_bit) {
             search_direction = id_bit;
         } else {
-            if (id_bit_number < last_discrepancy) {
+            if (id_bit_number < state->last_discrepancy) {
                 search_direction = ((last_rom[rom_byte_number] & rom_byte_mask) > 0);
             } else {
-                search_direction = (id_bit_number == last_discrepancy);
+                search_direction = (id_bit_number == state->last_discrepancy);
             }
             
             if (search_direction == 0) {
@@ -298,10 +712,10 @@ bool onewire_bus_search(onewire_bus_handle_t *bus, uint8_t *rom_code, bool searc
     }
     
     if (id_bit_number >= 65) {
-        last_discrepancy = last_zero;
+        state->last_discrepancy = last_zero;
         
-        if (last_discrepancy == 0) {
-            last_device_flag = true;
+        if (state->last_discrepancy == 0) {
+            state->last_device_flag = true;
         }
         
         search_result = true;
@@ -314,6 +728,65 @@ bool onewire_bus_search(onewire_bus_handle_t *bus, uint8_t *rom_code, bool searc
     return search_result;
 }
 
+/**
+ * @brief Search for 1-Wire devices on the bus using shared search state
+ * 
+ * @param bus Pointer to OneWire bus handle
+ * @param rom_code Pointer to 8-byte buffer for ROM code result
+ * @param search_mode false = start new search, true = continue previous search
+ * @return true if device found, false if search complete
+ * 
+ * @note Static search state, see onewire_bus_search_next() for a reentrant variant
+ */
+bool onewire_bus_search(onewire_bus_handle_t *bus, uint8_t *rom_code, bool search_mode)
+{
+    static onewire_search_state_t state;
+    
+    if (!search_mode) {
+        onewire_bus_search_reset(&state);
+    }
+    
+    return onewire_bus_search_next(bus, &state, rom_code);
+}
+
+/**
+ * @brief Verify presence of one device by a search pass along its ROM
+ * 
+ * Per bit, devices answer with the bit and its complement. If no remaining
+ * device has the expected bit value (both reads 1, or only the opposite
+ * value answered) the device is missing. Writing the expected bit keeps only
+ * devices matching the ROM prefix in the search.
+ * 
+ * @param bus Pointer to OneWire bus handle
+ * @param rom Pointer to 8-byte ROM code
+ * @return true if the device is present
+ * 
+ * @note Costs one reset and 64 × 3 time slots (~14ms), same as one search step
+ */
+bool onewire_bus_verify_rom(onewire_bus_handle_t *bus, const uint8_t *rom)
+{
+    if (!onewire_bus_reset(bus)) {
+        return false;
+    }
+    
+    onewire_bus_write_byte(bus, 0xF0); // SEARCH ROM
+    
+    for (int i = 0; i < 64; i++) {
+        bool expected = (rom[i / 8] >> (i % 8)) & 0x01;
+        bool id_bit = onewire_bus_read_bit(bus);
+        bool cmp_id_bit = onewire_bus_read_bit(bus);
+        
+        if ((id_bit && cmp_id_bit) || (id_bit != cmp_id_bit && id_bit != expected)) {
+            return false;
+        }
+        
+        onewire_bus_write_bit(bus, expected);
+    }
+    
+    return true;
+}
+#endif // ONEWIRE_SEARCH_ENABLED
+
 /**
  * @brief Calculate CRC8 checksum for 1-Wire data
  * 
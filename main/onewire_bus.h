@@ -7,6 +7,21 @@
  * @details
  * Public API for 1-Wire bus operations.
  * Supports device enumeration, data transfer, and CRC validation.
+ * 
+ * Bus arbitration: every transaction (reset ... last byte) must run between
+ * onewire_bus_acquire() and onewire_bus_release(). Waiting clients are served
+ * strictly by priority, FIFO-ish within a priority, and each waits at most
+ * its own timeout. Clients release the bus during long idle phases (e.g. the
+ * 750 ms DS18B20 conversion), so a single hold is one transaction (~15 ms).
+ * 
+ * Frequency scaling: with CONFIG_PM_ENABLE the bus holds a CPU_FREQ_MAX lock
+ * from acquire until the bus is free again, so slot delays are never stretched
+ * by a frequency switch; between transactions the CPU may scale down.
+ * 
+ * Compile-time specialization (set from Kconfig by main/CMakeLists.txt):
+ * ONEWIRE_SEARCH_ENABLED=0 drops ROM search and verification for single
+ * sensor SKIP ROM builds, ONEWIRE_FIXED_TIMING=1 replaces calibration with
+ * standard timing constants that fold into the slot delays.
  */
 
 #ifndef ONEWIRE_BUS_H
@@ -14,7 +29,21 @@
 
 #include "driver/gpio.h"
 #include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "onewire_timing.h"
+#include "onewire_trace.h"
 #include <stdbool.h>
+#ifdef CONFIG_PM_ENABLE
+#include "esp_pm.h"
+#endif
+
+#ifndef ONEWIRE_SEARCH_ENABLED
+#define ONEWIRE_SEARCH_ENABLED  1       ///< ROM search and verification (0 with CONFIG_THERMO_SKIP_ROM)
+#endif
+#ifndef ONEWIRE_FIXED_TIMING
+#define ONEWIRE_FIXED_TIMING    0       ///< Standard slot timing as constants, no calibration or oversampling
+#endif
 
 /**
  * @brief 1-Wire bus configuration structure
@@ -23,11 +52,61 @@ typedef struct {
     gpio_num_t pin;  ///< GPIO pin number for 1-Wire data line
 } onewire_bus_config_t;
 
+/**
+ * @brief Bus client priority (higher value is served first)
+ */
+typedef enum {
+    ONEWIRE_BUS_PRIO_BACKGROUND = 0,    ///< Rescans, diagnostics
+    ONEWIRE_BUS_PRIO_PERIODIC,          ///< Regular measurement cycle
+    ONEWIRE_BUS_PRIO_ON_DEMAND,         ///< Out-of-cycle reads requested over Zigbee
+    ONEWIRE_BUS_PRIO_COUNT,
+} onewire_bus_prio_t;
+
+/**
+ * @brief Arbitration statistics per priority
+ */
+typedef struct {
+    uint32_t acquisitions[ONEWIRE_BUS_PRIO_COUNT];  ///< Successful acquisitions
+    uint32_t timeouts[ONEWIRE_BUS_PRIO_COUNT];      ///< Acquisitions that timed out
+    uint32_t max_wait_us[ONEWIRE_BUS_PRIO_COUNT];   ///< Longest wait for the bus
+} onewire_bus_stats_t;
+
+/**
+ * @brief Line quality counters of oversampled reads
+ */
+typedef struct {
+    uint32_t read_bits;             ///< Read slots
+    uint32_t noisy_bits;            ///< Read slots whose samples disagreed
+    uint32_t minority_samples;      ///< Samples outvoted by the majority
+} onewire_bus_line_stats_t;
+
+/**
+ * @brief ROM search state (one per enumeration, lets callers release the bus between devices)
+ */
+typedef struct {
+    uint8_t last_rom[8];        ///< ROM found by previous step
+    int last_discrepancy;       ///< Bit position of last unresolved branch
+    bool last_device_flag;      ///< Enumeration complete
+} onewire_search_state_t;
+
 /**
  * @brief 1-Wire bus handle structure
  */
 typedef struct {
     gpio_num_t pin;  ///< GPIO pin number for 1-Wire data line
+    onewire_timing_t timing;                                ///< Calibrated slot timing
+    uint8_t read_samples;                                   ///< Requested samples per read slot
+    onewire_bus_line_stats_t line_stats;                    ///< Read sample disagreement counters
+    onewire_trace_t *trace;                                 ///< Edge trace ring (NULL = off)
+    SemaphoreHandle_t state_lock;                           ///< Guards owner/waiter state
+    SemaphoreHandle_t grant[ONEWIRE_BUS_PRIO_COUNT];        ///< Ownership hand-over per priority
+    bool owned;                                             ///< Bus currently held by a client
+    int64_t hold_start_us;                                  ///< Time the current owner got the bus
+    uint8_t waiting[ONEWIRE_BUS_PRIO_COUNT];                ///< Blocked clients per priority
+    onewire_bus_stats_t stats;                              ///< Arbitration statistics
+#ifdef CONFIG_PM_ENABLE
+    esp_pm_lock_handle_t cpu_lock;                          ///< Max CPU frequency while the bus is held
+#endif
 } onewire_bus_handle_t;
 
 /**
@@ -38,6 +117,81 @@ typedef struct {
  */
 esp_err_t onewire_bus_init(const onewire_bus_config_t *config, onewire_bus_handle_t *handle);
 
+#if !ONEWIRE_FIXED_TIMING
+/**
+ * @brief Measure line rise time (µs, rounded up)
+ * @param bus Bus handle
+ * @return Worst of several measurements, UINT8_MAX if the line stays low
+ */
+uint8_t onewire_bus_measure_rise_us(onewire_bus_handle_t *bus);
+#endif
+
+/**
+ * @brief Measure rise time and apply calibrated slot timing (called by onewire_bus_init)
+ * @param bus Bus handle
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if the line is too slow for the spec,
+ *         ESP_ERR_NOT_SUPPORTED with ONEWIRE_FIXED_TIMING
+ */
+esp_err_t onewire_bus_calibrate(onewire_bus_handle_t *bus);
+
+/**
+ * @brief Enable majority-vote reads with several samples per read slot
+ * @param bus Bus handle
+ * @param samples Samples per slot (1 = single sample, 3 or 5 = majority vote)
+ * @return Samples applied; fewer than requested if the line is too slow for the window
+ *         (always 1 with ONEWIRE_FIXED_TIMING)
+ * 
+ * @note Call while holding the bus or before other clients use it;
+ *       the setting survives onewire_bus_calibrate()
+ */
+uint8_t onewire_bus_set_read_samples(onewire_bus_handle_t *bus, uint8_t samples);
+
+/**
+ * @brief Copy read sample disagreement counters (meaningful with oversampling only)
+ * @param bus Bus handle
+ * @param stats Output statistics
+ */
+void onewire_bus_get_line_stats(const onewire_bus_handle_t *bus, onewire_bus_line_stats_t *stats);
+
+/**
+ * @brief Record drive/sample events into a trace ring (needs ONEWIRE_TRACE_ENABLED)
+ * @param bus Bus handle
+ * @param trace Trace ring, NULL stops tracing
+ */
+void onewire_bus_set_trace(onewire_bus_handle_t *bus, onewire_trace_t *trace);
+
+/**
+ * @brief Log the trace as "OWTRACE <hex>" lines for host/onewire_trace_tool
+ * @param bus Bus handle
+ * 
+ * @note Hold the bus while dumping so the ring is not written meanwhile
+ */
+void onewire_bus_trace_dump(const onewire_bus_handle_t *bus);
+
+/**
+ * @brief Acquire exclusive bus access
+ * @param bus Bus handle
+ * @param prio Client priority
+ * @param timeout_ms Maximum wait time
+ * @return ESP_OK when the bus is held, ESP_ERR_TIMEOUT otherwise
+ * 
+ * @note Must not be called with the scheduler suspended
+ */
+esp_err_t onewire_bus_acquire(onewire_bus_handle_t *bus, onewire_bus_prio_t prio, uint32_t timeout_ms);
+
+/**
+ * @brief Release bus, handing it to the highest-priority waiter
+ * @param bus Bus handle
+ */
+void onewire_bus_release(onewire_bus_handle_t *bus);
+
+/**
+ * @brief Copy arbitration statistics
+ * @param bus Bus handle
+ * @param stats Output statistics
+ */
+void onewire_bus_get_stats(onewire_bus_handle_t *bus, onewire_bus_stats_t *stats);
+
 /**
  * @brief Reset 1-Wire bus and detect device presence
  * @param bus Bus handle
@@ -57,17 +211,48 @@ void onewire_bus_write_byte(const onewire_bus_handle_t *bus, uint8_t data);
  * @param bus Bus handle
  * @return Byte read from bus
  */
-uint8_t onewire_bus_read_byte(const onewire_bus_handle_t *bus);
+uint8_t onewire_bus_read_byte(onewire_bus_handle_t *bus);
 
+#if ONEWIRE_SEARCH_ENABLED
 /**
  * @brief Search for devices on 1-Wire bus
  * @param bus Bus handle
  * @param rom_code 8-byte ROM code result
  * @param search_mode false=new search, true=continue
  * @return true if device found
+ * 
+ * @note Search state is shared; hold the bus for the whole enumeration
  */
 bool onewire_bus_search(onewire_bus_handle_t *bus, uint8_t *rom_code, bool search_mode);
 
+/**
+ * @brief Start new enumeration with caller-owned search state
+ * @param state Search state
+ */
+void onewire_bus_search_reset(onewire_search_state_t *state);
+
+/**
+ * @brief Find next device using caller-owned search state (one bus transaction)
+ * @param bus Bus handle
+ * @param state Search state
+ * @param rom_code 8-byte ROM code result
+ * @return true if device found, false if enumeration complete or no presence
+ */
+bool onewire_bus_search_next(onewire_bus_handle_t *bus, onewire_search_state_t *state, uint8_t *rom_code);
+
+/**
+ * @brief Check that one known device is still on the bus (targeted search)
+ * 
+ * Walks the search tree along the given ROM only, so verifying one device
+ * costs a single search pass regardless of how many devices share the bus.
+ * 
+ * @param bus Bus handle
+ * @param rom 8-byte ROM code to verify
+ * @return true if the device answered every bit of its ROM
+ */
+bool onewire_bus_verify_rom(onewire_bus_handle_t *bus, const uint8_t *rom);
+#endif
+
 /**
  * @brief Calculate CRC8 checksum (Dallas/Maxim)
  * @param data Data buffer
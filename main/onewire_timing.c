@@ -0,0 +1,98 @@
+/**
+ * @file onewire_timing.c
+ * @brief 1-Wire slot timing derived from measured line rise time
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Spec limits used (standard speed):
+ * - Time slot ≥ 60 µs, recovery ≥ 1 µs between slots
+ * - Write 1 low 1..15 µs, write 0 low 60..120 µs, slave samples 15..60 µs
+ * - Read: master releases after ≥ 1 µs, slave data valid until 15 µs
+ * - Presence pulse starts 15..60 µs after the rising edge, lasts 60..240 µs
+ * - Reset: low ≥ 480 µs, then ≥ 480 µs until the next slot
+ */
+
+#include "onewire_timing.h"
+
+#define SLOT_MIN_US         60
+#define RECOVERY_MIN_US     1
+#define SLAVE_SAMPLE_MIN_US 15
+#define READ_VALID_US       15
+#define PRESENCE_MIN_US     60     ///< Latest presence start (after rising edge)
+#define PRESENCE_MAX_US     75     ///< Earliest presence end (15 µs start + 60 µs length)
+#define RESET_HIGH_US       480
+
+static uint8_t clamp_u8(int v, int lo, int hi)
+{
+    return (uint8_t)(v < lo ? lo : v > hi ? hi : v);
+}
+
+bool onewire_timing_calibrate(uint8_t rise_us, onewire_timing_t *timing)
+{
+    const onewire_timing_t defaults = ONEWIRE_TIMING_DEFAULT();
+    int settle = rise_us + ONEWIRE_TIMING_MARGIN_US;   // Release until line is reliably high
+
+    *timing = defaults;
+    timing->rise_us = rise_us;
+
+    // Write 1: line must be high again before the earliest slave sample
+    timing->write1_low_us = clamp_u8(SLAVE_SAMPLE_MIN_US - settle, 1, defaults.write1_low_us);
+    timing->write1_high_us = (uint8_t)(SLOT_MIN_US + RECOVERY_MIN_US - timing->write1_low_us);
+
+    // Write 0: full-length low, then wait until the line has risen
+    timing->write0_low_us = SLOT_MIN_US;
+    timing->write0_high_us = clamp_u8(settle, RECOVERY_MIN_US + 1, UINT8_MAX);
+
+    // Read: sample as soon as a released '1' has risen, within data valid time
+    timing->read_sample_us = (uint8_t)settle;
+    timing->read_low_us = clamp_u8(READ_VALID_US - 1 - settle, 1, defaults.read_low_us);
+    int sample_at = timing->read_low_us + timing->read_sample_us;
+    int slot_end = sample_at > SLOT_MIN_US ? sample_at : SLOT_MIN_US;
+    // Slave may hold a '0' until the slot end, then the line needs to rise again
+    timing->read_recovery_us = clamp_u8(slot_end - sample_at + settle, RECOVERY_MIN_US, UINT8_MAX);
+
+    // Presence: middle of the guaranteed window, then complete the 480 µs high phase
+    timing->presence_sample_us = (uint16_t)(rise_us + (PRESENCE_MIN_US + PRESENCE_MAX_US + 1) / 2);
+    timing->reset_recovery_us = (uint16_t)(RESET_HIGH_US + rise_us - timing->presence_sample_us);
+
+    return rise_us <= ONEWIRE_TIMING_MAX_RISE_US;
+}
+
+uint8_t onewire_timing_set_read_samples(onewire_timing_t *timing, uint8_t samples)
+{
+    const onewire_timing_t defaults = ONEWIRE_TIMING_DEFAULT();
+    int window = (timing->read_samples - 1) * ONEWIRE_TIMING_SAMPLE_GAP_US;
+    int slot = timing->read_low_us + timing->read_sample_us + window + timing->read_recovery_us;
+
+    samples = clamp_u8(samples, 1, ONEWIRE_TIMING_MAX_SAMPLES);
+    if (samples % 2 == 0) {
+        samples--;
+    }
+    // Shortest release (1 µs) + settle + window must end within data valid time
+    while (samples > 1 &&
+           1 + timing->read_sample_us + (samples - 1) * ONEWIRE_TIMING_SAMPLE_GAP_US > READ_VALID_US - 1) {
+        samples -= 2;
+    }
+
+    window = (samples - 1) * ONEWIRE_TIMING_SAMPLE_GAP_US;
+    timing->read_low_us = clamp_u8(READ_VALID_US - 1 - timing->read_sample_us - window, 1, defaults.read_low_us);
+    timing->read_recovery_us = clamp_u8(slot - timing->read_low_us - timing->read_sample_us - window,
+                                        RECOVERY_MIN_US, UINT8_MAX);
+    timing->read_samples = samples;
+    return samples;
+}
+
+void onewire_timing_slot_us(const onewire_timing_t *timing, uint32_t *write1_us, uint32_t *write0_us, uint32_t *read_us)
+{
+    if (write1_us) {
+        *write1_us = timing->write1_low_us + timing->write1_high_us;
+    }
+    if (write0_us) {
+        *write0_us = timing->write0_low_us + timing->write0_high_us;
+    }
+    if (read_us) {
+        *read_us = timing->read_low_us + timing->read_sample_us + timing->read_recovery_us +
+                   (timing->read_samples - 1) * ONEWIRE_TIMING_SAMPLE_GAP_US;
+    }
+}
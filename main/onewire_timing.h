@@ -0,0 +1,94 @@
+/**
+ * @file onewire_timing.h
+ * @brief 1-Wire slot timing derived from measured line rise time
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * The fixed standard-speed timings (6/9/55/64 µs, presence sample at 70 µs)
+ * assume a line that returns high within ~1 µs. On long cables the pull-up
+ * needs several µs, so a short write-1 pulse still reads as 0 at the slave
+ * and a read sample 15 µs into the slot sees a '1' as 0.
+ *
+ * onewire_timing_calibrate() places every master action relative to the
+ * measured rise time r, within the 1-Wire spec:
+ * - write 1: low ≤ 15 - r - margin, so the slave (sampling ≥ 15 µs) sees high
+ * - read: sample at r + margin after release, no later than 14 µs into slot
+ * - recovery after a released line: r + margin instead of a fixed gap
+ * - presence: sample in the middle of the guaranteed window [r + 60, r + 75]
+ *
+ * Good lines get shorter slots (~63 instead of 70 µs), slow lines get
+ * correct sample points. Pure arithmetic, no ESP-IDF dependencies.
+ *
+ * Oversampling: onewire_timing_set_read_samples() spreads an odd number of
+ * read samples 1 µs apart, starting at the calibrated sample point. The
+ * window is made room for by releasing the line earlier, so the last sample
+ * is still within the data valid time and the slot length is unchanged.
+ * Slow lines fall back to fewer samples.
+ */
+
+#ifndef ONEWIRE_TIMING_H
+#define ONEWIRE_TIMING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define ONEWIRE_TIMING_MARGIN_US    2      ///< Safety margin added to measured rise time
+#define ONEWIRE_TIMING_MAX_RISE_US  11     ///< Slowest line that still meets the 15 µs sample limit
+#define ONEWIRE_TIMING_SAMPLE_GAP_US 1     ///< Spacing of oversampled read samples
+#define ONEWIRE_TIMING_MAX_SAMPLES  5      ///< Most read samples per slot (odd)
+
+/**
+ * @brief Slot timing of one bus (all values in µs)
+ */
+typedef struct {
+    uint16_t reset_low_us;          ///< Reset pulse
+    uint16_t presence_sample_us;    ///< Presence sample after reset release
+    uint16_t reset_recovery_us;     ///< Remainder of reset sequence after sample
+    uint8_t write1_low_us;          ///< Write 1: low time
+    uint8_t write1_high_us;         ///< Write 1: released time incl. recovery
+    uint8_t write0_low_us;          ///< Write 0: low time
+    uint8_t write0_high_us;         ///< Write 0: recovery after release
+    uint8_t read_low_us;            ///< Read: low time (slot start)
+    uint8_t read_sample_us;         ///< Read: sample point after release
+    uint8_t read_recovery_us;       ///< Read: remainder of slot after last sample incl. recovery
+    uint8_t read_samples;           ///< Read: samples per slot (odd, majority vote)
+    uint8_t rise_us;                ///< Rise time the timing was derived from (0 = defaults)
+} onewire_timing_t;
+
+/**
+ * @brief Fixed standard-speed timing used before calibration
+ */
+#define ONEWIRE_TIMING_DEFAULT() { \
+    .reset_low_us = 480, .presence_sample_us = 70, .reset_recovery_us = 410, \
+    .write1_low_us = 6, .write1_high_us = 64, .write0_low_us = 60, .write0_high_us = 10, \
+    .read_low_us = 6, .read_sample_us = 9, .read_recovery_us = 55, .read_samples = 1, .rise_us = 0, \
+}
+
+/**
+ * @brief Derive slot timing from measured rise time
+ * @param rise_us Worst measured release-to-high time (rounded up)
+ * @param timing Output timing (always filled, best effort for slow lines)
+ * @return true if the timing meets the spec, false if the line is too slow
+ *         (rise_us > ONEWIRE_TIMING_MAX_RISE_US)
+ */
+bool onewire_timing_calibrate(uint8_t rise_us, onewire_timing_t *timing);
+
+/**
+ * @brief Set number of read samples per slot (keeps slot length)
+ * @param timing Timing to adjust (calibrated or default)
+ * @param samples Requested samples, rounded down to odd and capped at ONEWIRE_TIMING_MAX_SAMPLES
+ * @return Samples applied (fewer than requested if the window does not fit the line)
+ */
+uint8_t onewire_timing_set_read_samples(onewire_timing_t *timing, uint8_t samples);
+
+/**
+ * @brief Bus time of one write-1, write-0 and read slot
+ * @param timing Timing
+ * @param write1_us Output: write 1 slot length (may be NULL)
+ * @param write0_us Output: write 0 slot length (may be NULL)
+ * @param read_us Output: read slot length (may be NULL)
+ */
+void onewire_timing_slot_us(const onewire_timing_t *timing, uint32_t *write1_us, uint32_t *write0_us, uint32_t *read_us);
+
+#endif // ONEWIRE_TIMING_H
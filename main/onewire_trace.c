@@ -0,0 +1,64 @@
+/**
+ * @file onewire_trace.c
+ * @brief 1-Wire edge trace ring and its compact binary export format
+ * @version 1.2.0
+ * @date 2026-10-18
+ */
+
+#include "onewire_trace.h"
+#include <string.h>
+
+_Static_assert((ONEWIRE_TRACE_LEN & (ONEWIRE_TRACE_LEN - 1)) == 0, "ONEWIRE_TRACE_LEN must be a power of 2");
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+void onewire_trace_clear(onewire_trace_t *trace)
+{
+    memset(trace, 0, sizeof(*trace));
+}
+
+uint32_t onewire_trace_count(const onewire_trace_t *trace)
+{
+    return trace->total < ONEWIRE_TRACE_LEN ? trace->total : ONEWIRE_TRACE_LEN;
+}
+
+size_t onewire_trace_export_len(const onewire_trace_t *trace)
+{
+    return ONEWIRE_TRACE_HEADER_LEN + 4 * (size_t)onewire_trace_count(trace);
+}
+
+size_t onewire_trace_export(const onewire_trace_t *trace, uint16_t ticks_per_us, size_t offset,
+                            uint8_t *buf, size_t buf_len)
+{
+    uint32_t count = onewire_trace_count(trace);
+    uint32_t first = trace->total - count;
+    size_t total_len = onewire_trace_export_len(trace);
+    size_t n = 0;
+
+    uint8_t header[ONEWIRE_TRACE_HEADER_LEN] = {0};
+    put_u32(header, ONEWIRE_TRACE_MAGIC);
+    header[4] = ONEWIRE_TRACE_VERSION;
+    header[6] = (uint8_t)ticks_per_us;
+    header[7] = (uint8_t)(ticks_per_us >> 8);
+    put_u32(header + 8, count);
+    put_u32(header + 12, first);
+
+    while (n < buf_len && offset < total_len) {
+        if (offset < ONEWIRE_TRACE_HEADER_LEN) {
+            buf[n] = header[offset];
+        } else {
+            size_t pos = offset - ONEWIRE_TRACE_HEADER_LEN;
+            uint32_t word = trace->events[(first + pos / 4) & (ONEWIRE_TRACE_LEN - 1)];
+            buf[n] = (uint8_t)(word >> (8 * (pos % 4)));
+        }
+        n++;
+        offset++;
+    }
+    return n;
+}
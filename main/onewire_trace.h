@@ -0,0 +1,103 @@
+/**
+ * @file onewire_trace.h
+ * @brief 1-Wire edge trace ring and its compact binary export format
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Opt-in logic analyzer replacement: with ONEWIRE_TRACE_ENABLED the bus
+ * driver records every drive change and every read sample into a fixed RAM
+ * ring. Recording costs one cycle counter read and one store, so the slot
+ * timing being traced is not disturbed.
+ *
+ * Event word (32 bits): CPU cycle count with the two low bits replaced by
+ * the event type (12.5 ns resolution at 160 MHz, wraps every ~26 s).
+ *
+ * Export stream (little endian), converted to VCD and checked against the
+ * 1-Wire spec by host/onewire_trace_tool:
+ * - [0..3]   magic "OWT1"
+ * - [4]      format version (1)
+ * - [5]      reserved (0)
+ * - [6..7]   CPU ticks per µs at export time
+ * - [8..11]  event count N
+ * - [12..15] events lost to ring overwrite before the oldest exported one
+ * - N × event word, oldest first
+ *
+ * Pure module (no ESP-IDF dependencies).
+ */
+
+#ifndef ONEWIRE_TRACE_H
+#define ONEWIRE_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef ONEWIRE_TRACE_ENABLED
+#define ONEWIRE_TRACE_ENABLED   0       ///< Build with -DONEWIRE_TRACE=1 (idf.py) to record bus edges
+#endif
+
+#define ONEWIRE_TRACE_LEN       2048    ///< Events in ring (power of 2, 8 KB)
+#define ONEWIRE_TRACE_MAGIC     0x3154574Fu     ///< "OWT1"
+#define ONEWIRE_TRACE_VERSION   1
+#define ONEWIRE_TRACE_HEADER_LEN 16
+
+/**
+ * @brief Traced event type (low two bits of event word)
+ */
+typedef enum {
+    ONEWIRE_TRACE_DRIVE_LOW = 0,    ///< Master pulls line low
+    ONEWIRE_TRACE_RELEASE,          ///< Master releases line
+    ONEWIRE_TRACE_SAMPLE_0,         ///< Master sampled low
+    ONEWIRE_TRACE_SAMPLE_1,         ///< Master sampled high
+} onewire_trace_event_t;
+
+#define ONEWIRE_TRACE_WORD_TYPE(w)      ((onewire_trace_event_t)((w) & 3u))
+#define ONEWIRE_TRACE_WORD_CYCLES(w)    ((w) & ~3u)
+
+/**
+ * @brief Trace ring (single writer: the bus owner)
+ */
+typedef struct {
+    uint32_t events[ONEWIRE_TRACE_LEN];
+    uint32_t total;                 ///< Events recorded since clear (wraps the ring)
+} onewire_trace_t;
+
+/**
+ * @brief Clear trace
+ */
+void onewire_trace_clear(onewire_trace_t *trace);
+
+/**
+ * @brief Record event
+ * @param trace Trace ring
+ * @param type Event type
+ * @param cycles CPU cycle count at the event
+ */
+static inline void onewire_trace_record(onewire_trace_t *trace, onewire_trace_event_t type, uint32_t cycles)
+{
+    trace->events[trace->total++ & (ONEWIRE_TRACE_LEN - 1)] = ONEWIRE_TRACE_WORD_CYCLES(cycles) | type;
+}
+
+/**
+ * @brief Number of events held in the ring
+ */
+uint32_t onewire_trace_count(const onewire_trace_t *trace);
+
+/**
+ * @brief Total size of the export stream in bytes
+ */
+size_t onewire_trace_export_len(const onewire_trace_t *trace);
+
+/**
+ * @brief Copy part of the export stream (lets callers stream it in small chunks)
+ * @param trace Trace ring (must not be recorded into meanwhile)
+ * @param ticks_per_us CPU ticks per µs stored in the header
+ * @param offset Stream offset to start at
+ * @param buf Output buffer
+ * @param buf_len Output buffer size
+ * @return Bytes copied, 0 at end of stream
+ */
+size_t onewire_trace_export(const onewire_trace_t *trace, uint16_t ticks_per_us, size_t offset,
+                            uint8_t *buf, size_t buf_len);
+
+#endif // ONEWIRE_TRACE_H
@@ -0,0 +1,113 @@
+/**
+ * @file reading_cache.c
+ * @brief Per-sensor last reading with timestamp and on-demand refresh requests
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Shared by the sensor task (writer, on every attribute write) and the
+ * Zigbee task (reader). The 64-bit timestamp is not atomic on the
+ * ESP32-C6, so all accesses are short spinlock critical sections.
+ */
+
+#include "reading_cache.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+_Static_assert(SENSOR_MAX_COUNT <= 32, "refresh mask holds 32 slots");
+
+typedef struct {
+    int64_t stored_us;      ///< esp_timer time of last store (0 = never)
+    int16_t value;          ///< Centidegrees
+} reading_cache_entry_t;
+
+static portMUX_TYPE cache_lock = portMUX_INITIALIZER_UNLOCKED;
+static reading_cache_entry_t cache[SENSOR_MAX_COUNT];
+static uint32_t refresh_mask;
+
+void reading_cache_init(void)
+{
+    portENTER_CRITICAL(&cache_lock);
+    for (uint8_t i = 0; i < SENSOR_MAX_COUNT; i++) {
+        cache[i].stored_us = 0;
+    }
+    refresh_mask = 0;
+    portEXIT_CRITICAL(&cache_lock);
+}
+
+void reading_cache_store(uint8_t slot, int16_t value)
+{
+    if (slot >= SENSOR_MAX_COUNT) {
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&cache_lock);
+    cache[slot].value = value;
+    cache[slot].stored_us = now > 0 ? now : 1;
+    refresh_mask &= ~(1u << slot);
+    portEXIT_CRITICAL(&cache_lock);
+}
+
+bool reading_cache_get(uint8_t slot, int16_t *value, uint32_t *age_ms)
+{
+    if (slot >= SENSOR_MAX_COUNT) {
+        return false;
+    }
+
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&cache_lock);
+    reading_cache_entry_t entry = cache[slot];
+    portEXIT_CRITICAL(&cache_lock);
+
+    if (entry.stored_us == 0) {
+        return false;
+    }
+    if (value) {
+        *value = entry.value;
+    }
+    if (age_ms) {
+        *age_ms = (uint32_t)((now - entry.stored_us) / 1000);
+    }
+    return true;
+}
+
+bool reading_cache_request_refresh(uint8_t slot, uint32_t max_age_ms)
+{
+    if (slot >= SENSOR_MAX_COUNT) {
+        return false;
+    }
+
+    int64_t now = esp_timer_get_time();
+    bool requested = false;
+
+    portENTER_CRITICAL(&cache_lock);
+    bool stale = cache[slot].stored_us == 0 || now - cache[slot].stored_us > (int64_t)max_age_ms * 1000;
+    if (stale && !(refresh_mask & (1u << slot))) {
+        refresh_mask |= 1u << slot;
+        requested = true;
+    }
+    portEXIT_CRITICAL(&cache_lock);
+
+    return requested;
+}
+
+void reading_cache_cancel_refresh(uint8_t slot)
+{
+    if (slot >= SENSOR_MAX_COUNT) {
+        return;
+    }
+
+    portENTER_CRITICAL(&cache_lock);
+    refresh_mask &= ~(1u << slot);
+    portEXIT_CRITICAL(&cache_lock);
+}
+
+uint32_t reading_cache_pending(void)
+{
+    portENTER_CRITICAL(&cache_lock);
+    uint32_t mask = refresh_mask;
+    portEXIT_CRITICAL(&cache_lock);
+    return mask;
+}
@@ -0,0 +1,65 @@
+/**
+ * @file reading_cache.h
+ * @brief Per-sensor last reading with timestamp and on-demand refresh requests
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * The sensor task stores every value it writes to the ZCL temperature
+ * attribute here, so the age is the age of what a Read Attributes returns
+ * (the attribute is only written when a reading is reported). When a read
+ * arrives and that value is older than the allowed age, the Zigbee task
+ * marks the sensor for refresh instead of blocking on a conversion. A
+ * sensor stays marked until a new value is stored (or the refresh is
+ * cancelled), so bursts of reads cause at most one conversion.
+ */
+
+#ifndef READING_CACHE_H
+#define READING_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sensor_config.h"
+
+/**
+ * @brief Forget all cached values and pending refreshes
+ */
+void reading_cache_init(void);
+
+/**
+ * @brief Store value written to the attribute and clear its refresh request (sensor task)
+ * @param slot Sensor slot
+ * @param value Temperature in centidegrees
+ */
+void reading_cache_store(uint8_t slot, int16_t value);
+
+/**
+ * @brief Get cached reading
+ * @param slot Sensor slot
+ * @param value Output: temperature in centidegrees (may be NULL)
+ * @param age_ms Output: milliseconds since the value was stored (may be NULL)
+ * @return true if a value was ever stored for the slot
+ */
+bool reading_cache_get(uint8_t slot, int16_t *value, uint32_t *age_ms);
+
+/**
+ * @brief Request refresh if cached value is stale (Zigbee task, non-blocking)
+ * @param slot Sensor slot
+ * @param max_age_ms Maximum acceptable age
+ * @return true if a new refresh was requested, false if the value is fresh
+ *         or a refresh for the slot is already pending
+ */
+bool reading_cache_request_refresh(uint8_t slot, uint32_t max_age_ms);
+
+/**
+ * @brief Drop pending refresh request (conversion failed or no longer needed)
+ * @param slot Sensor slot
+ */
+void reading_cache_cancel_refresh(uint8_t slot);
+
+/**
+ * @brief Bit mask of slots with a pending refresh request
+ */
+uint32_t reading_cache_pending(void);
+
+#endif // READING_CACHE_H
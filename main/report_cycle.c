@@ -0,0 +1,27 @@
+/**
+ * @file report_cycle.c
+ * @brief Report mode: which frames one sensor cycle sends
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Pure logic (no ESP-IDF dependencies), shared with host/pipeline_bench.
+ */
+
+#include "report_cycle.h"
+
+void report_cycle_send(report_mode_t mode, const report_reason_t *reasons, const int16_t *values,
+                       uint8_t count, const report_cycle_sink_t *sink)
+{
+    bool packed_sent = false;
+
+    if (mode != REPORT_MODE_STANDARD) {
+        packed_sent = sink->send_packed(values, count, sink->arg);
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (reasons[i] != REPORT_REASON_NONE) {
+            sink->send_standard(i, mode != REPORT_MODE_PACKED || !packed_sent, sink->arg);
+        }
+    }
+}
@@ -0,0 +1,61 @@
+/**
+ * @file report_cycle.h
+ * @brief Report mode: which frames one sensor cycle sends
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Turns the per-sensor decision of report_policy into frames for the
+ * configured report mode. Sending is left to the caller's sink, so the
+ * firmware (ZCL attribute reports) and host/pipeline_bench (frame counts)
+ * run the same selection.
+ */
+
+#ifndef REPORT_CYCLE_H
+#define REPORT_CYCLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "report_policy.h"
+
+/**
+ * @brief Report mode (writable at runtime via cluster 0xFC00, persisted in NVS)
+ * 
+ * - STANDARD: One ZCL Temperature Measurement report per sensor endpoint (compatibility)
+ * - PACKED:   One manufacturer-specific frame with all sensors (least airtime)
+ * - BOTH:     Packed frame followed by standard reports
+ */
+typedef enum {
+    REPORT_MODE_STANDARD = 0,
+    REPORT_MODE_PACKED = 1,
+    REPORT_MODE_BOTH = 2,
+} report_mode_t;
+
+/**
+ * @brief Frame output of one cycle
+ */
+typedef struct {
+    /** Send all values in one packed frame; false if it did not go out */
+    bool (*send_packed)(const int16_t *values, uint8_t count, void *arg);
+    /** Store the value of a reported sensor; send_report false = attribute only (covered by the packed frame) */
+    void (*send_standard)(uint8_t sensor, bool send_report, void *arg);
+    void *arg;                      ///< Passed to both callbacks
+} report_cycle_sink_t;
+
+/**
+ * @brief Send the reports decided for one cycle
+ * 
+ * PACKED and BOTH send one packed frame with all sensors; every sensor
+ * with a reason then goes to send_standard, with a report in STANDARD and
+ * BOTH mode, and in PACKED mode only if the packed frame did not go out.
+ * 
+ * @param mode Report mode
+ * @param reasons Per sensor: report reason (REPORT_REASON_NONE = skip)
+ * @param values Per sensor: centidegrees (REPORT_FRAME_VALUE_INVALID if no reading)
+ * @param count Number of sensors
+ * @param sink Frame output
+ */
+void report_cycle_send(report_mode_t mode, const report_reason_t *reasons, const int16_t *values,
+                       uint8_t count, const report_cycle_sink_t *sink);
+
+#endif // REPORT_CYCLE_H
@@ -0,0 +1,82 @@
+/**
+ * @file report_frame.h
+ * @brief Compact binary frames carried by the manufacturer-specific cluster
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Frames are stored in octet-string attributes of cluster 0xFC00 and sent
+ * as ZCL attribute reports. Decoded by esp32c6_thermometer.js.
+ *
+ * Common header:
+ * - [0] frame type
+ * - [1] frame sequence number (wraps, lets the receiver detect gaps)
+ * - [2] sensor count N
+ * - [3] record count M
+ *
+ * History batch (REPORT_FRAME_TYPE_HISTORY), after header:
+ * - [4..7] age of oldest record in seconds (uint32 LE, relative to send time)
+ * - M records, each: varint(time delta to previous record, 0 for first)
+ *   followed by N × zigzag varint(value delta to previous record, first
+ *   record relative to 0). Values are centidegrees, deltas wrap mod 2^16,
+ *   -32768 marks a missing reading.
+ *
+ * Packed readings (REPORT_FRAME_TYPE_READINGS), after header (M = 1):
+ * - N × int16 LE current temperature in centidegrees (-32768 = no reading)
+ *
+ * One packed frame replaces N separate per-endpoint ZCL reports.
+ */
+
+#ifndef REPORT_FRAME_H
+#define REPORT_FRAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sensor_config.h"
+
+#define REPORT_FRAME_TYPE_HISTORY   0x01
+#define REPORT_FRAME_TYPE_READINGS  0x02
+#define REPORT_FRAME_MAX_LEN        64       ///< Keeps ZCL report within one unfragmented APS frame
+#define REPORT_FRAME_MAX_SENSORS    SENSOR_MAX_COUNT
+#define REPORT_FRAME_PACKED_MAX_SENSORS ((REPORT_FRAME_MAX_LEN - 4) / 2)  ///< 30 sensors per packed frame
+#define REPORT_FRAME_VALUE_INVALID  INT16_MIN
+#define REPORT_FRAME_HISTORY_HEADER_LEN 8    ///< Common header + uint32 age
+#define REPORT_FRAME_HISTORY_RECORD_MAX_LEN (5 + 3 * REPORT_FRAME_MAX_SENSORS)  ///< Worst-case record (all varints at max length)
+
+/**
+ * @brief Timestamped reading of all sensors
+ */
+typedef struct {
+    uint32_t time_s;                                 ///< Device log time (seconds)
+    int16_t values[REPORT_FRAME_MAX_SENSORS];        ///< Centidegrees or REPORT_FRAME_VALUE_INVALID
+} report_frame_sample_t;
+
+/**
+ * @brief Encode as many samples as fit into one history batch frame
+ * @param buf Output buffer
+ * @param buf_len Output buffer size (at most REPORT_FRAME_MAX_LEN is used)
+ * @param seq Frame sequence number
+ * @param samples Samples, oldest first
+ * @param count Number of samples available
+ * @param sensor_count Sensors per sample (1..REPORT_FRAME_MAX_SENSORS)
+ * @param now_s Current device log time, used to compute sample age
+ * @param encoded Output: number of samples placed into the frame
+ * @return Frame length in bytes, 0 if nothing fits
+ */
+size_t report_frame_encode_history(uint8_t *buf, size_t buf_len, uint8_t seq,
+                                   const report_frame_sample_t *samples, size_t count,
+                                   uint8_t sensor_count, uint32_t now_s, size_t *encoded);
+
+/**
+ * @brief Encode current readings of all sensors into one packed frame
+ * @param buf Output buffer
+ * @param buf_len Output buffer size
+ * @param seq Frame sequence number
+ * @param values Centidegrees per sensor (REPORT_FRAME_VALUE_INVALID if unavailable)
+ * @param sensor_count Number of sensors (1..REPORT_FRAME_PACKED_MAX_SENSORS)
+ * @return Frame length in bytes, 0 if arguments are invalid or buffer too small
+ */
+size_t report_frame_encode_readings(uint8_t *buf, size_t buf_len, uint8_t seq,
+                                    const int16_t *values, uint8_t sensor_count);
+
+#endif // REPORT_FRAME_H
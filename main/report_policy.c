@@ -0,0 +1,94 @@
+/**
+ * @file report_policy.c
+ * @brief Temperature report decision (first / threshold / interval / peer sync)
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Pure logic (no ESP-IDF dependencies). Elapsed time is computed with
+ * unsigned subtraction, so a wrapping clock is fine as long as reports are
+ * less than 2^32 ms (~49 days) apart.
+ */
+
+#include "report_policy.h"
+#include <math.h>
+
+void report_policy_init(report_policy_t *policy, float threshold_c)
+{
+    policy->threshold_c = threshold_c;
+    for (uint8_t i = 0; i < REPORT_POLICY_MAX_SENSORS; i++) {
+        report_policy_forget(policy, i);
+    }
+}
+
+void report_policy_forget(report_policy_t *policy, uint8_t sensor)
+{
+    if (sensor < REPORT_POLICY_MAX_SENSORS) {
+        policy->last_value[sensor] = NAN;
+        policy->last_ms[sensor] = 0;
+    }
+}
+
+void report_policy_mark_reported(report_policy_t *policy, uint8_t sensor, float value, uint32_t now_ms)
+{
+    if (sensor < REPORT_POLICY_MAX_SENSORS) {
+        policy->last_value[sensor] = value;
+        policy->last_ms[sensor] = now_ms;
+    }
+}
+
+bool report_policy_decide(report_policy_t *policy, uint32_t now_ms, uint32_t refresh_interval_ms, bool connected,
+                          const bool *ok, const float *values, uint8_t count, report_reason_t *reasons)
+{
+    bool any = false;
+
+    if (count > REPORT_POLICY_MAX_SENSORS) {
+        count = REPORT_POLICY_MAX_SENSORS;
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        reasons[i] = REPORT_REASON_NONE;
+        if (!connected || !ok[i]) {
+            continue;
+        }
+        if (isnan(policy->last_value[i])) {
+            reasons[i] = REPORT_REASON_INITIAL;
+        } else if (fabsf(values[i] - policy->last_value[i]) >= policy->threshold_c) {
+            reasons[i] = REPORT_REASON_THRESHOLD;
+        } else if (now_ms - policy->last_ms[i] >= refresh_interval_ms) {
+            reasons[i] = REPORT_REASON_INTERVAL;
+        }
+        any |= reasons[i] != REPORT_REASON_NONE;
+    }
+
+    if (!any) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (!connected || !ok[i]) {
+            continue;
+        }
+        if (reasons[i] == REPORT_REASON_NONE) {
+            reasons[i] = REPORT_REASON_PEER_SYNC;
+        }
+        report_policy_mark_reported(policy, i, values[i], now_ms);
+    }
+    return true;
+}
+
+const char *report_policy_reason_str(report_reason_t reason)
+{
+    switch (reason) {
+    case REPORT_REASON_INITIAL:
+        return "Initial report";
+    case REPORT_REASON_THRESHOLD:
+        return "Temperature changed";
+    case REPORT_REASON_INTERVAL:
+        return "Periodic refresh";
+    case REPORT_REASON_PEER_SYNC:
+        return "Peer sync";
+    default:
+        return "None";
+    }
+}
@@ -0,0 +1,101 @@
+/**
+ * @file report_policy.h
+ * @brief Temperature report decision (first / threshold / interval / peer sync)
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Pure decision logic of the sensor cycle, driven by a caller-supplied
+ * millisecond clock, so the same code runs in the firmware (FreeRTOS tick
+ * time) and in host/report_replay (trace time).
+ *
+ * Per cycle, a sensor with a valid reading is due when:
+ * - Initial: it was never reported (or its slot got a new sensor)
+ * - Threshold: the reading moved by at least the threshold since the last report
+ * - Interval: the refresh interval elapsed since its last report
+ * If any sensor is due, every other sensor with a valid reading is
+ * reported with it (peer sync), so a packed frame always carries all
+ * current values and standard reports arrive together.
+ */
+
+#ifndef REPORT_POLICY_H
+#define REPORT_POLICY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sensor_config.h"
+
+#define REPORT_POLICY_MAX_SENSORS           SENSOR_MAX_COUNT
+#define REPORT_POLICY_DEFAULT_THRESHOLD_C   1.0f             ///< Report when temperature changes by 1°C
+#define REPORT_POLICY_DEFAULT_INTERVAL_MS   (1 * 60 * 1000)  ///< Force report every minute even without change
+
+/**
+ * @brief Why a sensor is reported in this cycle
+ */
+typedef enum {
+    REPORT_REASON_NONE = 0,         ///< Not reported
+    REPORT_REASON_INITIAL,          ///< Never reported before
+    REPORT_REASON_THRESHOLD,        ///< Changed by at least the threshold
+    REPORT_REASON_INTERVAL,         ///< Refresh interval elapsed
+    REPORT_REASON_PEER_SYNC,        ///< Reported along with a due sensor
+} report_reason_t;
+
+/**
+ * @brief Report state of all sensors
+ */
+typedef struct {
+    float threshold_c;                                      ///< Change that triggers a report (°C)
+    float last_value[REPORT_POLICY_MAX_SENSORS];            ///< Last reported value (NAN = never)
+    uint32_t last_ms[REPORT_POLICY_MAX_SENSORS];            ///< Clock at last report
+} report_policy_t;
+
+/**
+ * @brief Initialize with no sensor reported yet
+ * @param policy Policy state
+ * @param threshold_c Change that triggers a report (°C)
+ */
+void report_policy_init(report_policy_t *policy, float threshold_c);
+
+/**
+ * @brief Forget report state of one sensor (new sensor in the slot)
+ * @param policy Policy state
+ * @param sensor Sensor index
+ */
+void report_policy_forget(report_policy_t *policy, uint8_t sensor);
+
+/**
+ * @brief Record a report sent outside the cycle (e.g. on-demand refresh)
+ * @param policy Policy state
+ * @param sensor Sensor index
+ * @param value Reported value (°C)
+ * @param now_ms Clock in milliseconds (wraps)
+ */
+void report_policy_mark_reported(report_policy_t *policy, uint8_t sensor, float value, uint32_t now_ms);
+
+/**
+ * @brief Decide which sensors to report in this cycle
+ *
+ * Sensors returned with a reason are recorded as reported at now_ms, so the
+ * caller must publish every one of them.
+ *
+ * @param policy Policy state
+ * @param now_ms Clock in milliseconds (wraps)
+ * @param refresh_interval_ms Current periodic refresh interval
+ * @param connected Reports can be sent (nothing is due otherwise)
+ * @param ok Per sensor: reading is valid
+ * @param values Per sensor: reading (°C)
+ * @param count Number of sensors (at most REPORT_POLICY_MAX_SENSORS)
+ * @param reasons Output per sensor
+ * @return true if at least one sensor is reported
+ */
+bool report_policy_decide(report_policy_t *policy, uint32_t now_ms, uint32_t refresh_interval_ms, bool connected,
+                          const bool *ok, const float *values, uint8_t count, report_reason_t *reasons);
+
+/**
+ * @brief Reason as log text
+ * @param reason Report reason
+ * @return Static string
+ */
+const char *report_policy_reason_str(report_reason_t reason);
+
+#endif // REPORT_POLICY_H
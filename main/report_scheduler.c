@@ -0,0 +1,66 @@
+/**
+ * @file report_scheduler.c
+ * @brief Per-device deterministic jitter for the sensor loop and periodic reports
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Seed: FNV-1a hash of the IEEE address, PRNG: xorshift32. Both are a few
+ * instructions per draw and need no entropy source at boot.
+ */
+
+#include "report_scheduler.h"
+
+static uint32_t scheduler_next(report_scheduler_t *sched)
+{
+    uint32_t x = sched->state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    sched->state = x;
+    return x;
+}
+
+/**
+ * @brief Uniform value in [0, range)
+ */
+static uint32_t scheduler_uniform(report_scheduler_t *sched, uint32_t range)
+{
+    return range ? scheduler_next(sched) % range : 0;
+}
+
+void report_scheduler_init(report_scheduler_t *sched, const uint8_t ieee_addr[8],
+                           uint32_t loop_period_ms, uint32_t interval_ms)
+{
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < 8; i++) {
+        hash ^= ieee_addr[i];
+        hash *= 16777619u;
+    }
+
+    sched->state = hash ? hash : 0x9E3779B9u;
+    sched->loop_period_ms = loop_period_ms;
+    sched->interval_ms = interval_ms;
+
+    // Discard first outputs, neighbouring addresses hash to nearby states
+    for (int i = 0; i < 4; i++) {
+        scheduler_next(sched);
+    }
+}
+
+uint32_t report_scheduler_initial_delay_ms(report_scheduler_t *sched)
+{
+    return scheduler_uniform(sched, sched->loop_period_ms);
+}
+
+uint32_t report_scheduler_next_loop_delay_ms(report_scheduler_t *sched)
+{
+    uint32_t jitter = sched->loop_period_ms * REPORT_SCHEDULER_LOOP_JITTER_PCT / 100;
+    return sched->loop_period_ms - jitter + scheduler_uniform(sched, 2 * jitter + 1);
+}
+
+uint32_t report_scheduler_next_interval_ms(report_scheduler_t *sched)
+{
+    uint32_t spread = sched->interval_ms * REPORT_SCHEDULER_REFRESH_JITTER_PCT / 100;
+    return sched->interval_ms - scheduler_uniform(sched, spread + 1);
+}
@@ -0,0 +1,64 @@
+/**
+ * @file report_scheduler.h
+ * @brief Per-device deterministic jitter for the sensor loop and periodic reports
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Devices powered on together would otherwise sample and report in lockstep.
+ * The scheduler derives a pseudo-random sequence from the IEEE address, so
+ * every device gets its own phase and refresh spacing, yet a given device
+ * behaves the same after every reboot (reproducible in field traces).
+ *
+ * - Initial phase: uniform in [0, loop period)
+ * - Loop period: nominal ± jitter
+ * - Periodic refresh interval: uniform in [max interval - jitter, max interval],
+ *   so the configured maximum report interval is never exceeded
+ */
+
+#ifndef REPORT_SCHEDULER_H
+#define REPORT_SCHEDULER_H
+
+#include <stdint.h>
+
+#define REPORT_SCHEDULER_LOOP_JITTER_PCT      5    ///< ± jitter of sensor loop period
+#define REPORT_SCHEDULER_REFRESH_JITTER_PCT   25   ///< Spread of periodic refresh within interval
+
+/**
+ * @brief Scheduler state
+ */
+typedef struct {
+    uint32_t state;              ///< xorshift32 state (never 0)
+    uint32_t loop_period_ms;     ///< Nominal sensor loop period
+    uint32_t interval_ms;        ///< Maximum periodic report interval
+} report_scheduler_t;
+
+/**
+ * @brief Seed scheduler from device IEEE address
+ * @param sched Scheduler state
+ * @param ieee_addr 8-byte IEEE (EUI-64) address
+ * @param loop_period_ms Nominal sensor loop period
+ * @param interval_ms Maximum periodic report interval
+ */
+void report_scheduler_init(report_scheduler_t *sched, const uint8_t ieee_addr[8],
+                           uint32_t loop_period_ms, uint32_t interval_ms);
+
+/**
+ * @brief Phase offset before the first sensor cycle
+ * @return Delay in [0, loop_period_ms)
+ */
+uint32_t report_scheduler_initial_delay_ms(report_scheduler_t *sched);
+
+/**
+ * @brief Delay until next sensor cycle
+ * @return loop_period_ms ± REPORT_SCHEDULER_LOOP_JITTER_PCT
+ */
+uint32_t report_scheduler_next_loop_delay_ms(report_scheduler_t *sched);
+
+/**
+ * @brief Interval until next forced periodic refresh (draw after each report)
+ * @return Value in [interval_ms × (1 - REFRESH_JITTER_PCT/100), interval_ms]
+ */
+uint32_t report_scheduler_next_interval_ms(report_scheduler_t *sched);
+
+#endif // REPORT_SCHEDULER_H
@@ -0,0 +1,23 @@
+/**
+ * @file sensor_config.h
+ * @brief Sensor topology shared by driver glue, history and report frames
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Single place for the number of supported sensors so that RAM history,
+ * backfill queue, report frames and Zigbee endpoints stay consistent.
+ * Each sensor slot owns a standard Temperature Measurement endpoint
+ * (SENSOR_ENDPOINT_BASE + index); the packed report frame carries all
+ * sensors at once from the first endpoint.
+ */
+
+#ifndef SENSOR_CONFIG_H
+#define SENSOR_CONFIG_H
+
+#ifndef SENSOR_MAX_COUNT
+#define SENSOR_MAX_COUNT        2    ///< DS18B20 slots (RAM scales linearly, see temp_history.h)
+#endif
+#define SENSOR_ENDPOINT_BASE    11   ///< Endpoint of sensor 0, sensor i uses base + i
+
+#endif // SENSOR_CONFIG_H
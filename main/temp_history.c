@@ -0,0 +1,227 @@
+/**
+ * @file temp_history.c
+ * @brief Multi-resolution temperature history (RAM ring buffers)
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Each sensor owns one raw ring and one ring per aggregate tier.
+ * Every tier also keeps a running accumulator (min, max, sum, count) for
+ * the bucket currently being filled. When a sample falls into a new bucket
+ * the accumulator is closed into the tier ring and restarted, so inserts
+ * are O(1) and queries never rescan raw data.
+ *
+ * Memory per sensor:
+ * - Raw:  TEMP_HISTORY_RAW_LEN × 6 bytes
+ * - 1m:   TEMP_HISTORY_1M_LEN  × 12 bytes
+ * - 15m:  TEMP_HISTORY_15M_LEN × 12 bytes
+ *
+ * @note Single writer (sensor task). Readers may observe a sample being
+ *       inserted; values are plain integers so no torn floats can occur.
+ */
+
+#include "temp_history.h"
+#include <string.h>
+
+/**
+ * @brief Running accumulator of the bucket currently being filled
+ */
+typedef struct {
+    uint32_t start_s;
+    int32_t sum;
+    int16_t min;
+    int16_t max;
+    uint16_t count;
+} temp_history_acc_t;
+
+/**
+ * @brief Ring of completed aggregates for one tier
+ */
+typedef struct {
+    temp_history_agg_t *entries;
+    uint16_t capacity;
+    uint16_t head;               ///< Next write position
+    uint16_t count;
+    uint32_t period_s;
+    temp_history_acc_t acc;
+} temp_history_tier_ring_t;
+
+/**
+ * @brief Complete history of one sensor
+ */
+typedef struct {
+    uint32_t raw_time[TEMP_HISTORY_RAW_LEN];  ///< Split arrays avoid struct padding
+    int16_t raw_value[TEMP_HISTORY_RAW_LEN];
+    uint16_t raw_head;
+    uint16_t raw_count;
+    uint32_t last_time_s;
+    temp_history_agg_t agg_1m[TEMP_HISTORY_1M_LEN];
+    temp_history_agg_t agg_15m[TEMP_HISTORY_15M_LEN];
+    temp_history_tier_ring_t tiers[TEMP_HISTORY_TIER_COUNT];
+} temp_history_sensor_t;
+
+static temp_history_sensor_t history[TEMP_HISTORY_MAX_SENSORS];
+
+/**
+ * @brief Compute rounded average of accumulator
+ */
+static int16_t acc_average(const temp_history_acc_t *acc)
+{
+    int32_t half = acc->count / 2;
+    int32_t sum = acc->sum;
+    return (int16_t)((sum >= 0 ? sum + half : sum - half) / acc->count);
+}
+
+/**
+ * @brief Close accumulator into tier ring (oldest entry is overwritten)
+ */
+static void tier_close_bucket(temp_history_tier_ring_t *tier)
+{
+    temp_history_agg_t *slot = &tier->entries[tier->head];
+    slot->start_s = tier->acc.start_s;
+    slot->min = tier->acc.min;
+    slot->max = tier->acc.max;
+    slot->avg = acc_average(&tier->acc);
+    slot->count = tier->acc.count;
+
+    tier->head = (tier->head + 1) % tier->capacity;
+    if (tier->count < tier->capacity) {
+        tier->count++;
+    }
+    tier->acc.count = 0;
+}
+
+/**
+ * @brief Fold one sample into tier accumulator
+ */
+static void tier_add(temp_history_tier_ring_t *tier, uint32_t time_s, int16_t value)
+{
+    uint32_t bucket = time_s - (time_s % tier->period_s);
+
+    if (tier->acc.count > 0 && bucket != tier->acc.start_s) {
+        tier_close_bucket(tier);
+    }
+
+    if (tier->acc.count == 0) {
+        tier->acc.start_s = bucket;
+        tier->acc.sum = 0;
+        tier->acc.min = value;
+        tier->acc.max = value;
+    }
+
+    tier->acc.sum += value;
+    if (value < tier->acc.min) {
+        tier->acc.min = value;
+    }
+    if (value > tier->acc.max) {
+        tier->acc.max = value;
+    }
+    tier->acc.count++;
+}
+
+void temp_history_init(void)
+{
+    memset(history, 0, sizeof(history));
+
+    for (int i = 0; i < TEMP_HISTORY_MAX_SENSORS; i++) {
+        temp_history_sensor_t *h = &history[i];
+        h->tiers[TEMP_HISTORY_TIER_1M].entries = h->agg_1m;
+        h->tiers[TEMP_HISTORY_TIER_1M].capacity = TEMP_HISTORY_1M_LEN;
+        h->tiers[TEMP_HISTORY_TIER_1M].period_s = 60;
+        h->tiers[TEMP_HISTORY_TIER_15M].entries = h->agg_15m;
+        h->tiers[TEMP_HISTORY_TIER_15M].capacity = TEMP_HISTORY_15M_LEN;
+        h->tiers[TEMP_HISTORY_TIER_15M].period_s = 15 * 60;
+    }
+}
+
+bool temp_history_add(uint8_t sensor, uint32_t time_s, int16_t value)
+{
+    if (sensor >= TEMP_HISTORY_MAX_SENSORS) {
+        return false;
+    }
+
+    temp_history_sensor_t *h = &history[sensor];
+    if (h->raw_count > 0 && time_s < h->last_time_s) {
+        return false;
+    }
+
+    h->raw_time[h->raw_head] = time_s;
+    h->raw_value[h->raw_head] = value;
+    h->raw_head = (h->raw_head + 1) % TEMP_HISTORY_RAW_LEN;
+    if (h->raw_count < TEMP_HISTORY_RAW_LEN) {
+        h->raw_count++;
+    }
+    h->last_time_s = time_s;
+
+    for (int t = 0; t < TEMP_HISTORY_TIER_COUNT; t++) {
+        tier_add(&h->tiers[t], time_s, value);
+    }
+
+    return true;
+}
+
+uint16_t temp_history_raw_count(uint8_t sensor)
+{
+    return sensor < TEMP_HISTORY_MAX_SENSORS ? history[sensor].raw_count : 0;
+}
+
+bool temp_history_get_raw(uint8_t sensor, uint16_t age, temp_history_sample_t *sample)
+{
+    if (sensor >= TEMP_HISTORY_MAX_SENSORS || age >= history[sensor].raw_count) {
+        return false;
+    }
+
+    const temp_history_sensor_t *h = &history[sensor];
+    uint16_t idx = (h->raw_head + TEMP_HISTORY_RAW_LEN - 1 - age) % TEMP_HISTORY_RAW_LEN;
+    sample->time_s = h->raw_time[idx];
+    sample->value = h->raw_value[idx];
+    return true;
+}
+
+uint16_t temp_history_agg_count(uint8_t sensor, temp_history_tier_t tier)
+{
+    if (sensor >= TEMP_HISTORY_MAX_SENSORS || tier >= TEMP_HISTORY_TIER_COUNT) {
+        return 0;
+    }
+    return history[sensor].tiers[tier].count;
+}
+
+bool temp_history_get_agg(uint8_t sensor, temp_history_tier_t tier, uint16_t age, temp_history_agg_t *agg)
+{
+    if (sensor >= TEMP_HISTORY_MAX_SENSORS || tier >= TEMP_HISTORY_TIER_COUNT) {
+        return false;
+    }
+
+    const temp_history_tier_ring_t *ring = &history[sensor].tiers[tier];
+    if (age >= ring->count) {
+        return false;
+    }
+
+    uint16_t idx = (ring->head + ring->capacity - 1 - age) % ring->capacity;
+    *agg = ring->entries[idx];
+    return true;
+}
+
+bool temp_history_get_current(uint8_t sensor, temp_history_tier_t tier, temp_history_agg_t *agg)
+{
+    if (sensor >= TEMP_HISTORY_MAX_SENSORS || tier >= TEMP_HISTORY_TIER_COUNT) {
+        return false;
+    }
+
+    const temp_history_acc_t *acc = &history[sensor].tiers[tier].acc;
+    if (acc->count == 0) {
+        return false;
+    }
+
+    agg->start_s = acc->start_s;
+    agg->min = acc->min;
+    agg->max = acc->max;
+    agg->avg = acc_average(acc);
+    agg->count = acc->count;
+    return true;
+}
+
+size_t temp_history_ram_bytes(void)
+{
+    return sizeof(history);
+}
@@ -0,0 +1,122 @@
+/**
+ * @file temp_history.h
+ * @brief Multi-resolution temperature history (RAM ring buffers)
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Fixed-size per-sensor history with three tiers:
+ * - Raw samples for the last hour
+ * - 1-minute min/avg/max aggregates
+ * - 15-minute min/avg/max aggregates
+ *
+ * Aggregates are folded in incrementally on every insert, so all queries
+ * are O(1). All storage is static and sized at compile time.
+ */
+
+#ifndef TEMP_HISTORY_H
+#define TEMP_HISTORY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sensor_config.h"
+
+/* History dimensions (compile-time, no dynamic allocation) */
+#define TEMP_HISTORY_MAX_SENSORS     SENSOR_MAX_COUNT
+#define TEMP_HISTORY_SAMPLE_PERIOD_S 5                                   // Nominal sensor loop period
+#define TEMP_HISTORY_RAW_LEN         (3600 / TEMP_HISTORY_SAMPLE_PERIOD_S) // 1 hour of raw samples
+#define TEMP_HISTORY_1M_LEN          360                                 // 6 hours of 1-minute aggregates
+#define TEMP_HISTORY_15M_LEN         192                                 // 48 hours of 15-minute aggregates
+
+/**
+ * @brief History tier selector
+ */
+typedef enum {
+    TEMP_HISTORY_TIER_1M = 0,   ///< 1-minute aggregates
+    TEMP_HISTORY_TIER_15M,      ///< 15-minute aggregates
+    TEMP_HISTORY_TIER_COUNT,
+} temp_history_tier_t;
+
+/**
+ * @brief Single raw sample
+ */
+typedef struct {
+    uint32_t time_s;     ///< Sample timestamp (seconds, monotonic)
+    int16_t value;       ///< Temperature in centidegrees
+} temp_history_sample_t;
+
+/**
+ * @brief Aggregate over one tier bucket
+ */
+typedef struct {
+    uint32_t start_s;    ///< Bucket start time (seconds, aligned to tier period)
+    int16_t min;         ///< Minimum temperature (centidegrees)
+    int16_t avg;         ///< Average temperature (centidegrees)
+    int16_t max;         ///< Maximum temperature (centidegrees)
+    uint16_t count;      ///< Number of raw samples in bucket
+} temp_history_agg_t;
+
+/**
+ * @brief Reset history of all sensors
+ */
+void temp_history_init(void);
+
+/**
+ * @brief Append raw sample and update aggregates
+ * @param sensor Sensor index (0..TEMP_HISTORY_MAX_SENSORS-1)
+ * @param time_s Sample timestamp in seconds (must be non-decreasing per sensor)
+ * @param value Temperature in centidegrees
+ * @return true on success, false for invalid sensor index or out-of-order sample
+ */
+bool temp_history_add(uint8_t sensor, uint32_t time_s, int16_t value);
+
+/**
+ * @brief Number of raw samples currently stored
+ * @param sensor Sensor index
+ * @return Sample count (0..TEMP_HISTORY_RAW_LEN)
+ */
+uint16_t temp_history_raw_count(uint8_t sensor);
+
+/**
+ * @brief Get raw sample by age
+ * @param sensor Sensor index
+ * @param age 0 = newest sample, 1 = previous, ...
+ * @param sample Output sample
+ * @return true if sample exists
+ */
+bool temp_history_get_raw(uint8_t sensor, uint16_t age, temp_history_sample_t *sample);
+
+/**
+ * @brief Number of completed aggregates stored in tier
+ * @param sensor Sensor index
+ * @param tier Tier selector
+ * @return Aggregate count
+ */
+uint16_t temp_history_agg_count(uint8_t sensor, temp_history_tier_t tier);
+
+/**
+ * @brief Get completed aggregate by age
+ * @param sensor Sensor index
+ * @param tier Tier selector
+ * @param age 0 = newest completed bucket, 1 = previous, ...
+ * @param agg Output aggregate
+ * @return true if aggregate exists
+ */
+bool temp_history_get_agg(uint8_t sensor, temp_history_tier_t tier, uint16_t age, temp_history_agg_t *agg);
+
+/**
+ * @brief Get in-progress (not yet completed) aggregate of tier
+ * @param sensor Sensor index
+ * @param tier Tier selector
+ * @param agg Output aggregate
+ * @return true if current bucket contains at least one sample
+ */
+bool temp_history_get_current(uint8_t sensor, temp_history_tier_t tier, temp_history_agg_t *agg);
+
+/**
+ * @brief Static RAM of the history rings (all sensor slots)
+ */
+size_t temp_history_ram_bytes(void);
+
+#endif // TEMP_HISTORY_H
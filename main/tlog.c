@@ -0,0 +1,291 @@
+/**
+ * @file tlog.c
+ * @brief Flash-backed append-only temperature log
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Partition layout: N sectors × (erase_size / TLOG_BLOCK_SIZE) blocks.
+ * Blocks carry a monotonic sequence number, so the newest block is found by
+ * reading only the first header of every sector and then the headers of
+ * the newest sector (N + 16 small reads instead of a full partition read).
+ *
+ * Write path:
+ * 1. Records are appended to the RAM encoder block
+ * 2. When the block is full (or flush interval elapsed) it is sealed and
+ *    programmed to the next free block slot
+ * 3. Entering a new sector erases it first (circular space reclaim)
+ *
+ * Interrupted writes leave a block with bad CRC; it is skipped on read and
+ * never reused until its sector is erased again. A shutdown handler programs
+ * the partial RAM block before esp_restart(), so software resets lose nothing.
+ */
+
+#include "tlog.h"
+#include "esp_partition.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <string.h>
+
+static const char *TAG = "TLOG";
+
+static const esp_partition_t *tlog_partition = NULL;
+static SemaphoreHandle_t tlog_mutex = NULL;
+static uint32_t tlog_blocks_per_sector;
+static uint32_t tlog_total_blocks;
+static uint32_t tlog_write_block;              ///< Absolute index of next block slot
+static uint32_t tlog_next_seq;
+static uint32_t tlog_time_base_s;              ///< Newest persisted time at boot
+static int64_t tlog_block_started_us;          ///< When RAM block received first record
+static tlog_block_encoder_t tlog_encoder;
+static tlog_stats_t tlog_stats;
+
+/**
+ * @brief Program sealed RAM block and advance write position
+ */
+static esp_err_t tlog_write_current_block(void)
+{
+    if (tlog_encoder.count == 0) {
+        return ESP_OK;
+    }
+
+    size_t offset = (size_t)tlog_write_block * TLOG_BLOCK_SIZE;
+
+    // Entering a new sector: reclaim it (drops the oldest data)
+    if (tlog_write_block % tlog_blocks_per_sector == 0) {
+        esp_err_t err = esp_partition_erase_range(tlog_partition, offset, tlog_partition->erase_size);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Sector erase at 0x%x failed (%s)", (unsigned)offset, esp_err_to_name(err));
+            return err;
+        }
+        tlog_stats.sectors_erased++;
+    }
+
+    const uint8_t *block = tlog_block_seal(&tlog_encoder);
+    esp_err_t err = esp_partition_write(tlog_partition, offset, block, TLOG_BLOCK_SIZE);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Block write at 0x%x failed (%s)", (unsigned)offset, esp_err_to_name(err));
+        return err;
+    }
+
+    tlog_stats.blocks_written++;
+    tlog_stats.bytes_programmed += TLOG_BLOCK_SIZE;
+    tlog_write_block = (tlog_write_block + 1) % tlog_total_blocks;
+    tlog_block_begin(&tlog_encoder, tlog_next_seq++, tlog_encoder.sensor_count);
+    return ESP_OK;
+}
+
+/**
+ * @brief Find newest block and derive write position from it
+ */
+static void tlog_scan(void)
+{
+    uint8_t header_buf[TLOG_BLOCK_HEADER_SIZE];
+    tlog_block_header_t header;
+    bool found = false;
+    uint32_t newest_sector = 0;
+    uint32_t newest_seq = 0;
+    uint32_t sector_count = tlog_total_blocks / tlog_blocks_per_sector;
+
+    // Pass 1: first header of every sector
+    for (uint32_t s = 0; s < sector_count; s++) {
+        size_t offset = (size_t)s * tlog_partition->erase_size;
+        if (esp_partition_read(tlog_partition, offset, header_buf, sizeof(header_buf)) != ESP_OK) {
+            continue;
+        }
+        if (tlog_block_parse_header(header_buf, &header) && (!found || header.seq > newest_seq)) {
+            found = true;
+            newest_sector = s;
+            newest_seq = header.seq;
+        }
+    }
+
+    if (!found) {
+        tlog_write_block = 0;
+        tlog_next_seq = 0;
+        tlog_time_base_s = 0;
+        return;
+    }
+
+    // Pass 2: headers inside newest sector, stop at first erased slot
+    uint32_t first_block = newest_sector * tlog_blocks_per_sector;
+    uint32_t next_block = first_block + tlog_blocks_per_sector;
+    for (uint32_t b = first_block; b < first_block + tlog_blocks_per_sector; b++) {
+        if (esp_partition_read(tlog_partition, (size_t)b * TLOG_BLOCK_SIZE, header_buf, sizeof(header_buf)) != ESP_OK) {
+            continue;
+        }
+        if (tlog_block_is_erased(header_buf)) {
+            next_block = b;
+            break;
+        }
+        if (tlog_block_parse_header(header_buf, &header) && header.seq >= newest_seq) {
+            newest_seq = header.seq;
+        }
+    }
+
+    tlog_write_block = next_block % tlog_total_blocks;
+    tlog_next_seq = newest_seq + 1;
+
+    // Recover newest timestamp from the newest valid block
+    tlog_time_base_s = 0;
+    for (uint32_t b = next_block; b > first_block; b--) {
+        static uint8_t block_buf[TLOG_BLOCK_SIZE];
+        tlog_block_decoder_t dec;
+        tlog_record_t record;
+        if (esp_partition_read(tlog_partition, (size_t)(b - 1) * TLOG_BLOCK_SIZE, block_buf, sizeof(block_buf)) != ESP_OK ||
+            !tlog_block_decoder_init(&dec, block_buf)) {
+            continue;
+        }
+        while (tlog_block_decoder_next(&dec, &record)) {
+            tlog_time_base_s = record.time_s + 1;
+        }
+        break;
+    }
+}
+
+/**
+ * @brief esp_restart() hook: persist the partial RAM block
+ */
+static void tlog_shutdown_handler(void)
+{
+    tlog_flush();
+}
+
+esp_err_t tlog_init(void)
+{
+    tlog_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, TLOG_PARTITION_SUBTYPE, TLOG_PARTITION_LABEL);
+    if (tlog_partition == NULL) {
+        ESP_LOGW(TAG, "Partition '%s' not found - flash log disabled", TLOG_PARTITION_LABEL);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    if (tlog_mutex == NULL) {
+        tlog_mutex = xSemaphoreCreateMutex();
+    }
+
+    memset(&tlog_stats, 0, sizeof(tlog_stats));
+    tlog_blocks_per_sector = tlog_partition->erase_size / TLOG_BLOCK_SIZE;
+    tlog_total_blocks = (tlog_partition->size / tlog_partition->erase_size) * tlog_blocks_per_sector;
+    tlog_stats.sector_count = tlog_total_blocks / tlog_blocks_per_sector;
+
+    int64_t start_us = esp_timer_get_time();
+    tlog_scan();
+    tlog_stats.scan_time_us = (uint32_t)(esp_timer_get_time() - start_us);
+
+    tlog_block_begin(&tlog_encoder, tlog_next_seq++, 1);
+
+    esp_err_t err = esp_register_shutdown_handler(tlog_shutdown_handler);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        ESP_LOGW(TAG, "Shutdown flush not registered (%s)", esp_err_to_name(err));
+    }
+
+    ESP_LOGI(TAG, "Log partition: %u sectors, write block %u, next seq %u, time base %us (scan %uus)",
+             (unsigned)tlog_stats.sector_count, (unsigned)tlog_write_block, (unsigned)tlog_encoder.seq,
+             (unsigned)tlog_time_base_s, (unsigned)tlog_stats.scan_time_us);
+    return ESP_OK;
+}
+
+uint32_t tlog_time_now(void)
+{
+    return tlog_time_base_s + (uint32_t)(esp_timer_get_time() / 1000000);
+}
+
+esp_err_t tlog_append(const tlog_record_t *record)
+{
+    if (tlog_partition == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t err = ESP_OK;
+    xSemaphoreTake(tlog_mutex, portMAX_DELAY);
+
+    // Sensor count change starts a new block (header carries the count)
+    if (tlog_encoder.count > 0 && record->sensor_count != tlog_encoder.sensor_count) {
+        err = tlog_write_current_block();
+    }
+    if (tlog_encoder.count == 0) {
+        tlog_block_begin(&tlog_encoder, tlog_encoder.seq, record->sensor_count);
+        tlog_block_started_us = esp_timer_get_time();
+    }
+
+    if (err == ESP_OK && !tlog_block_append(&tlog_encoder, record)) {
+        err = tlog_write_current_block();
+        if (err == ESP_OK) {
+            tlog_block_started_us = esp_timer_get_time();
+            tlog_block_append(&tlog_encoder, record);
+        }
+    }
+
+    if (err == ESP_OK) {
+        tlog_stats.records_appended++;
+        if (esp_timer_get_time() - tlog_block_started_us >= (int64_t)TLOG_FLUSH_INTERVAL_S * 1000000) {
+            err = tlog_write_current_block();
+        }
+    }
+
+    xSemaphoreGive(tlog_mutex);
+    return err;
+}
+
+esp_err_t tlog_flush(void)
+{
+    if (tlog_partition == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(tlog_mutex, portMAX_DELAY);
+    esp_err_t err = tlog_write_current_block();
+    xSemaphoreGive(tlog_mutex);
+    return err;
+}
+
+esp_err_t tlog_foreach(tlog_record_cb_t cb, void *ctx)
+{
+    if (tlog_partition == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    static uint8_t block_buf[TLOG_BLOCK_SIZE];
+    tlog_block_decoder_t dec;
+    tlog_record_t record;
+    bool keep_going = true;
+
+    xSemaphoreTake(tlog_mutex, portMAX_DELAY);
+
+    // Oldest data starts right after the write position (circular order)
+    for (uint32_t i = 0; i < tlog_total_blocks && keep_going; i++) {
+        uint32_t b = (tlog_write_block + i) % tlog_total_blocks;
+        if (esp_partition_read(tlog_partition, (size_t)b * TLOG_BLOCK_SIZE, block_buf, TLOG_BLOCK_HEADER_SIZE) != ESP_OK ||
+            tlog_block_is_erased(block_buf)) {
+            continue;
+        }
+        if (esp_partition_read(tlog_partition, (size_t)b * TLOG_BLOCK_SIZE, block_buf, sizeof(block_buf)) != ESP_OK ||
+            !tlog_block_decoder_init(&dec, block_buf)) {
+            continue;
+        }
+        while (keep_going && tlog_block_decoder_next(&dec, &record)) {
+            keep_going = cb(&record, ctx);
+        }
+    }
+
+    // Records still buffered in RAM
+    if (keep_going && tlog_encoder.count > 0) {
+        tlog_block_encoder_t snapshot = tlog_encoder;
+        if (tlog_block_decoder_init(&dec, tlog_block_seal(&snapshot))) {
+            while (keep_going && tlog_block_decoder_next(&dec, &record)) {
+                keep_going = cb(&record, ctx);
+            }
+        }
+    }
+
+    xSemaphoreGive(tlog_mutex);
+    return ESP_OK;
+}
+
+void tlog_get_stats(tlog_stats_t *stats)
+{
+    *stats = tlog_stats;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file tlog.h
+ * @brief Flash-backed append-only temperature log
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Log-structured writer for the "tlog" data partition. Records are
+ * delta-encoded (tlog_format.h) and batched in RAM into 256-byte blocks;
+ * flash is programmed only once per full block (or on explicit flush).
+ * The partition is used as a circular buffer of 4 KB sectors: when the
+ * writer enters a sector, it is erased and the oldest data is reclaimed.
+ */
+
+#ifndef TLOG_H
+#define TLOG_H
+
+#include "esp_err.h"
+#include "tlog_format.h"
+
+#define TLOG_PARTITION_LABEL    "tlog"
+#define TLOG_PARTITION_SUBTYPE  0x40              ///< Custom data subtype (see partitions.csv)
+#define TLOG_FLUSH_INTERVAL_S   (15 * 60)         ///< Max age of unflushed RAM block
+
+/**
+ * @brief Log statistics (for wear and write-amplification monitoring)
+ */
+typedef struct {
+    uint32_t records_appended;   ///< Records accepted since boot
+    uint32_t blocks_written;     ///< Flash page program operations since boot
+    uint32_t sectors_erased;     ///< Sector erases since boot
+    uint32_t bytes_programmed;   ///< Bytes programmed to flash since boot
+    uint32_t scan_time_us;       ///< Duration of boot scan
+    uint32_t sector_count;       ///< Sectors in partition
+} tlog_stats_t;
+
+/**
+ * @brief Record callback for tlog_foreach()
+ * @param record Decoded record
+ * @param ctx User context
+ * @return true to continue iteration, false to stop
+ */
+typedef bool (*tlog_record_cb_t)(const tlog_record_t *record, void *ctx);
+
+/**
+ * @brief Locate partition and scan it for the current write position
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if partition is missing
+ */
+esp_err_t tlog_init(void);
+
+/**
+ * @brief Current log time (seconds)
+ *
+ * Continues from the newest record found during boot scan, so log time is
+ * monotonic across reboots. Time spent powered off is not visible.
+ *
+ * @return Log time in seconds
+ */
+uint32_t tlog_time_now(void);
+
+/**
+ * @brief Append record (buffered in RAM until block is full)
+ * @param record Record to append
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if not initialized, flash error otherwise
+ */
+esp_err_t tlog_append(const tlog_record_t *record);
+
+/**
+ * @brief Program partially filled RAM block to flash
+ *
+ * Also runs from an esp_restart() shutdown handler registered by tlog_init().
+ *
+ * @return ESP_OK on success (also when nothing to flush)
+ */
+esp_err_t tlog_flush(void);
+
+/**
+ * @brief Iterate all stored records from oldest to newest (including RAM block)
+ * @param cb Callback invoked per record
+ * @param ctx User context
+ * @return ESP_OK on success
+ */
+esp_err_t tlog_foreach(tlog_record_cb_t cb, void *ctx);
+
+/**
+ * @brief Get log statistics
+ * @param stats Output statistics
+ */
+void tlog_get_stats(tlog_stats_t *stats);
+
+#endif // TLOG_H
@@ -0,0 +1,205 @@
+/**
+ * @file tlog_format.c
+ * @brief Time-series log block format (delta-encoded records)
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Record encoding:
+ * - Time delta to previous record: unsigned LEB128 varint (1 byte for < 128 s)
+ * - Per sensor: int16 delta to previous value, zigzag-mapped, LEB128 varint
+ *   (1 byte for |delta| < 0.64°C, 3 bytes worst case)
+ *
+ * Deltas wrap modulo 2^16, so TLOG_VALUE_INVALID round-trips like any other
+ * value and a missing reading costs at most 3 bytes.
+ *
+ * Header layout (little endian):
+ * - [0..1]   magic
+ * - [2..5]   sequence number
+ * - [6..9]   base time (seconds)
+ * - [10]     sensor count
+ * - [11]     record count
+ * - [12..13] payload length
+ * - [14..15] CRC16-CCITT over header bytes 0..13 and payload
+ */
+
+#include "tlog_format.h"
+#include "varint.h"
+#include <string.h>
+
+/**
+ * @brief CRC16-CCITT (poly 0x1021, init 0xFFFF)
+ */
+static uint16_t tlog_crc16(uint16_t crc, const uint8_t *data, uint16_t len)
+{
+    for (uint16_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int j = 0; j < 8; j++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+}
+
+void tlog_block_begin(tlog_block_encoder_t *enc, uint32_t seq, uint8_t sensor_count)
+{
+    memset(enc->buf, 0xFF, sizeof(enc->buf));
+    enc->len = TLOG_BLOCK_HEADER_SIZE;
+    enc->count = 0;
+    enc->sensor_count = sensor_count > TLOG_MAX_SENSORS ? TLOG_MAX_SENSORS : sensor_count;
+    enc->seq = seq;
+    enc->base_time_s = 0;
+    enc->last_time_s = 0;
+    memset(enc->last_values, 0, sizeof(enc->last_values));
+}
+
+bool tlog_block_append(tlog_block_encoder_t *enc, const tlog_record_t *record)
+{
+    if (enc->count == UINT8_MAX) {
+        return false;
+    }
+
+    if (enc->count == 0) {
+        enc->base_time_s = record->time_s;
+        enc->last_time_s = record->time_s;
+    } else if (record->time_s < enc->last_time_s) {
+        return false;
+    }
+
+    // Encode into scratch first so a record never straddles a block
+    uint8_t scratch[TLOG_MAX_RECORD_SIZE];
+    uint8_t n = varint_put(scratch, record->time_s - enc->last_time_s);
+    for (uint8_t i = 0; i < enc->sensor_count; i++) {
+        int16_t value = i < record->sensor_count ? record->values[i] : TLOG_VALUE_INVALID;
+        int16_t delta = (int16_t)(uint16_t)(value - enc->last_values[i]);
+        n += varint_put(scratch + n, zigzag16(delta));
+    }
+
+    if (enc->len + n > TLOG_BLOCK_SIZE) {
+        return false;
+    }
+
+    memcpy(enc->buf + enc->len, scratch, n);
+    enc->len += n;
+    enc->count++;
+    enc->last_time_s = record->time_s;
+    for (uint8_t i = 0; i < enc->sensor_count; i++) {
+        enc->last_values[i] = i < record->sensor_count ? record->values[i] : TLOG_VALUE_INVALID;
+    }
+    return true;
+}
+
+const uint8_t *tlog_block_seal(tlog_block_encoder_t *enc)
+{
+    uint8_t *h = enc->buf;
+    put_u16(h + 0, TLOG_BLOCK_MAGIC);
+    put_u32(h + 2, enc->seq);
+    put_u32(h + 6, enc->base_time_s);
+    h[10] = enc->sensor_count;
+    h[11] = enc->count;
+    put_u16(h + 12, (uint16_t)(enc->len - TLOG_BLOCK_HEADER_SIZE));
+
+    uint16_t crc = tlog_crc16(0xFFFF, h, 14);
+    crc = tlog_crc16(crc, h + TLOG_BLOCK_HEADER_SIZE, (uint16_t)(enc->len - TLOG_BLOCK_HEADER_SIZE));
+    put_u16(h + 14, crc);
+    return enc->buf;
+}
+
+bool tlog_block_is_erased(const uint8_t *block)
+{
+    for (int i = 0; i < TLOG_BLOCK_HEADER_SIZE; i++) {
+        if (block[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool tlog_block_parse_header(const uint8_t *block, tlog_block_header_t *header)
+{
+    if (get_u16(block) != TLOG_BLOCK_MAGIC) {
+        return false;
+    }
+
+    header->seq = get_u32(block + 2);
+    header->base_time_s = get_u32(block + 6);
+    header->sensor_count = block[10];
+    header->record_count = block[11];
+    header->payload_len = get_u16(block + 12);
+
+    return header->sensor_count >= 1 && header->sensor_count <= TLOG_MAX_SENSORS &&
+           header->payload_len <= TLOG_BLOCK_SIZE - TLOG_BLOCK_HEADER_SIZE;
+}
+
+bool tlog_block_decoder_init(tlog_block_decoder_t *dec, const uint8_t *block)
+{
+    if (!tlog_block_parse_header(block, &dec->header)) {
+        return false;
+    }
+
+    uint16_t crc = tlog_crc16(0xFFFF, block, 14);
+    crc = tlog_crc16(crc, block + TLOG_BLOCK_HEADER_SIZE, dec->header.payload_len);
+    if (crc != get_u16(block + 14)) {
+        return false;
+    }
+
+    dec->buf = block;
+    dec->pos = TLOG_BLOCK_HEADER_SIZE;
+    dec->index = 0;
+    dec->last_time_s = dec->header.base_time_s;
+    memset(dec->last_values, 0, sizeof(dec->last_values));
+    return true;
+}
+
+bool tlog_block_decoder_next(tlog_block_decoder_t *dec, tlog_record_t *record)
+{
+    if (dec->index >= dec->header.record_count) {
+        return false;
+    }
+
+    uint16_t end = TLOG_BLOCK_HEADER_SIZE + dec->header.payload_len;
+    uint32_t v;
+    uint8_t n = varint_get(dec->buf + dec->pos, end - dec->pos, &v);
+    if (n == 0) {
+        return false;
+    }
+    dec->pos += n;
+    dec->last_time_s += v;
+
+    for (uint8_t i = 0; i < dec->header.sensor_count; i++) {
+        n = varint_get(dec->buf + dec->pos, end - dec->pos, &v);
+        if (n == 0 || v > UINT16_MAX) {
+            return false;
+        }
+        dec->pos += n;
+        dec->last_values[i] = (int16_t)(uint16_t)(dec->last_values[i] + unzigzag16((uint16_t)v));
+    }
+
+    record->time_s = dec->last_time_s;
+    record->sensor_count = dec->header.sensor_count;
+    memcpy(record->values, dec->last_values, sizeof(record->values));
+    dec->index++;
+    return true;
+}
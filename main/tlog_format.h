@@ -0,0 +1,133 @@
+/**
+ * @file tlog_format.h
+ * @brief Time-series log block format (delta-encoded records)
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Pure encoder/decoder of the on-flash temperature log format. No ESP-IDF
+ * dependencies, so the same code is built for the target and the host.
+ *
+ * Block layout (TLOG_BLOCK_SIZE bytes = one flash program page):
+ * - 16-byte header (magic, sequence, base time, counts, CRC16)
+ * - Records, each: varint(time delta) + zigzag varint(value delta) per sensor
+ * - Unused tail left erased (0xFF)
+ *
+ * Every block is self-contained: the first record is encoded against
+ * base time from the header and zero values, so any block decodes alone.
+ */
+
+#ifndef TLOG_FORMAT_H
+#define TLOG_FORMAT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TLOG_BLOCK_SIZE         256        ///< Flash program page size
+#define TLOG_BLOCK_HEADER_SIZE  16
+#define TLOG_BLOCK_MAGIC        0x544C     ///< "TL"
+#define TLOG_MAX_SENSORS        8          ///< Firmware asserts SENSOR_MAX_COUNT <= this
+#define TLOG_VALUE_INVALID      INT16_MIN  ///< Marks missing sensor reading
+#define TLOG_MAX_RECORD_SIZE    (5 + 3 * TLOG_MAX_SENSORS)
+
+/**
+ * @brief One logged sample of all sensors
+ */
+typedef struct {
+    uint32_t time_s;                       ///< Timestamp (seconds)
+    uint8_t sensor_count;                  ///< Number of valid entries in values[]
+    int16_t values[TLOG_MAX_SENSORS];      ///< Centidegrees or TLOG_VALUE_INVALID
+} tlog_record_t;
+
+/**
+ * @brief Decoded block header
+ */
+typedef struct {
+    uint32_t seq;                          ///< Monotonic block sequence number
+    uint32_t base_time_s;                  ///< Time base of first record
+    uint8_t sensor_count;                  ///< Sensors per record
+    uint8_t record_count;                  ///< Records in block
+    uint16_t payload_len;                  ///< Record bytes after header
+} tlog_block_header_t;
+
+/**
+ * @brief Block encoder state (lives in RAM until block is full)
+ */
+typedef struct {
+    uint8_t buf[TLOG_BLOCK_SIZE];
+    uint16_t len;
+    uint8_t count;
+    uint8_t sensor_count;
+    uint32_t seq;
+    uint32_t base_time_s;
+    uint32_t last_time_s;
+    int16_t last_values[TLOG_MAX_SENSORS];
+} tlog_block_encoder_t;
+
+/**
+ * @brief Block decoder state
+ */
+typedef struct {
+    const uint8_t *buf;
+    tlog_block_header_t header;
+    uint16_t pos;
+    uint8_t index;
+    uint32_t last_time_s;
+    int16_t last_values[TLOG_MAX_SENSORS];
+} tlog_block_decoder_t;
+
+/**
+ * @brief Start a new empty block
+ * @param enc Encoder state
+ * @param seq Sequence number of block
+ * @param sensor_count Sensors per record (1..TLOG_MAX_SENSORS)
+ */
+void tlog_block_begin(tlog_block_encoder_t *enc, uint32_t seq, uint8_t sensor_count);
+
+/**
+ * @brief Append record to block
+ * @param enc Encoder state
+ * @param record Record to append (time must not go backwards)
+ * @return true if appended, false if block is full (caller seals and starts a new one)
+ */
+bool tlog_block_append(tlog_block_encoder_t *enc, const tlog_record_t *record);
+
+/**
+ * @brief Finalize header and CRC
+ * @param enc Encoder state
+ * @return Pointer to TLOG_BLOCK_SIZE bytes ready for flash programming
+ */
+const uint8_t *tlog_block_seal(tlog_block_encoder_t *enc);
+
+/**
+ * @brief Check whether block area is erased (never written)
+ * @param block At least TLOG_BLOCK_HEADER_SIZE bytes
+ * @return true if header bytes are all 0xFF
+ */
+bool tlog_block_is_erased(const uint8_t *block);
+
+/**
+ * @brief Parse block header without verifying payload
+ * @param block At least TLOG_BLOCK_HEADER_SIZE bytes
+ * @param header Output header
+ * @return true if magic and counts are plausible
+ */
+bool tlog_block_parse_header(const uint8_t *block, tlog_block_header_t *header);
+
+/**
+ * @brief Start decoding block (verifies CRC)
+ * @param dec Decoder state
+ * @param block TLOG_BLOCK_SIZE bytes
+ * @return true if block is valid
+ */
+bool tlog_block_decoder_init(tlog_block_decoder_t *dec, const uint8_t *block);
+
+/**
+ * @brief Decode next record
+ * @param dec Decoder state
+ * @param record Output record
+ * @return true if record decoded, false at end of block or on corrupt data
+ */
+bool tlog_block_decoder_next(tlog_block_decoder_t *dec, tlog_record_t *record);
+
+#endif // TLOG_FORMAT_H
@@ -0,0 +1,73 @@
+/**
+ * @file varint.h
+ * @brief LEB128 varint and zigzag helpers shared by compact binary formats
+ * @version 1.2.0
+ * @date 2026-10-18
+ *
+ * @details
+ * Used by the flash log (tlog_format.c) and the Zigbee report frames
+ * (report_frame.c). Header-only, no ESP-IDF dependencies.
+ */
+
+#ifndef VARINT_H
+#define VARINT_H
+
+#include <stdint.h>
+
+#define VARINT_MAX_LEN_U32  5
+#define VARINT_MAX_LEN_U16  3
+
+/**
+ * @brief Write unsigned LEB128 varint
+ * @param p Output buffer (at least VARINT_MAX_LEN_U32 bytes)
+ * @param v Value
+ * @return Number of bytes written
+ */
+static inline uint8_t varint_put(uint8_t *p, uint32_t v)
+{
+    uint8_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+/**
+ * @brief Read unsigned LEB128 varint
+ * @param p Input buffer
+ * @param avail Bytes available in buffer
+ * @param v Output value
+ * @return Number of bytes consumed, 0 if truncated or too long
+ */
+static inline uint8_t varint_get(const uint8_t *p, uint16_t avail, uint32_t *v)
+{
+    uint32_t result = 0;
+    for (uint8_t n = 0; n < VARINT_MAX_LEN_U32 && n < avail; n++) {
+        result |= (uint32_t)(p[n] & 0x7F) << (7 * n);
+        if (!(p[n] & 0x80)) {
+            *v = result;
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Map signed 16-bit value to unsigned (small magnitudes -> small codes)
+ */
+static inline uint16_t zigzag16(int16_t v)
+{
+    return (uint16_t)(((uint16_t)v << 1) ^ (uint16_t)(v >> 15));
+}
+
+/**
+ * @brief Inverse of zigzag16()
+ */
+static inline int16_t unzigzag16(uint16_t v)
+{
+    return (int16_t)((v >> 1) ^ (uint16_t)-(int16_t)(v & 1));
+}
+
+#endif // VARINT_H